@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include "source_generator.h"
+#include "../Interpreter/interpreter.h"
+#include "../Object/Array/simd.h"
+#include "../Parser/AST/ast_dumper.h"
+#include "../Parser/AST/ast_printer.h"
+#include "../Parser/flat_parser.h"
+#include "../Parser/parser.h"
+#include "../Stats/stats.h"
+
+struct BenchOptions {
+	size_t bytes = 1 << 20;
+	size_t iterations = 20;
+	size_t warmup = 3;
+	uint32_t seed = 1;
+	std::optional<SourceShape> shape; // All shapes if not set
+	std::string label; // Free text stored in the report, a commit hash for example
+	std::string out; // JSON report path, stdout if empty
+	std::string emit; // Write the generated source here and exit
+	bool arrays = false; // Array builtins instead of the front end
+	size_t elements = 100000; // Elements of every array, with arrays
+};
+
+// Timings of one stage on one source, in milliseconds
+struct BenchResult {
+	std::string shape, stage, unit;
+	size_t bytes = 0; // Input bytes, the output bytes for the printer
+	size_t items = 0; // Tokens, nodes or output bytes per run
+	size_t tree_bytes = 0; // Memory the parsed tree holds, parse stages only
+	std::vector<double> samples;
+
+	double percentile(double p) const { // Nearest rank on sorted samples
+		size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+		return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+	}
+	double mean() const {
+		double sum = 0;
+		for (double sample : samples) sum += sample;
+		return sum / samples.size();
+	}
+};
+
+// Run stage warmup times untimed, then iterations timed. stage returns the items it handled
+static BenchResult measure(const BenchOptions& options, const std::function<size_t()>& stage) {
+	using Clock = std::chrono::steady_clock;
+	BenchResult result;
+	for (size_t i = 0; i < options.warmup; ++i) stage();
+	for (size_t i = 0; i < options.iterations; ++i) {
+		auto start = Clock::now();
+		result.items = stage();
+		result.samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+	std::sort(result.samples.begin(), result.samples.end());
+	return result;
+}
+
+// Same visit order as NodeCounter, children through their indices
+static void countFlat(const FlatAST& ast, NodeId node, std::array<size_t, static_cast<size_t>(NodeKind::COUNT)>& counts) {
+	++counts[static_cast<size_t>(ast.kind(node))];
+	ast.forEachChild(node, [&](NodeId child) { countFlat(ast, child, counts); });
+}
+
+static void benchShape(const BenchOptions& options, SourceShape shape, std::vector<BenchResult>& results) {
+	GeneratorOptions generator;
+	generator.shape = shape;
+	generator.bytes = options.bytes;
+	generator.seed = options.seed;
+	std::string source = generateSource(generator);
+
+	BenchResult lex = measure(options, [&] {
+		Arena arena;
+		SymbolTable symbols;
+		return Lexer(arena, symbols).lex(source).size();
+	});
+	lex.stage = "lex";
+	lex.unit = "tokens";
+	lex.bytes = source.size();
+
+	// The parsers, walkers and printers get their input made once, outside the timed part
+	Arena token_arena;
+	SymbolTable symbols;
+	std::vector<Token*> tokens = Lexer(token_arena, symbols).lex(source);
+	BenchResult parse = measure(options, [&] {
+		Arena arena;
+		std::vector<AST*> ast = Parser(arena).parse(tokens);
+		return ast.size();
+	});
+	Arena tree_arena;
+	std::vector<AST*> ast = Parser(tree_arena).parse(tokens);
+	NodeCounter counter;
+	counter.countTree(ast);
+	parse.items = counter.total();
+	parse.stage = "parse";
+	parse.unit = "nodes";
+	parse.bytes = source.size();
+
+	BenchResult flat_parse = measure(options, [&] {
+		FlatAST flat(symbols);
+		FlatParser(flat).parse(tokens);
+		return flat.size();
+	});
+	FlatAST flat(symbols);
+	FlatParser(flat).parse(tokens);
+	flat_parse.stage = "flat_parse";
+	flat_parse.unit = "nodes";
+	flat_parse.bytes = source.size();
+
+	// Tree memory of a streaming parse, where the pointer tree copies every token it keeps into its arena
+	{
+		Arena lexer_arena, arena;
+		SymbolTable stream_symbols;
+		Lexer lexer(lexer_arena, stream_symbols);
+		lexer.begin(source);
+		Parser(arena).parse(lexer);
+		parse.tree_bytes = arena.bytesUsed();
+		FlatAST stream_flat(stream_symbols);
+		lexer.begin(source);
+		FlatParser(stream_flat).parse(lexer);
+		flat_parse.tree_bytes = stream_flat.bytesUsed();
+	}
+
+	BenchResult walk = measure(options, [&] {
+		NodeCounter walker;
+		walker.countTree(ast);
+		return walker.total();
+	});
+	walk.stage = "walk";
+	walk.unit = "nodes";
+	walk.bytes = source.size();
+
+	BenchResult flat_walk = measure(options, [&] {
+		std::array<size_t, static_cast<size_t>(NodeKind::COUNT)> counts{};
+		for (NodeId root : flat.roots()) countFlat(flat, root, counts);
+		size_t total = 0;
+		for (size_t count : counts) total += count;
+		return total;
+	});
+	flat_walk.stage = "flat_walk";
+	flat_walk.unit = "nodes";
+	flat_walk.bytes = source.size();
+
+	BenchResult print = measure(options, [&] {
+		std::ostringstream out;
+		ASTPrinter().print(ast, out);
+		return static_cast<size_t>(out.tellp());
+	});
+	print.stage = "print";
+	print.unit = "bytes";
+	print.bytes = print.items;
+
+	BenchResult flat_print = measure(options, [&] {
+		std::ostringstream out;
+		ASTPrinter().print(flat, out);
+		return static_cast<size_t>(out.tellp());
+	});
+	flat_print.stage = "flat_print";
+	flat_print.unit = "bytes";
+	flat_print.bytes = flat_print.items;
+
+	BenchResult json = measure(options, [&] {
+		std::ostringstream out;
+		JSONDumper().dump(ast, out);
+		return static_cast<size_t>(out.tellp());
+	});
+	json.stage = "json_dump";
+	json.unit = "bytes";
+	json.bytes = json.items;
+
+	BenchResult binary = measure(options, [&] {
+		std::ostringstream out;
+		BinaryDumper().dump(ast, out);
+		return static_cast<size_t>(out.tellp());
+	});
+	binary.stage = "binary_dump";
+	binary.unit = "bytes";
+	binary.bytes = binary.items;
+
+	for (BenchResult* result : { &lex, &parse, &flat_parse, &walk, &flat_walk, &print, &flat_print, &json, &binary }) {
+		result->shape = shapeName(shape);
+		results.push_back(std::move(*result));
+	}
+}
+
+// Array builtin and the while loop doing its work with len, get and push, leaving the result in s,
+// a 0 of the element type, or in the array c
+struct ArrayOp {
+	const char* name;
+	const char* loop;
+};
+
+static const ArrayOp ARRAY_OPS[] = {
+	{ "sum", "s = get(a, 0); var i: int = 1; while (i < len(a)) { s = s + get(a, i); i++; }" },
+	{ "dot", "var i: int = 0; while (i < len(a)) { s = s + get(a, i) * get(b, i); i++; }" },
+	{ "min", "s = get(a, 0); var i: int = 1; while (i < len(a)) { if (get(a, i) < s) { s = get(a, i); } i++; }" },
+	{ "max", "s = get(a, 0); var i: int = 1; while (i < len(a)) { if (get(a, i) > s) { s = get(a, i); } i++; }" },
+	{ "add", "var c: array; var i: int = 0; while (i < len(a)) { push(c, get(a, i) + get(b, i)); i++; }" },
+	{ "sub", "var c: array; var i: int = 0; while (i < len(a)) { push(c, get(a, i) - get(b, i)); i++; }" },
+	{ "mul", "var c: array; var i: int = 0; while (i < len(a)) { push(c, get(a, i) * get(b, i)); i++; }" },
+	{ "div", "var c: array; var i: int = 0; while (i < len(a)) { push(c, get(a, i) / get(b, i)); i++; }" },
+	{ "lt", "var c: array; var i: int = 0; while (i < len(a)) { push(c, get(a, i) < get(b, i)); i++; }" },
+	{ "eq", "var c: array; var i: int = 0; while (i < len(a)) { push(c, get(a, i) == get(b, i)); i++; }" },
+};
+
+// Lex, parse and run a script with the VM, output discarded
+static void runScript(const std::string& source) {
+	Arena arena;
+	SymbolTable symbols;
+	std::vector<Token*> tokens = Lexer(arena, symbols).lex(source);
+	std::vector<AST*> ast = Parser(arena).parse(tokens);
+	std::ostream null(nullptr);
+	Interpreter(null).run(ast);
+}
+
+// first, first + step ... n elements of an int or float array
+static DArray benchArray(ElementType type, size_t n, double first, double step) {
+	DArray array(type);
+	array.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		double value = first + step * static_cast<double>(i);
+		if (type == ElementType::FLOAT) array.set(i, value);
+		else array.set(i, static_cast<int64_t>(value));
+	}
+	return array;
+}
+
+// Every op on int and float arrays: the builtin at each SIMD level the CPU has, then the while loop.
+// Builtins are called directly, each run with a heap of its own so its result is freed. A loop runs in
+// a script, its samples have the median time of a script that only makes the arrays taken off
+static void benchArrays(const BenchOptions& options, std::vector<BenchResult>& results) {
+	SimdLevel initial = simdLevel();
+	size_t n = options.elements;
+	for (ElementType type : { ElementType::INT, ElementType::FLOAT }) {
+		const char* type_name = (type == ElementType::INT) ? "int" : "float";
+		// a and b as the script makes them: divisors are never 0, they cross halfway so comparisons go both ways
+		double offset = (type == ElementType::INT) ? 1 : 0.5;
+		Heap inputs;
+		Value args[2] = {
+			Value::fromArray(inputs.newArray(benchArray(type, n, offset, 1))),
+			Value::fromArray(inputs.newArray(benchArray(type, n, static_cast<double>(n) + 1 - offset, -1))),
+		};
+		std::string setup = std::format("var a: array = add(range({0}), fill({0}, {1})); var b: array = sub(fill({0}, {0} + 1), a); var s: {2} = 0;\n",
+			n, (type == ElementType::INT) ? "1" : "0.5", type_name);
+		BenchResult baseline = measure(options, [&] { runScript(setup); return 0; });
+
+		for (const ArrayOp& op : ARRAY_OPS) {
+			int index = findBuiltin(op.name);
+			auto record = [&](BenchResult result, const char* stage) {
+				result.shape = "arrays";
+				result.stage = std::format("{}_{}_{}", op.name, type_name, stage);
+				result.unit = "elements";
+				result.bytes = n * 8 * builtin(index).arity;
+				results.push_back(std::move(result));
+			};
+			for (int level = 0; level <= static_cast<int>(supportedSimdLevel()); ++level) {
+				setSimdLevel(static_cast<SimdLevel>(level));
+				record(measure(options, [&] {
+					Heap heap;
+					callBuiltin(index, args, heap, 0, 0);
+					return n;
+				}), simdLevelName(static_cast<SimdLevel>(level)));
+			}
+			setSimdLevel(initial);
+			BenchResult loop = measure(options, [&] { runScript(setup + op.loop + "\n"); return n; });
+			for (double& sample : loop.samples) sample = std::max(sample - baseline.percentile(0.5), 0.0);
+			record(std::move(loop), "loop");
+		}
+	}
+}
+
+static std::string escapeJson(std::string_view text) {
+	std::string escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\') escaped += '\\';
+		if (static_cast<unsigned char>(c) < 0x20) escaped += std::format("\\u{:04x}", c);
+		else escaped += c;
+	}
+	return escaped;
+}
+
+// Throughputs are taken at the median and at the p99 time, p99 is the slow end
+static std::string toJson(const BenchOptions& options, const std::vector<BenchResult>& results) {
+	std::string json = std::format("{{\n  \"benchmark\": \"dlang_bench\",\n  \"label\": \"{}\",\n  \"bytes\": {},\n  \"iterations\": {},\n  \"warmup\": {},\n  \"seed\": {},\n  \"results\": [\n",
+		escapeJson(options.label), options.bytes, options.iterations, options.warmup, options.seed);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchResult& result = results[i];
+		double median = result.percentile(0.5), p99 = result.percentile(0.99);
+		json += std::format("    {{ \"shape\": \"{}\", \"stage\": \"{}\", \"bytes\": {}, \"{}\": {}, "
+			"\"median_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"min_ms\": {:.4f}, \"mean_ms\": {:.4f}, "
+			"\"median_mb_per_s\": {:.2f}, \"p99_mb_per_s\": {:.2f}, \"median_{}_per_s\": {:.0f}, \"p99_{}_per_s\": {:.0f}{} }}{}\n",
+			result.shape, result.stage, result.bytes, result.unit, result.items,
+			median, p99, result.samples.front(), result.mean(),
+			result.bytes / median / 1000, result.bytes / p99 / 1000,
+			result.unit, result.items / median * 1000, result.unit, result.items / p99 * 1000,
+			result.tree_bytes ? std::format(", \"tree_bytes\": {}, \"bytes_per_node\": {:.1f}", result.tree_bytes, double(result.tree_bytes) / result.items) : "",
+			i + 1 < results.size() ? "," : "");
+	}
+	json += "  ]\n}\n";
+	return json;
+}
+
+static void printResult(const BenchResult& result) {
+	std::cerr << std::format("{:<17} {:<10} median {:9.3f} ms  p99 {:9.3f} ms  {:8.2f} MB/s  {:12.0f} {}/s{}\n", result.shape, result.stage,
+		result.percentile(0.5), result.percentile(0.99), result.bytes / result.percentile(0.5) / 1000,
+		result.items / result.percentile(0.5) * 1000, result.unit,
+		result.tree_bytes ? std::format("  {:.1f} bytes/node", double(result.tree_bytes) / result.items) : "");
+}
+
+void printUsage() {
+	std::cerr << "Usage: dlang_bench [options]\n"
+		<< "  --size MB        size of each generated source, 1 by default\n"
+		<< "  --iterations N   timed runs of every stage, 20 by default\n"
+		<< "  --warmup N       untimed runs before them, 3 by default\n"
+		<< "  --shape NAME     mixed, deep_expressions, many_functions, long_arrays, heavy_comments\n"
+		<< "                   or long_strings, every shape by default\n"
+		<< "  --seed N         seed of the generator\n"
+		<< "  --label TEXT     stored in the report, a commit hash for example\n"
+		<< "  --out FILE       write the JSON report to FILE instead of stdout\n"
+		<< "  --emit FILE      only write the generated source of --shape to FILE\n"
+		<< "  --arrays         measure the array builtins instead, see below\n"
+		<< "  --elements N     elements of every array with --arrays, 100000 by default\n"
+		<< "Measures Lexer::lex (MB/s, tokens/s), Parser::parse and FlatParser::parse (nodes/s, tree bytes per node),\n"
+		<< "a walk over every node of both trees (nodes/s), ASTPrinter on both trees and the JSON and binary dumps (bytes/s).\n"
+		<< "With --arrays: sum dot min max add sub mul div lt eq on int and float arrays (elements/s), as builtins at every\n"
+		<< "SIMD level of the CPU and as the equivalent while loop over get and push, run by the VM.\n";
+}
+
+int main(int argc, char** argv) {
+	BenchOptions options;
+	for (int i = 1; i < argc; ++i) {
+		bool has_value = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--size") && has_value) options.bytes = static_cast<size_t>(std::strtod(argv[++i], nullptr) * (1 << 20));
+		else if (!std::strcmp(argv[i], "--iterations") && has_value) options.iterations = std::strtoul(argv[++i], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--warmup") && has_value) options.warmup = std::strtoul(argv[++i], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--seed") && has_value) options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--label") && has_value) options.label = argv[++i];
+		else if (!std::strcmp(argv[i], "--out") && has_value) options.out = argv[++i];
+		else if (!std::strcmp(argv[i], "--emit") && has_value) options.emit = argv[++i];
+		else if (!std::strcmp(argv[i], "--arrays")) options.arrays = true;
+		else if (!std::strcmp(argv[i], "--elements") && has_value) options.elements = std::strtoul(argv[++i], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--shape") && has_value) {
+			options.shape = shapeFromName(argv[++i]);
+			if (!options.shape) { printUsage(); return 1; }
+		}
+		else { printUsage(); return 1; }
+	}
+	if (!options.iterations || !options.bytes || !options.elements) { printUsage(); return 1; }
+
+	if (!options.emit.empty()) {
+		GeneratorOptions generator;
+		generator.shape = options.shape.value_or(SourceShape::MIXED);
+		generator.bytes = options.bytes;
+		generator.seed = options.seed;
+		std::ofstream file(options.emit, std::ios::binary);
+		file << generateSource(generator);
+		return file ? 0 : 1;
+	}
+
+	std::vector<BenchResult> results;
+	if (options.arrays) {
+		try {
+			benchArrays(options, results);
+		}
+		catch (const std::exception& err) {
+			std::cerr << "Array script failed: " << err.what();
+			return 1;
+		}
+		for (const BenchResult& result : results) printResult(result);
+	}
+	else try {
+		for (size_t shape = 0; shape < static_cast<size_t>(SourceShape::COUNT); ++shape) {
+			if (options.shape && *options.shape != static_cast<SourceShape>(shape)) continue;
+			size_t first = results.size();
+			benchShape(options, static_cast<SourceShape>(shape), results);
+			for (size_t i = first; i < results.size(); ++i) printResult(results[i]);
+		}
+	}
+	catch (const std::exception& err) {
+		std::cerr << "Generated source failed to parse: " << err.what();
+		return 1;
+	}
+
+	std::string json = toJson(options, results);
+	if (options.out.empty()) std::cout << json;
+	else {
+		std::ofstream file(options.out);
+		file << json;
+		if (!file) { std::cerr << "Can't write " << options.out << "\n"; return 1; }
+	}
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include <array>
+#include <random>
+#include "source_generator.h"
+
+static constexpr std::array<const char*, static_cast<size_t>(SourceShape::COUNT)> SHAPE_NAMES = {
+	"mixed", "deep_expressions", "many_functions", "long_arrays", "heavy_comments", "long_strings"
+};
+
+const char* shapeName(SourceShape shape) { return SHAPE_NAMES[static_cast<size_t>(shape)]; }
+
+std::optional<SourceShape> shapeFromName(std::string_view name) {
+	for (size_t i = 0; i < SHAPE_NAMES.size(); ++i)
+		if (name == SHAPE_NAMES[i]) return static_cast<SourceShape>(i);
+	return std::nullopt;
+}
+
+// Identifiers are letters only, so numbers are written in base 26.
+// The prefixes are capitals, a name never spells a keyword
+static std::string name(const char* prefix, size_t number) {
+	std::string result = prefix;
+	do {
+		result += static_cast<char>('a' + number % 26);
+		number /= 26;
+	} while (number);
+	return result;
+}
+
+class SourceGenerator {
+private:
+	const GeneratorOptions& m_options;
+	std::mt19937 m_random;
+	std::string m_out;
+	size_t m_ints = 0; // Global int variables declared so far, named by name("I", n)
+	size_t m_functions = 0; // Functions declared so far, named by name("F", n)
+	size_t m_others = 0; // Counter for globals of any other type
+
+private:
+	size_t pick(size_t count) { return std::uniform_int_distribution<size_t>(0, count - 1)(m_random); }
+	std::string intAtom() { return (m_ints && pick(2)) ? name("I", pick(m_ints)) : std::to_string(1 + pick(99)); }
+	const char* binaryOp() {
+		static constexpr const char* OPS[] = { "+", "-", "*", "/", "+", "-" };
+		return OPS[pick(std::size(OPS))];
+	}
+
+	// Left and right nested parentheses, then a flat chain left to the precedence climbing loop
+	std::string deepExpression(size_t depth) {
+		std::string expr = intAtom();
+		for (size_t i = 0; i < depth; ++i) {
+			if (pick(2)) expr = "(" + expr + " " + binaryOp() + " " + intAtom() + ")";
+			else expr = "(" + intAtom() + " " + binaryOp() + " " + expr + ")";
+			if (!pick(8)) expr = "-" + expr;
+		}
+		for (size_t i = 0; i < depth; ++i) expr += std::string(" ") + binaryOp() + " " + intAtom();
+		return expr;
+	}
+
+	void declareInt(const std::string& expr) {
+		m_out += "var " + name("I", m_ints++) + ": int = " + expr + ";\n";
+	}
+
+	void expressionStatement() { declareInt(deepExpression(m_options.depth)); }
+
+	void function() {
+		std::string current = name("F", m_functions);
+		m_out += "func " + current + "(var a: int, const b: float) -> int {\n"
+			"\tvar x: int = a * " + std::to_string(1 + pick(9)) + " + " + intAtom() + ";\n"
+			"\tif (x > " + std::to_string(pick(100)) + " && a != 0) { x -= 1; }\n"
+			"\twhile (x < 100) { x += a + 1; x++; }\n";
+		if (m_functions) m_out += "\treturn x + " + name("F", pick(m_functions)) + "(a - 1, b);\n";
+		else m_out += "\treturn x;\n";
+		m_out += "}\n";
+		if (!pick(4)) declareInt(current + "(" + intAtom() + ", " + std::to_string(pick(10)) + ".5)");
+		++m_functions;
+	}
+
+	void array() {
+		size_t kind = pick(3);
+		m_out += "var " + name("A", m_others++) + ": array = [";
+		for (size_t i = 0; i < m_options.array_length; ++i) {
+			if (i) m_out += ", ";
+			if (kind == 0) m_out += std::to_string(pick(100000));
+			else if (kind == 1) m_out += std::to_string(pick(1000)) + "." + std::to_string(pick(100));
+			else m_out += "\"item" + std::to_string(i) + "\"";
+		}
+		m_out += "];\n";
+	}
+
+	void comments() {
+		static constexpr const char* WORDS[] = { "lexer", "skips", "every", "comment", "byte", "before", "the", "next", "token", "so", "this", "text", "costs", "only", "scanning" };
+		size_t lines = 2 + pick(6);
+		for (size_t i = 0; i < lines; ++i) {
+			m_out += "// ";
+			for (size_t j = 0, words = 6 + pick(10); j < words; ++j) m_out += std::string(WORDS[pick(std::size(WORDS))]) + " ";
+			m_out += "\n";
+		}
+		declareInt(intAtom() + " + " + intAtom());
+		m_out.pop_back();
+		m_out += " // trailing comment after a short statement\n";
+	}
+
+	void longString() {
+		static constexpr char TEXT[] = "lorem ipsum dolor sit amet consectetur adipiscing elit ";
+		std::string variable = name("S", m_others++);
+		m_out += "var " + variable + ": string = \"";
+		for (size_t i = 0; i < m_options.string_length; ++i) m_out += TEXT[(i + pick(4)) % (sizeof(TEXT) - 1)];
+		m_out += "\";\n";
+		if (!pick(3)) m_out += variable + " = " + variable + " + \"!\";\n";
+	}
+
+	// Control flow at the top level, only in the mixed shape
+	void control() {
+		if (!m_ints) declareInt(intAtom());
+		std::string var = name("I", pick(m_ints));
+		if (pick(2)) m_out += "if (" + var + " > " + std::to_string(pick(50)) + ") {\n\tprint(" + var + ");\n}\n";
+		else m_out += "while (" + var + " < " + std::to_string(pick(50)) + ") {\n\t" + var + " += 1;\n}\n";
+	}
+
+	void statement(SourceShape shape) {
+		switch (shape) {
+			case SourceShape::DEEP_EXPRESSIONS: expressionStatement(); break;
+			case SourceShape::MANY_FUNCTIONS: function(); break;
+			case SourceShape::LONG_ARRAYS: array(); break;
+			case SourceShape::HEAVY_COMMENTS: comments(); break;
+			case SourceShape::LONG_STRINGS: longString(); break;
+			default: {
+				size_t choice = pick(7);
+				if (choice == 6) declareInt(deepExpression(2));
+				else if (choice == 5) control();
+				else statement(static_cast<SourceShape>(choice + 1));
+			}
+		}
+	}
+
+public:
+	SourceGenerator(const GeneratorOptions& options): m_options(options), m_random(options.seed) {}
+
+	std::string generate() {
+		m_out.reserve(m_options.bytes + 4096);
+		m_out += "// Generated " + std::string(shapeName(m_options.shape)) + " source, seed " + std::to_string(m_options.seed) + "\n";
+		while (m_out.size() < m_options.bytes) statement(m_options.shape);
+		return std::move(m_out);
+	}
+};
+
+std::string generateSource(const GeneratorOptions& options) {
+	return SourceGenerator(options).generate();
+}
@@ -0,0 +1,28 @@
+#ifndef SOURCE_GENERATOR_H
+#define SOURCE_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// What the generated statements mostly look like, each one stresses a different part of the front end
+enum class SourceShape { MIXED, DEEP_EXPRESSIONS, MANY_FUNCTIONS, LONG_ARRAYS, HEAVY_COMMENTS, LONG_STRINGS, COUNT };
+
+struct GeneratorOptions {
+	SourceShape shape = SourceShape::MIXED;
+	size_t bytes = 1 << 20; // Generation stops at the first statement boundary past this size
+	size_t depth = 24; // Nesting of parentheses in deep expressions
+	size_t array_length = 256; // Elements per array literal
+	size_t string_length = 512; // Characters per long string literal
+	uint32_t seed = 1; // Same options and seed, same source
+};
+
+// Valid DLang source of about options.bytes. Every variable and function is declared before it's used,
+// so the result lexes, parses and compiles. Nothing is meant to be run.
+std::string generateSource(const GeneratorOptions& options);
+
+const char* shapeName(SourceShape shape);
+std::optional<SourceShape> shapeFromName(std::string_view name);
+#endif // !SOURCE_GENERATOR_H
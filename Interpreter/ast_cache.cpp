@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include "ast_cache.h"
+#include "../Parser/AST/ast_serializer.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#if __has_include("build_id.h")
+#include "build_id.h" // DLANG_BUILD_ID, a hash of the sources of this build
+#else
+#define DLANG_BUILD_ID "unknown"
+#endif
+
+// Fixed part of a cache file, the tree image follows it
+struct CacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t key, check; // Two independent hashes of the source
+	uint64_t size; // Source size in bytes
+	uint64_t image; // Hash of the image, a damaged entry is a miss instead of a broken tree
+	uint32_t folded, simplified, branches; // Fold stats of the run that wrote the entry
+	uint32_t fold;
+};
+
+constexpr char CACHE_MAGIC[4] = { 'D', 'L', 'A', 'C' };
+
+// Two 64-bit hashes of text in one pass, eight bytes per step. For a source the first names the file,
+// the second is stored inside it, a wrong tree needs both to collide.
+static void hashBytes(std::string_view text, uint64_t seed, uint64_t& key, uint64_t& check) {
+	uint64_t a = seed ^ (text.size() * 0x9E3779B97F4A7C15ull), b = ~seed;
+	size_t i = 0;
+	for (; i + 8 <= text.size(); i += 8) {
+		uint64_t word;
+		std::memcpy(&word, text.data() + i, 8);
+		a = (a ^ word) * 0xBF58476D1CE4E5B9ull;
+		a ^= a >> 31;
+		b = (b + word) * 0x94D049BB133111EBull;
+		b ^= b >> 29;
+	}
+	uint64_t tail = 0;
+	std::memcpy(&tail, text.data() + i, text.size() - i);
+	a = (a ^ tail) * 0xBF58476D1CE4E5B9ull;
+	b = (b + tail) * 0x94D049BB133111EBull;
+	key = a ^ (a >> 32);
+	check = b ^ (b >> 32);
+}
+
+// Sizes of the node classes, they change with a node even when AST_FORMAT_VERSION was forgotten
+static constexpr uint64_t NODE_LAYOUT = [] {
+	uint64_t layout = 0;
+	for (size_t size : { sizeof(IntNode), sizeof(FloatNode), sizeof(StrNode), sizeof(ArrayNode), sizeof(IdNode), sizeof(UnOpNode),
+		sizeof(BinOpNode), sizeof(EmptyVarDeclNode), sizeof(FullVarDeclNode), sizeof(ReasignVarNode), sizeof(BlockOfCodeNode),
+		sizeof(IfStmtNode), sizeof(WhileStmtNode), sizeof(FuncNode), sizeof(FuncParamNode), sizeof(IncDecNode), sizeof(FuncCallNode),
+		sizeof(ReturnStmtNode), sizeof(Token) })
+		layout = layout * 257 + size;
+	return layout;
+}();
+
+// Entries of another build, format or fold setting get other names, a build never reads a tree another one wrote
+static uint64_t seed(bool fold) {
+	static const uint64_t build = [] {
+		uint64_t key, check;
+		hashBytes(DLANG_BUILD_ID, NODE_LAYOUT ^ AST_FORMAT_VERSION, key, check);
+		return key;
+	}();
+	return (build << 1) | (fold ? 1 : 0);
+}
+
+std::filesystem::path ASTCache::defaultDirectory() {
+	if (const char* dir = std::getenv("DLANG_CACHE_DIR"); dir && *dir) return dir;
+	if (const char* dir = std::getenv("XDG_CACHE_HOME"); dir && *dir) return std::filesystem::path(dir) / "dlang";
+#ifdef _WIN32
+	if (const char* dir = std::getenv("LOCALAPPDATA"); dir && *dir) return std::filesystem::path(dir) / "dlang" / "cache";
+#else
+	if (const char* dir = std::getenv("HOME"); dir && *dir) return std::filesystem::path(dir) / ".cache" / "dlang";
+#endif
+	return {};
+}
+
+std::filesystem::path ASTCache::entryPath(uint64_t key) const {
+	return m_directory / std::format("{:016x}.ast", key);
+}
+
+bool ASTCache::load(CompilationUnit& unit, bool fold) const {
+	std::string_view source = unit.source.view();
+	CacheHeader expected;
+	hashBytes(source, seed(fold), expected.key, expected.check);
+	if (!unit.cached.open(entryPath(expected.key).string())) return false;
+
+	std::string_view file = unit.cached.view();
+	CacheHeader header;
+	if (file.size() < sizeof(header)) return false;
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) || header.version != AST_FORMAT_VERSION || header.key != expected.key
+		|| header.check != expected.check || header.size != source.size() || header.fold != (fold ? 1u : 0u)) return false;
+
+	std::string_view image = file.substr(sizeof(header));
+	uint64_t image_hash, unused;
+	hashBytes(image, 0, image_hash, unused);
+	if (image_hash != header.image) return false;
+
+	if (!ASTReader(unit.arena, unit.symbols).read(image, unit.ast)) {
+		// The reader may have interned names and made nodes before it found the damage
+		unit.ast.clear();
+		unit.arena.release();
+		unit.symbols = SymbolTable();
+		return false;
+	}
+	unit.fold_stats = { header.folded, header.simplified, header.branches };
+	return true;
+}
+
+void ASTCache::store(const CompilationUnit& unit, bool fold) const {
+	// Only whole trees: a unit with an error or a missing statement is parsed again next time
+	if (!unit.error.empty() || std::find(unit.ast.begin(), unit.ast.end(), nullptr) != unit.ast.end()) return;
+	std::string image = ASTWriter().write(unit.ast, unit.symbols);
+	if (image.empty()) return;
+	CacheHeader header;
+	std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = AST_FORMAT_VERSION;
+	hashBytes(unit.source.view(), seed(fold), header.key, header.check);
+	header.size = unit.source.view().size();
+	uint64_t unused;
+	hashBytes(image, 0, header.image, unused);
+	header.folded = static_cast<uint32_t>(unit.fold_stats.folded);
+	header.simplified = static_cast<uint32_t>(unit.fold_stats.simplified);
+	header.branches = static_cast<uint32_t>(unit.fold_stats.branches);
+	header.fold = fold ? 1 : 0;
+
+	// Several processes or workers may store the same script at once, each writes its own temporary file
+	static std::atomic<unsigned> counter = 0;
+	std::error_code error;
+	std::filesystem::create_directories(m_directory, error);
+	std::filesystem::path entry = entryPath(header.key);
+	std::filesystem::path temporary = entry;
+	temporary += std::format(".{}.{}.tmp", getpid(), counter++);
+	{
+		std::ofstream file(temporary, std::ios::binary);
+		if (!file.is_open()) return;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(image.data(), image.size());
+		if (!file) { file.close(); std::filesystem::remove(temporary, error); return; }
+	}
+	std::filesystem::rename(temporary, entry, error);
+	if (error) std::filesystem::remove(temporary, error);
+}
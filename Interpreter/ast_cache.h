@@ -0,0 +1,31 @@
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include "batch.h"
+
+// Directory of parsed (and folded) trees, one file per script content.
+// A file is named after a hash of the source, the build (its sources and node layout), the image format version
+// and whether it was folded, so an unchanged script is read back with no lexing, parsing or folding, wherever it
+// lives and whatever it's called.
+// Entries are written to a temporary name and renamed, a run never sees a half written file.
+// Nothing is ever evicted, delete the directory to clear it. Scripts with errors are not cached.
+class ASTCache {
+private:
+	std::filesystem::path m_directory;
+
+private:
+	std::filesystem::path entryPath(uint64_t key) const;
+
+public:
+	explicit ASTCache(std::filesystem::path directory): m_directory(std::move(directory)) {}
+
+	// $DLANG_CACHE_DIR, else $XDG_CACHE_HOME/dlang, else ~/.cache/dlang. Empty if none is set.
+	static std::filesystem::path defaultDirectory();
+
+	bool load(CompilationUnit& unit, bool fold) const; // Fill unit.ast from the cache, false on a miss
+	void store(const CompilationUnit& unit, bool fold) const; // Best effort, a failed write is ignored
+};
+#endif // !AST_CACHE_H
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <stdexcept>
+#include "batch.h"
+#include "ast_cache.h"
+#include "../Parser/Lexer/parallel_lexer.h"
+#include "../Error/error.h"
+
+void parseUnit(CompilationUnit& unit, const ParseOptions& options) {
+	if (options.stats) unit.stats.enable();
+	Stats* stats = &unit.stats;
+	{
+		ScopedTimer timer(stats, Phase::LOAD);
+		if (!unit.source.open(unit.path)) {
+			unit.error = std::format("Cant't find file: {}\n", unit.path);
+			return;
+		}
+		timer.setBytes(unit.source.view().size());
+	}
+	unit.found = true;
+	unit.stats.addScript();
+	if (options.cache) {
+		bool loaded;
+		{
+			ScopedTimer timer(stats, Phase::CACHE, &unit.arena);
+			loaded = options.cache->load(unit, options.fold);
+		}
+		if (loaded) {
+			if (unit.stats.enabled()) unit.stats.countNodes(unit.ast);
+			return;
+		}
+	}
+	try {
+		Parser parser(unit.arena);
+		std::vector<Token*> tokens;
+		{
+			// On a lexical error the file is streamed instead, a syntax error before it must be reported first
+			ScopedTimer timer(stats, Phase::LEX, &unit.arena);
+			if (options.lex_pool && unit.source.view().size() >= 2 * ParallelLexer::MIN_CHUNK_SIZE) {
+				try { tokens = ParallelLexer(unit.arena, unit.symbols, *options.lex_pool).lex(unit.source.view(), unit.path.c_str()); }
+				catch (const std::runtime_error&) { tokens.clear(); }
+			}
+			// Streaming interleaves lexing and parsing, with stats the tokens are listed first so each phase gets its own time
+			else if (unit.stats.enabled()) {
+				try { tokens = Lexer(unit.arena, unit.symbols).lex(unit.source.view(), unit.path.c_str()); }
+				catch (const std::runtime_error&) { tokens.clear(); }
+			}
+		}
+		{
+			ScopedTimer timer(stats, Phase::PARSE, &unit.arena);
+			if (!tokens.empty()) unit.ast = parser.parse(tokens);
+			else {
+				Lexer lexer(unit.arena, unit.symbols);
+				lexer.begin(unit.source.view(), unit.path.c_str());
+				unit.ast = parser.parse(lexer);
+			}
+		}
+		if (options.fold) {
+			ScopedTimer timer(stats, Phase::FOLD, &unit.arena);
+			ConstantFolder folder(unit.arena);
+			folder.fold(unit.ast);
+			unit.fold_stats = folder.stats();
+		}
+		if (options.cache) {
+			ScopedTimer timer(stats, Phase::CACHE);
+			options.cache->store(unit, options.fold);
+		}
+		if (unit.stats.enabled()) {
+			unit.stats.countTokens(tokens);
+			unit.stats.countNodes(unit.ast);
+		}
+	}
+	catch (const std::exception& err) {
+		unit.ast.clear();
+		unit.error = err.what();
+	}
+}
+
+std::vector<std::unique_ptr<CompilationUnit>> parseFiles(const std::vector<std::string>& paths, ThreadPool& pool, const ParseOptions& options) {
+	std::vector<std::unique_ptr<CompilationUnit>> units;
+	std::vector<uintmax_t> sizes;
+	for (const std::string& path : paths) {
+		units.push_back(std::make_unique<CompilationUnit>(path));
+		std::error_code error;
+		uintmax_t size = std::filesystem::file_size(path, error);
+		sizes.push_back(error ? 0 : size);
+	}
+	std::vector<size_t> order(paths.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+	ParseOptions unit_options = options;
+	unit_options.lex_pool = nullptr;
+	for (size_t index : order) {
+		CompilationUnit* unit = units[index].get();
+		pool.submit([unit, unit_options] { parseUnit(*unit, unit_options); });
+	}
+	pool.wait();
+	return units;
+}
@@ -0,0 +1,47 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "constant_folder.h"
+#include "../Parser/parser.h"
+#include "../Source/source_file.h"
+#include "../Stats/stats.h"
+#include "../Thread/thread_pool.h"
+
+class ASTCache;
+
+// One script of a batch with everything its tree points into.
+// Units share nothing, so each one can be lexed and parsed on its own thread.
+struct CompilationUnit {
+	std::string path;
+	SourceFile source;
+	Arena arena;
+	SymbolTable symbols;
+	std::vector<AST*> ast;
+	bool found = false; // The file could be read
+	std::string error; // First lexical or syntax error, empty if the file parsed
+	ConstantFolder::Stats fold_stats;
+	SourceFile cached; // Cache entry the tree was read from, its names and strings point into it
+	Stats stats; // Filled while the unit is handled if enabled
+
+	CompilationUnit(std::string path): path(std::move(path)) {}
+};
+
+// How parseUnit handles a unit
+struct ParseOptions {
+	bool fold = true; // Run the constant folder on the tree
+	bool stats = false; // Time the phases and count tokens and nodes into unit.stats
+	ThreadPool* lex_pool = nullptr; // Lex large files in parallel chunks on it instead of streaming them
+	const ASTCache* cache = nullptr; // Load unchanged scripts from it, add newly parsed ones to it
+};
+
+// Read, lex, parse and fold one file, errors are kept in the unit
+void parseUnit(CompilationUnit& unit, const ParseOptions& options);
+
+// Parse every file on the pool. Units are returned in the order of paths, whatever order they finish in.
+// Bigger files are submitted first so a large one doesn't start last and leave the other workers idle.
+// options.lex_pool is ignored, the files are already spread over the pool.
+std::vector<std::unique_ptr<CompilationUnit>> parseFiles(const std::vector<std::string>& paths, ThreadPool& pool, const ParseOptions& options);
+#endif // !BATCH_H
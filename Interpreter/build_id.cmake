@@ -0,0 +1,11 @@
+# Run by the build (see CMakeLists.txt) whenever a source changes: DLANG_BUILD_ID is a hash of every source,
+# written to OUTPUT from build_id.h.in. SOURCES is a list separated by |, relative to the working directory.
+string( REPLACE "|" ";" SOURCES "${SOURCES}" )
+set( HASHES "" )
+foreach( SOURCE ${SOURCES} )
+	file( SHA256 "${SOURCE}" HASH )
+	string( APPEND HASHES "${HASH}" )
+endforeach()
+string( SHA256 DLANG_BUILD_ID "${HASHES}" )
+# Only rewritten when the hash changes, so only ast_cache.cpp is built again
+configure_file( "${INPUT}" "${OUTPUT}" @ONLY )
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <format>
+#include <span>
+#include <vector>
+#include "builtins.h"
+#include "../Object/Array/simd.h"
+#include "../Error/error.h"
+
+static const char* elementTypeName(ElementType type) {
+	switch (type) {
+		case ElementType::INT: return "int";
+		case ElementType::FLOAT: return "float";
+		case ElementType::BOOL: return "bool";
+		case ElementType::CHAR: return "char";
+		default: return "string";
+	}
+}
+
+// Element type of an array made from a value ( fill, push into an empty array )
+static ElementType elementTypeOf(const Value& value, size_t line, size_t column) {
+	switch (value.type) {
+		case ValueType::INT: return ElementType::INT;
+		case ValueType::FLOAT: return ElementType::FLOAT;
+		case ValueType::BOOL: return ElementType::BOOL;
+		case ValueType::STRING: return ElementType::STRING;
+		default: raiseError(std::format("RUNTIME ERROR: Arrays can't hold {} in {}:{}\n", valueTypeName(value.type), line, column));
+	}
+	return ElementType::INT;
+}
+
+// Elements take what a variable of their type takes: numbers convert like int and float variables,
+// bools keep the truthiness of ints and chars their low byte
+static void checkStore(ElementType type, const Value& value, size_t line, size_t column) {
+	bool valid = value.isNumber();
+	if (type == ElementType::STRING) valid = value.type == ValueType::STRING;
+	else if (type == ElementType::BOOL) valid = value.type == ValueType::BOOL || value.type == ValueType::INT;
+	if (!valid) raiseError(std::format("RUNTIME ERROR: Can't store {} in an array of {} in {}:{}\n", valueTypeName(value.type), elementTypeName(type), line, column));
+}
+
+// Calls write with the value converted to the C++ type of the element type
+template <typename Write> static void convert(ElementType type, const Value& value, Write write) {
+	switch (type) {
+		case ElementType::INT: write(value.asInt()); break;
+		case ElementType::FLOAT: write(value.asFloat()); break;
+		case ElementType::BOOL: write(static_cast<uint8_t>(isTruthy(value))); break;
+		case ElementType::CHAR: write(static_cast<char>(value.asInt())); break;
+		default: write(value.s); break;
+	}
+}
+
+static size_t checkIndex(const DArray& array, int64_t index, size_t line, size_t column) {
+	if (index < 0 || static_cast<size_t>(index) >= array.size())
+		raiseError(std::format("RUNTIME ERROR: Index {} is out of range for an array of {} elements in {}:{}\n", index, array.size(), line, column));
+	return static_cast<size_t>(index);
+}
+
+static void checkNumeric(const char* name, const DArray& array, size_t line, size_t column) {
+	if (array.type() == ElementType::STRING) raiseError(std::format("RUNTIME ERROR: {} takes arrays of numbers, not of string in {}:{}\n", name, line, column));
+}
+
+static void checkLengths(const char* name, const DArray& left, const DArray& right, size_t line, size_t column) {
+	if (left.size() != right.size()) raiseError(std::format("RUNTIME ERROR: {} takes arrays of one length, not {} and {} in {}:{}\n", name, left.size(), right.size(), line, column));
+}
+
+// Elements of a numeric array as int64, bool and char arrays are widened into scratch
+static std::span<const int64_t> ints(const DArray& array, std::vector<int64_t>& scratch) {
+	if (array.type() == ElementType::INT) return array.elements<int64_t>();
+	scratch.resize(array.size());
+	if (array.type() == ElementType::BOOL) std::ranges::copy(array.elements<uint8_t>(), scratch.begin());
+	else std::ranges::copy(array.elements<char>(), scratch.begin());
+	return scratch;
+}
+
+// Elements of a numeric array as double, anything but a float array is converted into scratch
+static std::span<const double> floats(const DArray& array, std::vector<double>& scratch) {
+	if (array.type() == ElementType::FLOAT) return array.elements<double>();
+	std::vector<int64_t> widened;
+	std::span<const int64_t> source = ints(array, widened);
+	scratch.assign(source.begin(), source.end());
+	return scratch;
+}
+
+static Value len(const Value* args, Heap&, size_t, size_t) {
+	return Value::fromInt(static_cast<int64_t>(args[0].a->size()));
+}
+
+static Value get(const Value* args, Heap&, size_t line, size_t column) {
+	return arrayElement(*args[0].a, checkIndex(*args[0].a, args[1].asInt(), line, column));
+}
+
+static Value set(const Value* args, Heap&, size_t line, size_t column) {
+	DArray& array = *args[0].a;
+	size_t index = checkIndex(array, args[1].asInt(), line, column);
+	checkStore(array.type(), args[2], line, column);
+	convert(array.type(), args[2], [&](auto element) { array.set(index, element); });
+	return Value();
+}
+
+// An empty array takes the type of the first value pushed into it
+static Value push(const Value* args, Heap&, size_t line, size_t column) {
+	DArray& array = *args[0].a;
+	if (array.empty()) array = DArray(elementTypeOf(args[1], line, column));
+	checkStore(array.type(), args[1], line, column);
+	convert(array.type(), args[1], [&](auto element) { array.append(element); });
+	return Value();
+}
+
+static Value slice(const Value* args, Heap& heap, size_t, size_t) {
+	int64_t from = std::max<int64_t>(args[1].asInt(), 0), to = std::max<int64_t>(args[2].asInt(), 0);
+	return Value::fromArray(heap.newArray(args[0].a->slice(static_cast<size_t>(from), static_cast<size_t>(to))));
+}
+
+// Array of count copies of a value
+static Value fill(const Value* args, Heap& heap, size_t line, size_t column) {
+	int64_t count = args[0].asInt();
+	if (count < 0) raiseError(std::format("RUNTIME ERROR: Array size can't be negative, got {} in {}:{}\n", count, line, column));
+	DArray array(elementTypeOf(args[1], line, column));
+	array.resize(static_cast<size_t>(count));
+	convert(array.type(), args[1], [&](auto element) { std::ranges::fill(array.mutableElements<decltype(element)>(), element); });
+	return Value::fromArray(heap.newArray(std::move(array)));
+}
+
+// Ints 0 to count - 1
+static Value range(const Value* args, Heap& heap, size_t line, size_t column) {
+	int64_t count = args[0].asInt();
+	if (count < 0) raiseError(std::format("RUNTIME ERROR: Array size can't be negative, got {} in {}:{}\n", count, line, column));
+	DArray array(ElementType::INT);
+	array.resize(static_cast<size_t>(count));
+	std::span<int64_t> elements = array.mutableElements<int64_t>();
+	for (size_t i = 0; i < elements.size(); ++i) elements[i] = static_cast<int64_t>(i);
+	return Value::fromArray(heap.newArray(std::move(array)));
+}
+
+static Value sum(const Value* args, Heap&, size_t line, size_t column) {
+	const DArray& array = *args[0].a;
+	checkNumeric("sum", array, line, column);
+	if (array.type() == ElementType::FLOAT) return Value::fromFloat(sumFloat(array.elements<double>().data(), array.size()));
+	std::vector<int64_t> scratch;
+	return Value::fromInt(sumInt(ints(array, scratch).data(), array.size()));
+}
+
+static Value dot(const Value* args, Heap&, size_t line, size_t column) {
+	const DArray &left = *args[0].a, &right = *args[1].a;
+	checkNumeric("dot", left, line, column);
+	checkNumeric("dot", right, line, column);
+	checkLengths("dot", left, right, line, column);
+	if (left.type() == ElementType::FLOAT || right.type() == ElementType::FLOAT) {
+		std::vector<double> leftScratch, rightScratch;
+		return Value::fromFloat(dotFloat(floats(left, leftScratch).data(), floats(right, rightScratch).data(), left.size()));
+	}
+	std::vector<int64_t> leftScratch, rightScratch;
+	return Value::fromInt(dotInt(ints(left, leftScratch).data(), ints(right, rightScratch).data(), left.size()));
+}
+
+template <bool Min> static Value extreme(const Value* args, Heap&, size_t line, size_t column) {
+	const char* name = Min ? "min" : "max";
+	const DArray& array = *args[0].a;
+	checkNumeric(name, array, line, column);
+	if (array.empty()) raiseError(std::format("RUNTIME ERROR: {} of an empty array in {}:{}\n", name, line, column));
+	if (array.type() == ElementType::FLOAT) {
+		const double* elements = array.elements<double>().data();
+		return Value::fromFloat(Min ? minFloat(elements, array.size()) : maxFloat(elements, array.size()));
+	}
+	std::vector<int64_t> scratch;
+	const int64_t* elements = ints(array, scratch).data();
+	return Value::fromInt(Min ? minInt(elements, array.size()) : maxInt(elements, array.size()));
+}
+
+// Element-wise + - * /, an int array with a float one gives floats
+template <TokenType Op> static Value elementWise(const Value* args, Heap& heap, size_t line, size_t column) {
+	const char* name = (Op == TokenType::PLUS) ? "add" : (Op == TokenType::MINUS) ? "sub" : (Op == TokenType::MULTIPLY) ? "mul" : "div";
+	const DArray &left = *args[0].a, &right = *args[1].a;
+	checkNumeric(name, left, line, column);
+	checkNumeric(name, right, line, column);
+	checkLengths(name, left, right, line, column);
+	if (left.type() == ElementType::FLOAT || right.type() == ElementType::FLOAT) {
+		std::vector<double> leftScratch, rightScratch;
+		DArray result(ElementType::FLOAT);
+		result.resize(left.size());
+		arithmeticFloat(Op, floats(left, leftScratch).data(), floats(right, rightScratch).data(), result.mutableElements<double>().data(), left.size());
+		return Value::fromArray(heap.newArray(std::move(result)));
+	}
+	std::vector<int64_t> leftScratch, rightScratch;
+	std::span<const int64_t> divisors = ints(right, rightScratch);
+	if (Op == TokenType::DIVIDE && std::ranges::find(divisors, 0) != divisors.end())
+		raiseError(std::format("RUNTIME ERROR: Division by zero in {}:{}\n", line, column));
+	DArray result(ElementType::INT);
+	result.resize(left.size());
+	arithmeticInt(Op, ints(left, leftScratch).data(), divisors.data(), result.mutableElements<int64_t>().data(), left.size());
+	return Value::fromArray(heap.newArray(std::move(result)));
+}
+
+// Element-wise comparison, gives an array of bools
+template <TokenType Op> static Value comparison(const Value* args, Heap& heap, size_t line, size_t column) {
+	const char* name = (Op == TokenType::LESS) ? "lt" : (Op == TokenType::LESS_EQUAL) ? "le" : (Op == TokenType::GREATER) ? "gt"
+		: (Op == TokenType::GREATER_EQUAL) ? "ge" : (Op == TokenType::EQUAL_EQUAL) ? "eq" : "ne";
+	const DArray &left = *args[0].a, &right = *args[1].a;
+	checkNumeric(name, left, line, column);
+	checkNumeric(name, right, line, column);
+	checkLengths(name, left, right, line, column);
+	DArray result(ElementType::BOOL);
+	result.resize(left.size());
+	uint8_t* out = result.mutableElements<uint8_t>().data();
+	if (left.type() == ElementType::FLOAT || right.type() == ElementType::FLOAT) {
+		std::vector<double> leftScratch, rightScratch;
+		compareFloat(Op, floats(left, leftScratch).data(), floats(right, rightScratch).data(), out, left.size());
+	}
+	else {
+		std::vector<int64_t> leftScratch, rightScratch;
+		compareInt(Op, ints(left, leftScratch).data(), ints(right, rightScratch).data(), out, left.size());
+	}
+	return Value::fromArray(heap.newArray(std::move(result)));
+}
+
+constexpr BuiltinParam ARRAY_PARAM = { "array", ValueType::ARRAY };
+constexpr BuiltinParam LEFT_PARAM = { "left", ValueType::ARRAY };
+constexpr BuiltinParam RIGHT_PARAM = { "right", ValueType::ARRAY };
+
+static const Builtin BUILTINS[] = {
+	{ "len", 1, { ARRAY_PARAM }, ValueType::INT, len },
+	{ "get", 2, { ARRAY_PARAM, { "index", ValueType::INT } }, ValueType::NONE, get },
+	{ "set", 3, { ARRAY_PARAM, { "index", ValueType::INT }, { "value", ValueType::NONE } }, ValueType::NONE, set },
+	{ "push", 2, { ARRAY_PARAM, { "value", ValueType::NONE } }, ValueType::NONE, push },
+	{ "slice", 3, { ARRAY_PARAM, { "from", ValueType::INT }, { "to", ValueType::INT } }, ValueType::ARRAY, slice },
+	{ "fill", 2, { { "count", ValueType::INT }, { "value", ValueType::NONE } }, ValueType::ARRAY, fill },
+	{ "range", 1, { { "count", ValueType::INT } }, ValueType::ARRAY, range },
+	{ "sum", 1, { ARRAY_PARAM }, ValueType::NONE, sum },
+	{ "dot", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::NONE, dot },
+	{ "min", 1, { ARRAY_PARAM }, ValueType::NONE, extreme<true> },
+	{ "max", 1, { ARRAY_PARAM }, ValueType::NONE, extreme<false> },
+	{ "add", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, elementWise<TokenType::PLUS> },
+	{ "sub", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, elementWise<TokenType::MINUS> },
+	{ "mul", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, elementWise<TokenType::MULTIPLY> },
+	{ "div", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, elementWise<TokenType::DIVIDE> },
+	{ "lt", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, comparison<TokenType::LESS> },
+	{ "le", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, comparison<TokenType::LESS_EQUAL> },
+	{ "gt", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, comparison<TokenType::GREATER> },
+	{ "ge", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, comparison<TokenType::GREATER_EQUAL> },
+	{ "eq", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, comparison<TokenType::EQUAL_EQUAL> },
+	{ "ne", 2, { LEFT_PARAM, RIGHT_PARAM }, ValueType::ARRAY, comparison<TokenType::NOT_EQUAL> },
+};
+
+int findBuiltin(std::string_view name) {
+	for (size_t i = 0; i < std::size(BUILTINS); ++i)
+		if (name == BUILTINS[i].name) return static_cast<int>(i);
+	return -1;
+}
+
+const Builtin& builtin(int index) {
+	return BUILTINS[index];
+}
+
+// Int parameters take any number like int variables, the others their exact type
+Value callBuiltin(int index, const Value* args, Heap& heap, size_t line, size_t column) {
+	const Builtin& function = BUILTINS[index];
+	for (int i = 0; i < function.arity; ++i) {
+		const BuiltinParam& param = function.params[i];
+		bool valid = param.type == ValueType::NONE || args[i].type == param.type || (param.type == ValueType::INT && args[i].isNumber());
+		if (!valid) raiseError(std::format("RUNTIME ERROR: Argument {} of {} must be {}, not {} in {}:{}\n", param.name, function.name, valueTypeName(param.type), valueTypeName(args[i].type), line, column));
+	}
+	return function.call(args, heap, line, column);
+}
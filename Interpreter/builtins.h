@@ -0,0 +1,36 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include <string_view>
+#include "value.h"
+
+constexpr int MAX_BUILTIN_ARITY = 3;
+
+// Parameter of a builtin, type NONE takes any value
+struct BuiltinParam {
+	const char* name;
+	ValueType type;
+};
+
+// Function every script can call unless it declares one of the same name. print isn't one, it takes
+// any number of arguments and has an opcode of its own.
+//
+// Arrays are passed by reference: set and push change the array for everyone holding it. An array
+// literal gives a new array each time it runs, and slice an independent one that shares the buffer
+// until either of them is written (see darray.h).
+// The numeric ones (sum dot min max, add sub mul div, lt gt le ge eq ne) take arrays of int or float,
+// bool and char arrays count as int. Two operands need the same length, an int and a float operand
+// give float results. They run the SIMD kernels of simd.h.
+struct Builtin {
+	const char* name;
+	int arity;
+	BuiltinParam params[MAX_BUILTIN_ARITY];
+	ValueType result; // NONE when it depends on the arguments
+	Value (*call)(const Value* args, Heap& heap, size_t line, size_t column);
+};
+
+int findBuiltin(std::string_view name); // Index of the builtin, -1 if there is none
+const Builtin& builtin(int index);
+// Checks the argument types the type checker couldn't know, then calls the builtin
+Value callBuiltin(int index, const Value* args, Heap& heap, size_t line, size_t column);
+#endif // !BUILTINS_H
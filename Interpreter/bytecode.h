@@ -0,0 +1,111 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "builtins.h"
+#include "value.h"
+
+// List of opcodes. The VM builds its computed-goto table from the same list, so order is fixed here only.
+#define DLANG_OPCODES(X) \
+	X(PUSH_CONST)    /* push constants[operand] */ \
+	X(PUSH_NONE)     /* push empty value */ \
+	X(PUSH_FALSE)    /* push false */ \
+	X(NEW_ARRAY)     /* push a new array sharing the elements of array constants[operand] */ \
+	X(POP)           /* drop top of stack */ \
+	X(LOAD_LOCAL)    /* push frame slot operand */ \
+	X(STORE_LOCAL)   /* pop into frame slot operand */ \
+	X(LOAD_GLOBAL)   /* push global slot operand */ \
+	X(STORE_GLOBAL)  /* pop into global slot operand */ \
+	X(INC_LOCAL)     /* frame slot operand += 1 */ \
+	X(DEC_LOCAL)     /* frame slot operand -= 1 */ \
+	X(INC_GLOBAL)    /* global slot operand += 1 */ \
+	X(DEC_GLOBAL)    /* global slot operand -= 1 */ \
+	X(ADD) X(SUB) X(MUL) X(DIV) \
+	X(LESS) X(GREATER) X(LESS_EQUAL) X(GREATER_EQUAL) X(EQUAL_EQUAL) X(NOT_EQUAL) \
+	/* Same ten for operands the type checker proved int (or bool), then float. No type tests */ \
+	X(ADD_INT) X(SUB_INT) X(MUL_INT) X(DIV_INT) \
+	X(LESS_INT) X(GREATER_INT) X(LESS_EQUAL_INT) X(GREATER_EQUAL_INT) X(EQUAL_EQUAL_INT) X(NOT_EQUAL_INT) \
+	X(ADD_FLOAT) X(SUB_FLOAT) X(MUL_FLOAT) X(DIV_FLOAT) \
+	X(LESS_FLOAT) X(GREATER_FLOAT) X(LESS_EQUAL_FLOAT) X(GREATER_EQUAL_FLOAT) X(EQUAL_EQUAL_FLOAT) X(NOT_EQUAL_FLOAT) \
+	X(CONCAT)        /* string + string */ \
+	X(NEGATE_INT) X(NEGATE_FLOAT) \
+	X(NEGATE) X(PLUS) X(NOT) \
+	X(TO_BOOL)       /* replace top with its truthiness */ \
+	X(TO_INT)        /* coerce top for an int variable */ \
+	X(TO_FLOAT)      /* coerce top for a float variable */ \
+	X(JUMP)          /* ip = operand */ \
+	X(JUMP_IF_FALSE) /* pop, ip = operand if falsy */ \
+	X(CALL)          /* call functions[operand], arguments are on the stack */ \
+	X(CALL_BUILTIN)  /* pop the arguments of builtin operand, push its result */ \
+	X(RETURN)        /* pop result, leave frame, push result */ \
+	X(PRINT)         /* pop operand values and print them */ \
+	X(HALT)
+
+enum OpCode : uint8_t {
+#define DLANG_OPCODE_ENUM(name) OP_##name,
+	DLANG_OPCODES(DLANG_OPCODE_ENUM)
+#undef DLANG_OPCODE_ENUM
+	OP_COUNT
+};
+static_assert(OP_ADD_FLOAT - OP_ADD_INT == OP_ADD_INT - OP_ADD && OP_NOT_EQUAL_FLOAT - OP_ADD_FLOAT == OP_NOT_EQUAL - OP_ADD);
+
+// Pop two operands, push one
+inline bool isBinaryOp(OpCode op) { return op >= OP_ADD && op <= OP_CONCAT; }
+
+// Typed form of a generic ADD .. NOT_EQUAL
+inline OpCode typedOp(OpCode generic, ValueType operands) {
+	return static_cast<OpCode>(generic + ((operands == ValueType::FLOAT) ? OP_ADD_FLOAT : OP_ADD_INT) - OP_ADD);
+}
+
+inline const char* opCodeName(OpCode op) {
+	static const char* names[] = {
+#define DLANG_OPCODE_NAME(name) #name,
+		DLANG_OPCODES(DLANG_OPCODE_NAME)
+#undef DLANG_OPCODE_NAME
+	};
+	return (op < OP_COUNT) ? names[op] : "UNKNOWN";
+}
+
+struct Instruction {
+	OpCode op;
+	int32_t operand;
+};
+
+// Compiled function body. Slots [0, arity) hold the arguments.
+struct Function {
+	std::string name;
+	int arity = 0;
+	int num_locals = 0;
+	int max_stack = 0; // deepest operand stack reached by the body
+	ValueType return_type = ValueType::NONE;
+	std::vector<Instruction> code;
+	std::vector<uint32_t> lines; // source line of every instruction
+	std::vector<uint32_t> columns; // source column of every instruction
+};
+
+// Output of the compiler. functions[0] is the top level code of the script.
+struct Program {
+	std::vector<Function> functions;
+	std::vector<Value> constants;
+	std::vector<std::string> global_names;
+	Heap heap; // owns string and array constants
+};
+
+// Human readable listing of the bytecode
+inline std::string disassemble(const Program& program) {
+	std::string temp;
+	for (const Function& function : program.functions) {
+		temp += function.name + " (arity " + std::to_string(function.arity) + ", locals " + std::to_string(function.num_locals) + ")\n";
+		for (size_t i = 0; i < function.code.size(); ++i) {
+			const Instruction& instr = function.code[i];
+			temp += "  " + std::to_string(i) + "\t" + opCodeName(instr.op) + "\t" + std::to_string(instr.operand);
+			if (instr.op == OP_PUSH_CONST || instr.op == OP_NEW_ARRAY) temp += "\t; " + valueToString(program.constants[instr.operand]);
+			else if (instr.op == OP_CALL_BUILTIN) temp += std::string("\t; ") + builtin(instr.operand).name;
+			temp += "\n";
+		}
+	}
+	return temp;
+}
+#endif // !BYTECODE_H
@@ -0,0 +1,614 @@
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include "c_emitter.h"
+#include "../Error/error.h"
+
+constexpr size_t TOP_LEVEL_CHUNK = 64; // Statements per function of top level code, see emit
+
+// Values and operators of value.h and operations.h, in C. Runtime errors print like the shell does and
+// jump back to dlang_main
+static const char* RUNTIME = R"C(#include <inttypes.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { DL_NONE, DL_INT, DL_FLOAT, DL_BOOL, DL_STRING, DL_ARRAY };
+enum { DL_LESS, DL_GREATER, DL_LESS_EQUAL, DL_GREATER_EQUAL, DL_EQUAL_EQUAL, DL_NOT_EQUAL };
+#define DL_MAX_CALL_DEPTH 1000
+
+typedef struct DString { size_t size; const char* data; } DString;
+typedef struct DValue DValue;
+typedef struct DArray { size_t size; const DValue* items; } DArray;
+/* A bool is 0 or 1 in i, so int operations can read it */
+struct DValue {
+	uint8_t type;
+	union { int64_t i; double f; const DString* s; const DArray* a; };
+};
+
+static jmp_buf dl_abort;
+static int dl_depth;
+static const DString dl_empty_string = { 0, "" };
+static const DArray dl_empty_array = { 0, NULL };
+
+static inline DValue dl_none(void) { DValue v; v.type = DL_NONE; v.i = 0; return v; }
+static inline DValue dl_int(int64_t i) { DValue v; v.type = DL_INT; v.i = i; return v; }
+static inline DValue dl_float(double f) { DValue v; v.type = DL_FLOAT; v.f = f; return v; }
+static inline DValue dl_bool(int b) { DValue v; v.type = DL_BOOL; v.i = b != 0; return v; }
+static inline DValue dl_string(const DString* s) { DValue v; v.type = DL_STRING; v.s = s; return v; }
+static inline DValue dl_array(const DArray* a) { DValue v; v.type = DL_ARRAY; v.a = a; return v; }
+static inline DValue dl_float_bits(uint64_t bits) { double f; memcpy(&f, &bits, sizeof f); return dl_float(f); }
+
+static inline int dl_is_number(DValue v) { return v.type == DL_INT || v.type == DL_FLOAT || v.type == DL_BOOL; }
+static inline double dl_as_float(DValue v) { return (v.type == DL_FLOAT) ? v.f : (double)v.i; }
+static inline int64_t dl_as_int(DValue v) { return (v.type == DL_FLOAT) ? (int64_t)v.f : v.i; }
+
+/* Two's complement wrap, as wrapAdd, wrapSub and wrapMul of operations.h */
+static inline int64_t dl_wrap(int op, int64_t a, int64_t b) {
+	switch (op) {
+		case '+': return (int64_t)((uint64_t)a + (uint64_t)b);
+		case '-': return (int64_t)((uint64_t)a - (uint64_t)b);
+		default: return (int64_t)((uint64_t)a * (uint64_t)b);
+	}
+}
+
+/* The smallest int / -1 wraps to itself instead of trapping, as wrapDiv. b isn't 0 */
+static inline int64_t dl_div(int64_t a, int64_t b) { return (b == -1) ? dl_wrap('-', 0, a) : a / b; }
+
+static const char* dl_type_name(int type) {
+	switch (type) {
+		case DL_INT: return "int";
+		case DL_FLOAT: return "float";
+		case DL_BOOL: return "bool";
+		case DL_STRING: return "string";
+		case DL_ARRAY: return "array";
+		default: return "void";
+	}
+}
+
+static _Noreturn void dl_error(unsigned line, unsigned column, const char* message, const char* a, const char* b) {
+	fputs("RUNTIME ERROR: ", stdout);
+	printf(message, a, b);
+	printf(" in %u:%u\n", line, column);
+	longjmp(dl_abort, 1);
+}
+
+static inline int dl_truthy(DValue v) {
+	switch (v.type) {
+		case DL_INT: case DL_BOOL: return v.i != 0;
+		case DL_FLOAT: return v.f != 0.0;
+		case DL_STRING: return v.s->size != 0;
+		case DL_ARRAY: return v.a->size != 0;
+		default: return 0;
+	}
+}
+
+static inline DValue dl_to_int(DValue v) { return (v.type == DL_FLOAT) ? dl_int((int64_t)v.f) : v; }
+static inline DValue dl_to_float(DValue v) { return (v.type == DL_INT || v.type == DL_BOOL) ? dl_float((double)v.i) : v; }
+
+static inline DValue dl_global(DValue v, const char* name, unsigned line, unsigned column) {
+	if (v.type == DL_NONE) dl_error(line, column, "Variable %s used before declaration", name, "");
+	return v;
+}
+
+static inline void dl_enter(unsigned line, unsigned column) {
+	if (dl_depth >= DL_MAX_CALL_DEPTH) dl_error(line, column, "Stack overflow", "", "");
+	++dl_depth;
+}
+
+static DValue dl_concat(DValue l, DValue r) {
+	size_t size = l.s->size + r.s->size;
+	DString* s = malloc(sizeof(DString) + size + 1);
+	if (!s) abort();
+	char* data = (char*)(s + 1);
+	memcpy(data, l.s->data, l.s->size);
+	memcpy(data + l.s->size, r.s->data, r.s->size);
+	data[size] = 0;
+	s->size = size;
+	s->data = data;
+	return dl_string(s);
+}
+
+static inline DValue dl_div_int(DValue l, DValue r, unsigned line, unsigned column) {
+	if (r.i == 0) dl_error(line, column, "Division by zero", "", "");
+	return dl_int(dl_div(l.i, r.i));
+}
+
+/* + - * / on any values */
+static DValue dl_arith(int op, DValue l, DValue r, unsigned line, unsigned column) {
+	if (op == '+' && l.type == DL_STRING && r.type == DL_STRING) return dl_concat(l, r);
+	if (!dl_is_number(l) || !dl_is_number(r))
+		dl_error(line, column, "Unsupported operand types %s and %s", dl_type_name(l.type), dl_type_name(r.type));
+	if (l.type == DL_FLOAT || r.type == DL_FLOAT) {
+		double a = dl_as_float(l), b = dl_as_float(r);
+		switch (op) {
+			case '+': return dl_float(a + b);
+			case '-': return dl_float(a - b);
+			case '*': return dl_float(a * b);
+			default: return dl_float(a / b);
+		}
+	}
+	if (op != '/') return dl_int(dl_wrap(op, dl_as_int(l), dl_as_int(r)));
+	if (dl_as_int(r) == 0) dl_error(line, column, "Division by zero", "", "");
+	return dl_int(dl_div(dl_as_int(l), dl_as_int(r)));
+}
+
+static inline DValue dl_binary(int op, DValue l, DValue r, unsigned line, unsigned column) {
+	if (op != '/' && l.type == DL_INT && r.type == DL_INT) return dl_int(dl_wrap(op, l.i, r.i));
+	if (l.type == DL_FLOAT && r.type == DL_FLOAT) {
+		switch (op) {
+			case '+': return dl_float(l.f + r.f);
+			case '-': return dl_float(l.f - r.f);
+			case '*': return dl_float(l.f * r.f);
+			default: return dl_float(l.f / r.f);
+		}
+	}
+	return dl_arith(op, l, r, line, column);
+}
+
+static int dl_equal(DValue l, DValue r) {
+	if (dl_is_number(l) && dl_is_number(r)) {
+		if (l.type == DL_FLOAT || r.type == DL_FLOAT) return dl_as_float(l) == dl_as_float(r);
+		return l.i == r.i;
+	}
+	if (l.type != r.type) return 0;
+	switch (l.type) {
+		case DL_STRING: return l.s->size == r.s->size && !memcmp(l.s->data, r.s->data, l.s->size);
+		case DL_ARRAY:
+			if (l.a->size != r.a->size) return 0;
+			for (size_t i = 0; i < l.a->size; ++i)
+				if (!dl_equal(l.a->items[i], r.a->items[i])) return 0;
+			return 1;
+		default: return 1;
+	}
+}
+
+/* < > <= >= == != on any values */
+static DValue dl_compare(int op, DValue l, DValue r, unsigned line, unsigned column) {
+	if (op == DL_EQUAL_EQUAL) return dl_bool(dl_equal(l, r));
+	if (op == DL_NOT_EQUAL) return dl_bool(!dl_equal(l, r));
+	int order = 0;
+	if (dl_is_number(l) && dl_is_number(r)) {
+		if (l.type == DL_FLOAT || r.type == DL_FLOAT) {
+			double a = dl_as_float(l), b = dl_as_float(r);
+			order = (a < b) ? -1 : (a > b) ? 1 : 0;
+		}
+		else order = (l.i < r.i) ? -1 : (l.i > r.i) ? 1 : 0;
+	}
+	else if (l.type == DL_STRING && r.type == DL_STRING) {
+		size_t size = (l.s->size < r.s->size) ? l.s->size : r.s->size;
+		order = memcmp(l.s->data, r.s->data, size);
+		if (!order) order = (l.s->size < r.s->size) ? -1 : (l.s->size > r.s->size) ? 1 : 0;
+	}
+	else dl_error(line, column, "Can't compare %s and %s", dl_type_name(l.type), dl_type_name(r.type));
+	switch (op) {
+		case DL_LESS: return dl_bool(order < 0);
+		case DL_GREATER: return dl_bool(order > 0);
+		case DL_LESS_EQUAL: return dl_bool(order <= 0);
+		default: return dl_bool(order >= 0);
+	}
+}
+
+static inline DValue dl_relation(int op, DValue l, DValue r, unsigned line, unsigned column) {
+	if ((l.type == DL_INT && r.type == DL_INT) || (l.type == DL_FLOAT && r.type == DL_FLOAT)) {
+		int floats = l.type == DL_FLOAT;
+		switch (op) {
+			case DL_LESS: return dl_bool(floats ? l.f < r.f : l.i < r.i);
+			case DL_GREATER: return dl_bool(floats ? l.f > r.f : l.i > r.i);
+			case DL_LESS_EQUAL: return dl_bool(floats ? l.f <= r.f : l.i <= r.i);
+			case DL_GREATER_EQUAL: return dl_bool(floats ? l.f >= r.f : l.i >= r.i);
+			case DL_EQUAL_EQUAL: return dl_bool(floats ? l.f == r.f : l.i == r.i);
+			default: return dl_bool(floats ? l.f != r.f : l.i != r.i);
+		}
+	}
+	return dl_compare(op, l, r, line, column);
+}
+
+/* Unary - and + */
+static DValue dl_negate(int minus, DValue v, unsigned line, unsigned column) {
+	if (!dl_is_number(v)) dl_error(line, column, "Unsupported operand type %s", dl_type_name(v.type), "");
+	if (v.type == DL_FLOAT) return dl_float(minus ? -v.f : v.f);
+	return dl_int(minus ? dl_wrap('-', 0, v.i) : v.i);
+}
+
+/* ++ -- */
+static inline DValue dl_step(DValue v, int delta, unsigned line, unsigned column) {
+	if (v.type == DL_INT) return dl_int(dl_wrap('+', v.i, delta));
+	if (v.type == DL_FLOAT) return dl_float(v.f + delta);
+	dl_error(line, column, "Can't increment or decrement %s", dl_type_name(v.type), "");
+}
+
+static void dl_write(DValue v) {
+	switch (v.type) {
+		case DL_INT: printf("%" PRId64, v.i); break;
+		case DL_FLOAT: printf("%g", v.f); break;
+		case DL_BOOL: fputs(v.i ? "true" : "false", stdout); break;
+		case DL_STRING: fwrite(v.s->data, 1, v.s->size, stdout); break;
+		case DL_ARRAY:
+			putchar('[');
+			for (size_t i = 0; i < v.a->size; ++i) {
+				if (i) fputs(", ", stdout);
+				dl_write(v.a->items[i]);
+			}
+			putchar(']');
+			break;
+		default: fputs("none", stdout);
+	}
+}
+
+static DValue dl_print(int count, const DValue* args) {
+	for (int i = 0; i < count; ++i) {
+		if (i) putchar(' ');
+		dl_write(args[i]);
+	}
+	putchar('\n');
+	return dl_none();
+}
+)C";
+
+// Main function
+std::string CEmitter::emit(const std::vector<AST*>& ast, const Program& program) {
+	m_program = &program;
+	m_functions.clear();
+	m_constants.clear();
+	m_constant_count = 0;
+
+	std::vector<FuncNode*> functions;
+	for (AST* node : ast)
+		if (FuncNode* func = nodeCast<FuncNode>(node)) {
+			m_functions[func->func_name->symbol] = functions.size() + 1;
+			functions.push_back(func);
+		}
+
+	std::string declarations, bodies;
+	for (size_t i = 0; i < program.global_names.size(); ++i)
+		declarations += std::format("static DValue g{}; /* {} */\n", i, program.global_names[i]);
+	for (size_t i = 1; i < program.functions.size(); ++i) {
+		std::string params;
+		for (int p = 0; p < program.functions[i].arity; ++p) params += std::format("{}DValue s{}", p ? ", " : "", p);
+		declarations += std::format("static DValue f{}({}); /* {} */\n", i, params.empty() ? "void" : params, program.functions[i].name);
+	}
+
+	for (FuncNode* func : functions) {
+		function(func);
+		bodies += m_code + "\n";
+	}
+
+	// Top level code, apart from dlang_main: a function calling setjmp keeps its variables out of registers.
+	// It's cut into functions of TOP_LEVEL_CHUNK statements, optimizers slow down a lot on huge functions,
+	// so its slots live at file scope
+	m_function = 0;
+	m_temps = 0;
+	m_indent = "\t";
+	std::string reset, calls;
+	for (size_t i = 0; i < program.global_names.size(); ++i) reset += std::format("\tg{} = dl_none();\n", i);
+	for (int slot = 0; slot < program.functions[0].num_locals; ++slot) {
+		declarations += std::format("static DValue l{};\n", slot);
+		reset += std::format("\tl{} = dl_none();\n", slot);
+	}
+	size_t statements = 0, chunks = 0;
+	for (AST* node : ast) {
+		if (!node || nodeCast<FuncNode>(node)) continue;
+		if (statements++ % TOP_LEVEL_CHUNK == 0) {
+			if (chunks) bodies += m_code + "}\n\n";
+			m_code = std::format("static void dl_top{}(void) {{\n", chunks);
+			calls += std::format("\tdl_top{}();\n", chunks++);
+		}
+		statement(node);
+	}
+	if (chunks) bodies += m_code + "}\n";
+
+	return std::string(RUNTIME) + "\n" + m_constants + "\n" + declarations + "\n" + bodies + "\n"
+		+ "#if defined(DLANG_SHARED) && defined(_WIN32)\n#define DL_EXPORT __declspec(dllexport)\n#else\n#define DL_EXPORT\n#endif\n\n"
+		+ "/* Runs the script, 0 when it ends and 1 after a runtime error. Output goes to stdout */\n"
+		+ "DL_EXPORT int dlang_main(void) {\n"
+		+ "\tdl_depth = 0;\n" + reset
+		+ "\tif (setjmp(dl_abort)) {\n\t\tfflush(stdout);\n\t\treturn 1;\n\t}\n"
+		+ calls + "\tfflush(stdout);\n\treturn 0;\n}\n\n"
+		+ "#ifndef DLANG_SHARED\nint main(void) { return dlang_main(); }\n#endif\n";
+}
+
+std::string CEmitter::assign(const std::string& expr) {
+	std::string name = std::format("t{}", m_temps++);
+	line("DValue " + name + " = " + expr + ";");
+	return name;
+}
+
+// Printable characters stay, anything else is an octal escape
+std::string CEmitter::stringConstant(std::string_view text) {
+	std::string literal;
+	for (unsigned char c : text) {
+		if (c >= ' ' && c <= '~' && c != '"' && c != '\\' && c != '?') literal += static_cast<char>(c);
+		else literal += std::format("\\{:03o}", c);
+	}
+	std::string name = std::format("c{}", m_constant_count++);
+	m_constants += std::format("static const DString {} = {{ {}, \"{}\" }};\n", name, text.size(), literal);
+	return name;
+}
+
+// Hex literals keep every bit of the value
+std::string CEmitter::floatLiteral(double value) {
+	if (!std::isfinite(value)) return std::format("dl_float_bits(UINT64_C({:#x}))", std::bit_cast<uint64_t>(value));
+	char buffer[64];
+	std::snprintf(buffer, sizeof(buffer), "%a", value);
+	return std::format("dl_float({})", buffer);
+}
+
+std::string CEmitter::position(Token* token) { return std::format("{}, {}", token->line, token->column); }
+
+// Slots of the top level code are at file scope
+std::string CEmitter::variable(IdNode* identifier) {
+	return std::format("{}{}", identifier->is_global ? 'g' : m_function ? 's' : 'l', identifier->slot);
+}
+
+// Globals may be read before their declaration ran, locals can't
+std::string CEmitter::load(IdNode* identifier, Token* position) {
+	if (!identifier->is_global) return assign(variable(identifier));
+	return assign(std::format("dl_global({}, \"{}\", {})", variable(identifier), identifier->identifier->value, this->position(position)));
+}
+
+std::string CEmitter::coerce(const std::string& value, ValueType type) {
+	if (type == ValueType::INT) return "dl_to_int(" + value + ")";
+	if (type == ValueType::FLOAT) return "dl_to_float(" + value + ")";
+	return value;
+}
+
+std::string CEmitter::defaultValue(ValueType type) {
+	switch (type) {
+		case ValueType::INT: return "dl_int(0)";
+		case ValueType::FLOAT: return "dl_float(0.0)";
+		case ValueType::BOOL: return "dl_bool(0)";
+		case ValueType::STRING: return "dl_string(&dl_empty_string)";
+		case ValueType::ARRAY: return "dl_array(&dl_empty_array)";
+		default: return "dl_none()";
+	}
+}
+
+std::string CEmitter::returnType() { return defaultValue(m_program->functions[m_function].return_type); }
+
+void CEmitter::statement(AST* ast) {
+	if (ast) visit(ast);
+}
+
+void CEmitter::block(BlockOfCodeNode* node) {
+	m_indent += '\t';
+	for (AST* ast : node->list) statement(ast);
+	m_indent.pop_back();
+}
+
+void CEmitter::function(FuncNode* node) {
+	m_function = m_functions.at(node->func_name->symbol);
+	const Function& func = m_program->functions[m_function];
+	m_code.clear();
+	m_temps = 0;
+	m_indent = "\t";
+
+	std::string params;
+	for (int p = 0; p < func.arity; ++p) params += std::format("{}DValue s{}", p ? ", " : "", p);
+	m_code += std::format("/* {} */\nstatic DValue f{}({}) {{\n", func.name, m_function, params.empty() ? "void" : params);
+	for (int slot = func.arity; slot < node->num_locals; ++slot) line(std::format("DValue s{} = dl_none();", slot));
+	// Arguments are converted to the declared parameter types on entry
+	for (EmptyVarDeclNode* param : node->params->params) {
+		std::string slot = variable(param->identifier);
+		ValueType type = valueTypeFromName(param->var_type->value);
+		if (type == ValueType::INT || type == ValueType::FLOAT) line(slot + " = " + coerce(slot, type) + ";");
+	}
+	for (AST* ast : node->code_to_execute->list) statement(ast);
+	line("--dl_depth;");
+	line("return " + returnType() + ";");
+	m_code += "}\n";
+}
+
+// The digits of the smallest int don't fit a C constant, folding can make it
+std::string CEmitter::visit(IntNode* node) {
+	if (node->value == INT64_MIN) return "dl_int(INT64_MIN)";
+	return std::format("dl_int(INT64_C({}))", node->value);
+}
+
+std::string CEmitter::visit(FloatNode* node) { return floatLiteral(node->value); }
+
+std::string CEmitter::visit(StrNode* node) {
+	// Token value keeps the quotes
+	std::string_view str = node->value;
+	if (!str.empty() && str.front() == '"') str.remove_prefix(1);
+	if (!str.empty() && str.back() == '"') str.remove_suffix(1);
+	return "dl_string(&" + stringConstant(str) + ")";
+}
+
+// Elements are converted like the compiler does, it already rejected anything else
+std::string CEmitter::visit(ArrayNode* node) {
+	std::span<Token*> tokens = node->elements;
+	std::string name = std::format("c{}", m_constant_count++);
+	if (tokens.empty()) {
+		m_constants += std::format("static const DArray {} = {{ 0, NULL }};\n", name);
+		return "dl_array(&" + name + ")";
+	}
+	std::string items;
+	for (Token* token : tokens) {
+		std::string item;
+		switch (token->type) {
+			case TokenType::INT: {
+				int64_t value = 0;
+				parseLiteral(token->value, value);
+				item = std::format("{{ .type = DL_INT, .i = INT64_C({}) }}", value);
+				break;
+			}
+			case TokenType::FLOAT: {
+				double value = 0;
+				parseLiteral(token->value, value);
+				std::string literal = floatLiteral(value);
+				item = std::format("{{ .type = DL_FLOAT, .f = {} }}", literal.substr(9, literal.size() - 10)); // Inside dl_float( )
+				break;
+			}
+			default: item = std::format("{{ .type = DL_STRING, .s = &{} }}", stringConstant(token->value.substr(1, token->value.size() - 2))); break;
+		}
+		items += (items.empty() ? "" : ", ") + item;
+	}
+	m_constants += std::format("static const DValue {}_items[] = {{ {} }};\n", name, items);
+	m_constants += std::format("static const DArray {} = {{ {}, {}_items }};\n", name, tokens.size(), name);
+	return "dl_array(&" + name + ")";
+}
+
+std::string CEmitter::visit(UnOpNode* node) {
+	Token* op = node->operation;
+	if (op->type == TokenType::INCREMENT || op->type == TokenType::DECREMENT) { // id++ as expression gives the old value
+		IdNode* id = nodeCast<IdNode>(node->right);
+		std::string old = load(id, op);
+		line(std::format("{0} = dl_step({0}, {1}, {2});", variable(id), (op->type == TokenType::INCREMENT) ? 1 : -1, position(op)));
+		return old;
+	}
+	std::string value = visit(node->right);
+	ValueType operand = node->operand_type;
+	switch (op->type) {
+		case TokenType::MINUS:
+			if (operand == ValueType::INT) return assign("dl_int(dl_wrap('-', 0, " + value + ".i))");
+			if (operand == ValueType::FLOAT) return assign("dl_float(-" + value + ".f)");
+			return assign(std::format("dl_negate(1, {}, {})", value, position(op)));
+		case TokenType::PLUS:
+			if (operand == ValueType::FLOAT) return value;
+			return assign(std::format("dl_negate(0, {}, {})", value, position(op))); // +int still turns a bool into an int
+		default: return assign("dl_bool(!dl_truthy(" + value + "))");
+	}
+}
+
+std::string CEmitter::visit(BinOpNode* node) {
+	TokenType op = node->operation->type;
+	// && and || are short circuit
+	if (op == TokenType::LOGIC_AND || op == TokenType::LOGIC_OR) {
+		std::string result = std::format("t{}", m_temps++);
+		line("DValue " + result + ";");
+		std::string left = visit(node->left);
+		line(std::format("if ({}dl_truthy({})) {{", (op == TokenType::LOGIC_OR) ? "!" : "", left));
+		m_indent += '\t';
+		std::string right = visit(node->right);
+		line(result + " = dl_bool(dl_truthy(" + right + "));");
+		m_indent.pop_back();
+		line(std::format("}} else {} = dl_bool({});", result, (op == TokenType::LOGIC_OR) ? 1 : 0));
+		return result;
+	}
+	// Same choice of operation as the bytecode compiler
+	ValueType left_type = node->left_type, right_type = node->right_type;
+	bool numbers = (left_type == ValueType::INT || left_type == ValueType::FLOAT) && (right_type == ValueType::INT || right_type == ValueType::FLOAT);
+	ValueType operands = (numbers && left_type != right_type) ? ValueType::FLOAT : left_type;
+	std::string left = visit(node->left);
+	if (numbers && left_type != operands) left = "dl_to_float(" + left + ")";
+	std::string right = visit(node->right);
+	if (numbers && right_type != operands) right = "dl_to_float(" + right + ")";
+	std::string at = position(node->operation);
+
+	char arith = 0;
+	const char* relation = nullptr;
+	const char* relation_op = nullptr;
+	switch (op) {
+		case TokenType::PLUS: arith = '+'; break;
+		case TokenType::MINUS: arith = '-'; break;
+		case TokenType::MULTIPLY: arith = '*'; break;
+		case TokenType::DIVIDE: arith = '/'; break;
+		case TokenType::LESS: relation = "DL_LESS"; relation_op = "<"; break;
+		case TokenType::GREATER: relation = "DL_GREATER"; relation_op = ">"; break;
+		case TokenType::LESS_EQUAL: relation = "DL_LESS_EQUAL"; relation_op = "<="; break;
+		case TokenType::GREATER_EQUAL: relation = "DL_GREATER_EQUAL"; relation_op = ">="; break;
+		case TokenType::EQUAL_EQUAL: relation = "DL_EQUAL_EQUAL"; relation_op = "=="; break;
+		case TokenType::NOT_EQUAL: relation = "DL_NOT_EQUAL"; relation_op = "!="; break;
+		default: raiseError(std::format("SEMANTIC ERROR: Unknown operation {} in {}:{}\n", node->operation->value, node->operation->line, node->operation->column)); return "";
+	}
+	if (numbers && operands == ValueType::INT) {
+		if (relation) return assign(std::format("dl_bool({}.i {} {}.i)", left, relation_op, right));
+		if (arith == '/') return assign(std::format("dl_div_int({}, {}, {})", left, right, at));
+		return assign(std::format("dl_int(dl_wrap('{}', {}.i, {}.i))", arith, left, right));
+	}
+	if (numbers) {
+		if (relation) return assign(std::format("dl_bool({}.f {} {}.f)", left, relation_op, right));
+		return assign(std::format("dl_float({}.f {} {}.f)", left, arith, right));
+	}
+	if (op == TokenType::PLUS && left_type == ValueType::STRING && right_type == ValueType::STRING) return assign(std::format("dl_concat({}, {})", left, right));
+	if (relation) return assign(std::format("dl_relation({}, {}, {}, {})", relation, left, right, at));
+	return assign(std::format("dl_binary('{}', {}, {}, {})", arith, left, right, at));
+}
+
+std::string CEmitter::visit(EmptyVarDeclNode* node) {
+	line(variable(node->identifier) + " = " + defaultValue(valueTypeFromName(node->var_type->value)) + ";");
+	return "";
+}
+
+std::string CEmitter::visit(FullVarDeclNode* node) {
+	EmptyVarDeclNode* decl = node->declaration;
+	std::string value = visit(node->expr);
+	line(variable(decl->identifier) + " = " + coerce(value, valueTypeFromName(decl->var_type->value)) + ";");
+	return "";
+}
+
+std::string CEmitter::visit(ReasignVarNode* node) {
+	Token* assign = node->assign;
+	IdNode* id = node->identifier;
+	ValueType type = valueTypeFromName(id->declaration->var_type->value);
+	std::string old = (assign->type != TokenType::EQUAL) ? load(id, assign) : "";
+	std::string value = visit(node->expr);
+	switch (assign->type) {
+		case TokenType::PLUS_EQUAL: value = this->assign(std::format("dl_binary('+', {}, {}, {})", old, value, position(assign))); break;
+		case TokenType::MINUS_EQUAL: value = this->assign(std::format("dl_binary('-', {}, {}, {})", old, value, position(assign))); break;
+		case TokenType::MULTIPLY_EQUAL: value = this->assign(std::format("dl_binary('*', {}, {}, {})", old, value, position(assign))); break;
+		case TokenType::DIVIDE_EQUAL: value = this->assign(std::format("dl_binary('/', {}, {}, {})", old, value, position(assign))); break;
+		default: break;
+	}
+	line(variable(id) + " = " + coerce(value, type) + ";");
+	return "";
+}
+
+std::string CEmitter::visit(BlockOfCodeNode* node) {
+	line("{");
+	block(node);
+	line("}");
+	return "";
+}
+
+std::string CEmitter::visit(IfStmtNode* node) {
+	std::string condition = visit(node->condition);
+	line("if (dl_truthy(" + condition + ")) {");
+	block(node->code_to_execute);
+	line("}");
+	return "";
+}
+
+// The condition's temporaries are evaluated again on every iteration
+std::string CEmitter::visit(WhileStmtNode* node) {
+	line("for (;;) {");
+	m_indent += '\t';
+	std::string condition = visit(node->condition);
+	line("if (!dl_truthy(" + condition + ")) break;");
+	m_indent.pop_back();
+	block(node->code_to_execute);
+	line("}");
+	return "";
+}
+
+std::string CEmitter::visit(IncDecNode* node) {
+	std::string var = variable(node->identifier);
+	line(std::format("{0} = dl_step({0}, {1}, {2});", var, (node->operation->type == TokenType::INCREMENT) ? 1 : -1, position(node->operation)));
+	return "";
+}
+
+std::string CEmitter::visit(FuncCallNode* node) {
+	Token* name = node->func_name->identifier;
+	auto func = m_functions.find(node->func_name->symbol);
+	// The array builtins have no C version yet, scripts using them run in the VM
+	if (func == m_functions.end() && name->value != "print")
+		raiseError(std::format("AOT ERROR: Builtin {} isn't supported by the C backend in {}:{}\n", name->value, name->line, name->column));
+	std::string args;
+	for (AST* arg : node->args) args += (args.empty() ? "" : ", ") + visit(arg);
+	// print is builtin unless the script declares its own
+	if (func == m_functions.end())
+		return assign(args.empty() ? "dl_print(0, NULL)" : std::format("dl_print({}, (const DValue[]){{ {} }})", node->args.size(), args));
+	line(std::format("dl_enter({});", position(name)));
+	return assign(std::format("f{}({})", func->second, args));
+}
+
+std::string CEmitter::visit(ReturnStmtNode* node) {
+	std::string value = node->expr ? visit(node->expr) : "dl_none()";
+	std::string result = assign(coerce(value, m_program->functions[m_function].return_type));
+	line("--dl_depth;");
+	line("return " + result + ";");
+	return "";
+}
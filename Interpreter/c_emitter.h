@@ -0,0 +1,74 @@
+#ifndef C_EMITTER_H
+#define C_EMITTER_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "bytecode.h"
+#include "../Parser/AST/ast.h"
+
+// Translates a checked script into one portable C11 file that runs like the VM: same output, same
+// runtime errors at the same positions. The file carries a small runtime (tagged values as in value.h,
+// the operators of operations.h), so it only needs the C library.
+// Statically typed operations become plain C on the value fields, so the C compiler can keep them in
+// registers, anything else calls the runtime. Every subexpression goes into its own temporary, which
+// keeps DLang's left to right order where C leaves it unspecified.
+//
+// The file defines int dlang_main(void), which runs the script and returns the exit status, and
+// main() unless DLANG_SHARED is defined, for a shared object a host calls as often as it likes.
+// The tree must be resolved and type checked, and compiled to the given program, which validates calls.
+// The array builtins of builtins.h have no C version: a call to one is an AOT ERROR, such scripts run in the VM.
+class CEmitter {
+private:
+
+	const Program* m_program = nullptr;
+	std::unordered_map<SymbolId, size_t> m_functions; // Index in program.functions, as the compiler gave it
+	size_t m_function = 0;
+	std::string m_constants; // File scope strings and arrays
+	std::string m_code; // Function being emitted
+	std::string m_indent;
+	int m_temps = 0;
+	int m_constant_count = 0;
+
+private:
+	void line(const std::string& text) { m_code += m_indent + text + "\n"; }
+	std::string assign(const std::string& expr); // Declare a temporary holding expr, returns its name
+	std::string stringConstant(std::string_view text); // Name of a DString
+	std::string floatLiteral(double value);
+	std::string position(Token* token);
+	std::string variable(IdNode* identifier); // Name of the C variable
+	std::string load(IdNode* identifier, Token* position);
+	std::string coerce(const std::string& value, ValueType type);
+	std::string defaultValue(ValueType type);
+	std::string returnType(); // Of the function being emitted
+
+	void statement(AST* ast);
+	void block(BlockOfCodeNode* node); // Its statements, one level deeper
+	void function(FuncNode* node);
+
+	// Expressions return a C expression without side effects (a temporary or a constant), statements ""
+	std::string visit(AST* ast) { return dispatch(ast, [this](auto* node) { return visit(node); }); }
+	std::string visit(IntNode* node);
+	std::string visit(FloatNode* node);
+	std::string visit(StrNode* node);
+	std::string visit(ArrayNode* node);
+	std::string visit(IdNode* node) { return load(node, node->identifier); }
+	std::string visit(UnOpNode* node);
+	std::string visit(BinOpNode* node);
+	std::string visit(EmptyVarDeclNode* node);
+	std::string visit(FullVarDeclNode* node);
+	std::string visit(ReasignVarNode* node);
+	std::string visit(BlockOfCodeNode* node);
+	std::string visit(IfStmtNode* node);
+	std::string visit(WhileStmtNode* node);
+	std::string visit(FuncNode*) { return ""; }
+	std::string visit(FuncParamNode*) { return ""; }
+	std::string visit(IncDecNode* node);
+	std::string visit(FuncCallNode* node);
+	std::string visit(ReturnStmtNode* node);
+
+public:
+	std::string emit(const std::vector<AST*>& ast, const Program& program); // The whole C file
+};
+#endif // !C_EMITTER_H
@@ -0,0 +1,352 @@
+#include "compiler.h"
+#include "operations.h"
+#include "../Error/error.h"
+
+// Main function
+void Compiler::compile(const std::vector<AST*>& ast, Program& program) {
+	m_program = &program;
+	m_functions.clear();
+	m_int_constants.clear();
+
+	program.functions.clear();
+	program.global_names.clear();
+	program.functions.emplace_back();
+	program.functions[0].name = "<main>";
+
+	// Functions are hoisted, so a call may come before the declaration
+	std::vector<FuncNode*> functions;
+	for (AST* node : ast) {
+		FuncNode* func = nodeCast<FuncNode>(node);
+		if (!func) continue;
+		std::string name(func->func_name->identifier->value);
+		if (m_functions.count(func->func_name->symbol))
+			raiseError(std::format("SEMANTIC ERROR: Function {} is already declared in {}:{}\n", name, func->func_name->identifier->line, func->func_name->identifier->column));
+		m_functions[func->func_name->symbol] = static_cast<int>(program.functions.size());
+		program.functions.emplace_back();
+		program.functions.back().name = name;
+		program.functions.back().arity = static_cast<int>(func->params->params.size());
+		program.functions.back().return_type = valueTypeFromName(func->func_return_type->value);
+		functions.push_back(func);
+	}
+
+	m_function = 0;
+	m_stack_depth = 0;
+	for (AST* node : ast)
+		if (node && !nodeCast<FuncNode>(node)) compileStatement(node);
+	emit(OP_HALT);
+
+	for (FuncNode* func : functions) compileFunction(func);
+}
+
+size_t Compiler::emit(OpCode op, int32_t operand) {
+	Function& func = function();
+	func.code.push_back({ op, operand });
+	func.lines.push_back(static_cast<uint32_t>(m_line));
+	func.columns.push_back(static_cast<uint32_t>(m_column));
+	if (isBinaryOp(op)) adjustStack(-1);
+	else switch (op) {
+		case OP_PUSH_CONST: case OP_PUSH_NONE: case OP_PUSH_FALSE: case OP_NEW_ARRAY:
+		case OP_LOAD_LOCAL: case OP_LOAD_GLOBAL:
+			adjustStack(1); break;
+		case OP_POP: case OP_STORE_LOCAL: case OP_STORE_GLOBAL: case OP_JUMP_IF_FALSE:
+			adjustStack(-1); break;
+		case OP_CALL:
+			adjustStack(1 - m_program->functions[operand].arity); break;
+		case OP_CALL_BUILTIN:
+			adjustStack(1 - builtin(operand).arity); break;
+		case OP_PRINT:
+			adjustStack(1 - operand); break;
+		case OP_RETURN:
+			adjustStack(-1); break;
+		default: break;
+	}
+	return func.code.size() - 1;
+}
+
+void Compiler::patchJump(size_t instruction) {
+	function().code[instruction].operand = static_cast<int32_t>(function().code.size());
+}
+
+void Compiler::adjustStack(int delta) {
+	m_stack_depth += delta;
+	if (m_stack_depth > function().max_stack) function().max_stack = m_stack_depth;
+}
+
+int Compiler::addConstant(Value value) {
+	if (value.type == ValueType::INT) {
+		auto it = m_int_constants.find(value.i);
+		if (it != m_int_constants.end()) return it->second;
+		m_int_constants[value.i] = static_cast<int>(m_program->constants.size());
+	}
+	m_program->constants.push_back(value);
+	return static_cast<int>(m_program->constants.size() - 1);
+}
+
+void Compiler::setPosition(Token* token) {
+	if (!token) return;
+	m_line = token->line;
+	m_column = token->column;
+}
+
+void Compiler::declareVariable(IdNode* identifier) {
+	size_t slot = static_cast<size_t>(identifier->slot);
+	if (identifier->is_global) {
+		std::vector<std::string>& names = m_program->global_names;
+		if (slot >= names.size()) names.resize(slot + 1);
+		names[slot] = identifier->identifier->value;
+		return;
+	}
+	if (identifier->slot + 1 > function().num_locals) function().num_locals = identifier->slot + 1;
+}
+
+Compiler::VarRef Compiler::resolve(IdNode* identifier) {
+	return { identifier->is_global, identifier->slot, valueTypeFromName(identifier->declaration->var_type->value) };
+}
+
+void Compiler::emitLoad(const VarRef& var) { emit(var.is_global ? OP_LOAD_GLOBAL : OP_LOAD_LOCAL, var.slot); }
+
+void Compiler::emitStore(const VarRef& var) { emit(var.is_global ? OP_STORE_GLOBAL : OP_STORE_LOCAL, var.slot); }
+
+void Compiler::emitCoerce(ValueType type) {
+	if (type == ValueType::INT) emit(OP_TO_INT);
+	else if (type == ValueType::FLOAT) emit(OP_TO_FLOAT);
+}
+
+void Compiler::emitDefault(ValueType type) {
+	if (type == ValueType::NONE) { emit(OP_PUSH_NONE); return; }
+	emit(OP_PUSH_CONST, addConstant(defaultValue(type, m_program->heap)));
+}
+
+// Statements leave the stack as they found it
+void Compiler::compileStatement(AST* ast) {
+	if (!ast) return;
+	if (FuncNode* func = nodeCast<FuncNode>(ast))
+		raiseError(std::format("SEMANTIC ERROR: Function {} must be declared at top level in {}:{}\n",
+			func->func_name->identifier->value, func->func_name->identifier->line, func->func_name->identifier->column));
+	visit(ast);
+	if (nodeCast<FuncCallNode>(ast)) emit(OP_POP);
+}
+
+void Compiler::compileFunction(FuncNode* node) {
+	m_function = m_functions.at(node->func_name->symbol);
+	m_stack_depth = 0;
+	setPosition(node->func_name->identifier);
+	function().num_locals = node->num_locals;
+	// Arguments are converted to the declared parameter types on entry
+	for (EmptyVarDeclNode* param : node->params->params) {
+		VarRef var = resolve(param->identifier);
+		if (var.type != ValueType::INT && var.type != ValueType::FLOAT) continue;
+		emit(OP_LOAD_LOCAL, var.slot);
+		emitCoerce(var.type);
+		emit(OP_STORE_LOCAL, var.slot);
+	}
+	visit(node->code_to_execute);
+	emitDefault(function().return_type);
+	emit(OP_RETURN);
+}
+
+// Expressions push exactly one value
+void Compiler::visit(IntNode* node) {
+	m_line = node->line; m_column = node->column;
+	emit(OP_PUSH_CONST, addConstant(Value::fromInt(node->value)));
+}
+
+void Compiler::visit(FloatNode* node) {
+	m_line = node->line; m_column = node->column;
+	emit(OP_PUSH_CONST, addConstant(Value::fromFloat(node->value)));
+}
+
+void Compiler::visit(StrNode* node) {
+	m_line = node->line; m_column = node->column;
+	// Token value keeps the quotes
+	std::string str(node->value);
+	if (!str.empty() && str.front() == '"') str.erase(0, 1);
+	if (!str.empty() && str.back() == '"') str.pop_back();
+	emit(OP_PUSH_CONST, addConstant(Value::fromString(m_program->heap.newString(std::move(str)))));
+}
+
+void Compiler::visit(ArrayNode* node) {
+	if (!node->elements.empty()) setPosition(node->elements.back());
+	// A copy each time, builtins like push change the array they get
+	emit(OP_NEW_ARRAY, addConstant(Value::fromArray(arrayFromLiteral(node->elements, m_program->heap))));
+}
+
+void Compiler::visit(IdNode* node) {
+	setPosition(node->identifier);
+	emitLoad(resolve(node));
+}
+
+void Compiler::visit(UnOpNode* node) {
+	setPosition(node->operation);
+	switch (node->operation->type) {
+		case TokenType::INCREMENT:
+		case TokenType::DECREMENT: { // id++ as expression gives the old value
+			VarRef var = resolve(nodeCast<IdNode>(node->right));
+			emitLoad(var);
+			bool inc = node->operation->type == TokenType::INCREMENT;
+			emit(var.is_global ? (inc ? OP_INC_GLOBAL : OP_DEC_GLOBAL) : (inc ? OP_INC_LOCAL : OP_DEC_LOCAL), var.slot);
+			return;
+		}
+		default: break;
+	}
+	visit(node->right);
+	setPosition(node->operation);
+	ValueType operand = node->operand_type;
+	switch (node->operation->type) {
+		case TokenType::MINUS: emit((operand == ValueType::INT) ? OP_NEGATE_INT : (operand == ValueType::FLOAT) ? OP_NEGATE_FLOAT : OP_NEGATE); break;
+		case TokenType::PLUS: if (operand != ValueType::FLOAT) emit(OP_PLUS); break; // +int still turns a bool into an int
+		default: emit(OP_NOT); break;
+	}
+}
+
+void Compiler::visit(BinOpNode* node) {
+	TokenType op = node->operation->type;
+	// && and || are short circuit
+	if (op == TokenType::LOGIC_AND || op == TokenType::LOGIC_OR) {
+		visit(node->left);
+		setPosition(node->operation);
+		if (op == TokenType::LOGIC_OR) emit(OP_NOT);
+		size_t short_circuit = emit(OP_JUMP_IF_FALSE);
+		visit(node->right);
+		emit(OP_TO_BOOL);
+		size_t end = emit(OP_JUMP);
+		adjustStack(-1);
+		patchJump(short_circuit);
+		emit(OP_PUSH_FALSE);
+		if (op == TokenType::LOGIC_OR) emit(OP_NOT);
+		patchJump(end);
+		return;
+	}
+	// Operand types from the type checker: int with float compiles as float, the int is converted where it's pushed
+	ValueType left = node->left_type, right = node->right_type;
+	bool numbers = (left == ValueType::INT || left == ValueType::FLOAT) && (right == ValueType::INT || right == ValueType::FLOAT);
+	ValueType operands = (numbers && left != right) ? ValueType::FLOAT : left;
+	visit(node->left);
+	if (numbers && left != operands) emit(OP_TO_FLOAT);
+	visit(node->right);
+	if (numbers && right != operands) emit(OP_TO_FLOAT);
+	setPosition(node->operation);
+	OpCode generic;
+	switch (op) {
+		case TokenType::PLUS: generic = OP_ADD; break;
+		case TokenType::MINUS: generic = OP_SUB; break;
+		case TokenType::MULTIPLY: generic = OP_MUL; break;
+		case TokenType::DIVIDE: generic = OP_DIV; break;
+		case TokenType::LESS: generic = OP_LESS; break;
+		case TokenType::GREATER: generic = OP_GREATER; break;
+		case TokenType::LESS_EQUAL: generic = OP_LESS_EQUAL; break;
+		case TokenType::GREATER_EQUAL: generic = OP_GREATER_EQUAL; break;
+		case TokenType::EQUAL_EQUAL: generic = OP_EQUAL_EQUAL; break;
+		case TokenType::NOT_EQUAL: generic = OP_NOT_EQUAL; break;
+		default: raiseError(std::format("SEMANTIC ERROR: Unknown operation {} in {}:{}\n", node->operation->value, m_line, m_column)); return;
+	}
+	if (numbers) emit(typedOp(generic, operands));
+	else if (generic == OP_ADD && left == ValueType::STRING && right == ValueType::STRING) emit(OP_CONCAT);
+	else emit(generic);
+}
+
+void Compiler::visit(EmptyVarDeclNode* node) {
+	setPosition(node->identifier->identifier);
+	ValueType type = valueTypeFromName(node->var_type->value);
+	emitDefault(type);
+	declareVariable(node->identifier);
+	emitStore(resolve(node->identifier));
+}
+
+void Compiler::visit(FullVarDeclNode* node) {
+	EmptyVarDeclNode* decl = node->declaration;
+	visit(node->expr);
+	setPosition(decl->identifier->identifier);
+	emitCoerce(valueTypeFromName(decl->var_type->value));
+	declareVariable(decl->identifier);
+	emitStore(resolve(decl->identifier));
+}
+
+void Compiler::visit(ReasignVarNode* node) {
+	setPosition(node->assign);
+	VarRef var = resolve(node->identifier);
+	if (node->assign->type != TokenType::EQUAL) emitLoad(var);
+	visit(node->expr);
+	setPosition(node->assign);
+	switch (node->assign->type) {
+		case TokenType::PLUS_EQUAL: emit(OP_ADD); break;
+		case TokenType::MINUS_EQUAL: emit(OP_SUB); break;
+		case TokenType::MULTIPLY_EQUAL: emit(OP_MUL); break;
+		case TokenType::DIVIDE_EQUAL: emit(OP_DIV); break;
+		default: break;
+	}
+	emitCoerce(var.type);
+	emitStore(var);
+}
+
+void Compiler::visit(BlockOfCodeNode* node) {
+	for (AST* ast : node->list) compileStatement(ast);
+}
+
+void Compiler::visit(IfStmtNode* node) {
+	visit(node->condition);
+	size_t skip = emit(OP_JUMP_IF_FALSE);
+	visit(node->code_to_execute);
+	patchJump(skip);
+}
+
+void Compiler::visit(WhileStmtNode* node) {
+	int32_t loop_start = static_cast<int32_t>(function().code.size());
+	visit(node->condition);
+	size_t exit = emit(OP_JUMP_IF_FALSE);
+	visit(node->code_to_execute);
+	emit(OP_JUMP, loop_start);
+	patchJump(exit);
+}
+
+void Compiler::visit(FuncNode* node) { compileFunction(node); }
+
+void Compiler::visit(FuncParamNode*) {}
+
+void Compiler::visit(IncDecNode* node) {
+	setPosition(node->operation);
+	VarRef var = resolve(node->identifier);
+	bool inc = node->operation->type == TokenType::INCREMENT;
+	emit(var.is_global ? (inc ? OP_INC_GLOBAL : OP_DEC_GLOBAL) : (inc ? OP_INC_LOCAL : OP_DEC_LOCAL), var.slot);
+}
+
+void Compiler::visit(FuncCallNode* node) {
+	Token* name = node->func_name->identifier;
+	auto func = m_functions.find(node->func_name->symbol);
+	// print is builtin unless the script declares its own
+	if (func == m_functions.end() && name->value == "print") {
+		for (AST* arg : node->args) visit(arg);
+		setPosition(name);
+		emit(OP_PRINT, static_cast<int32_t>(node->args.size()));
+		return;
+	}
+	int index = (func == m_functions.end()) ? findBuiltin(name->value) : -1;
+	if (index >= 0) {
+		if (static_cast<int>(node->args.size()) != builtin(index).arity)
+			raiseError(std::format("SEMANTIC ERROR: Function {} takes {} arguments but {} were given in {}:{}\n",
+				name->value, builtin(index).arity, node->args.size(), name->line, name->column));
+		for (AST* arg : node->args) visit(arg);
+		setPosition(name);
+		emit(OP_CALL_BUILTIN, index);
+		return;
+	}
+	if (func == m_functions.end())
+		raiseError(std::format("SEMANTIC ERROR: Undefined function {} in {}:{}\n", name->value, name->line, name->column));
+	if (static_cast<int>(node->args.size()) != m_program->functions[func->second].arity)
+		raiseError(std::format("SEMANTIC ERROR: Function {} takes {} arguments but {} were given in {}:{}\n",
+			name->value, m_program->functions[func->second].arity, node->args.size(), name->line, name->column));
+	for (AST* arg : node->args) visit(arg);
+	setPosition(name);
+	emit(OP_CALL, func->second);
+}
+
+void Compiler::visit(ReturnStmtNode* node) {
+	setPosition(node->key_word);
+	if (m_function == 0)
+		raiseError(std::format("SEMANTIC ERROR: Return outside of function in {}:{}\n", m_line, m_column));
+	if (node->expr) visit(node->expr);
+	else emit(OP_PUSH_NONE);
+	setPosition(node->key_word);
+	emitCoerce(function().return_type);
+	emit(OP_RETURN);
+}
@@ -0,0 +1,70 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bytecode.h"
+#include "../Parser/AST/ast.h"
+
+// Lowers the AST into linear bytecode for the VM. The tree must have been through the Resolver,
+// variables are loaded and stored at the slots it gave them.
+class Compiler {
+private:
+	// Where an identifier lives
+	struct VarRef {
+		bool is_global;
+		int slot;
+		ValueType type;
+	};
+
+	Program* m_program = nullptr;
+	size_t m_function = 0; // index of the function being compiled
+	std::unordered_map<SymbolId, int> m_functions;
+	std::unordered_map<int64_t, int> m_int_constants;
+	int m_stack_depth = 0;
+	size_t m_line = 0, m_column = 0;
+
+private:
+	Function& function() { return m_program->functions[m_function]; }
+	size_t emit(OpCode op, int32_t operand = 0); // Append instruction, returns its index
+	void patchJump(size_t instruction); // Point jump at the next instruction
+	void adjustStack(int delta);
+	int addConstant(Value value);
+	void setPosition(Token* token);
+
+	void declareVariable(IdNode* identifier); // Make room for its slot
+	VarRef resolve(IdNode* identifier);
+	void emitLoad(const VarRef& var);
+	void emitStore(const VarRef& var);
+	void emitCoerce(ValueType type);
+	void emitDefault(ValueType type);
+
+	void compileStatement(AST* ast);
+	void compileFunction(FuncNode* node);
+
+	void visit(AST* ast) { dispatch(ast, [this](auto* node) { visit(node); }); } // Switch on the kind, then the overload below
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	Compiler() = default;
+	void compile(const std::vector<AST*>& ast, Program& program);
+};
+#endif // !COMPILER_H
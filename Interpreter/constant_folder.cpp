@@ -0,0 +1,184 @@
+#include <stdexcept>
+#include "constant_folder.h"
+#include "operations.h"
+
+// Main function
+void ConstantFolder::fold(std::vector<AST*>& ast) {
+	std::span<AST*> list = foldStatements(ast);
+	ast.resize(list.size());
+}
+
+AST* ConstantFolder::foldExpression(AST* ast, std::optional<Value>* value) {
+	m_node = ast;
+	m_value.reset();
+	if (ast) visit(ast);
+	if (value) *value = m_value;
+	return m_node;
+}
+
+AST* ConstantFolder::foldStatement(AST* ast) {
+	m_node = ast;
+	if (ast) visit(ast);
+	return m_node;
+}
+
+std::span<AST*> ConstantFolder::foldStatements(std::span<AST*> list) {
+	size_t kept = 0;
+	for (AST* ast : list)
+		if (AST* folded = foldStatement(ast)) list[kept++] = folded;
+	return list.first(kept);
+}
+
+AST* ConstantFolder::makeLiteral(const Value& value, Token* position) {
+	if (value.type == ValueType::INT) return m_arena.make<IntNode>(value.i, position->line, position->column);
+	if (value.type == ValueType::FLOAT) return m_arena.make<FloatNode>(value.f, position->line, position->column);
+	return nullptr;
+}
+
+// A value no literal holds leaves node as it is and unknown, so parents only fold what the tree holds
+void ConstantFolder::replace(AST* node, const Value& value, Token* position) {
+	m_node = makeLiteral(value, position);
+	m_value = value;
+	if (m_node) ++m_stats.folded;
+	else {
+		m_node = node;
+		m_value.reset();
+	}
+}
+
+AST* ConstantFolder::makePlus(Token* position, AST* expression) {
+	if (nodeCast<IntNode>(expression) || nodeCast<FloatNode>(expression)) return expression;
+	if (UnOpNode* unary = nodeCast<UnOpNode>(expression); unary && unary->operation->type == TokenType::PLUS) return expression;
+	return m_arena.make<UnOpNode>(m_arena.make<Token>(position->line, position->column, TokenType::PLUS, "+"), expression);
+}
+
+void ConstantFolder::visit(IntNode* node) { m_value = Value::fromInt(node->value); }
+
+void ConstantFolder::visit(FloatNode* node) { m_value = Value::fromFloat(node->value); }
+
+void ConstantFolder::visit(StrNode*) {}
+
+void ConstantFolder::visit(ArrayNode*) {}
+
+void ConstantFolder::visit(IdNode*) {}
+
+void ConstantFolder::visit(UnOpNode* node) {
+	Token* op = node->operation;
+	if (op->type == TokenType::INCREMENT || op->type == TokenType::DECREMENT) return;
+	std::optional<Value> value;
+	node->right = foldExpression(node->right, &value);
+	m_node = node;
+	m_value.reset();
+	if (value) {
+		if (op->type == TokenType::NOT) m_value = Value::fromBool(!isTruthy(*value));
+		else if (value->isNumber()) replace(node, negate(op->type, *value, op->line, op->column), op);
+		return;
+	}
+	// -(-x) and +(+x) keep only the numeric check of x
+	UnOpNode* inner = nodeCast<UnOpNode>(node->right);
+	if (inner && op->type != TokenType::NOT && inner->operation->type == op->type) {
+		m_node = makePlus(op, inner->right);
+		++m_stats.simplified;
+	}
+}
+
+void ConstantFolder::visit(BinOpNode* node) {
+	Token* op = node->operation;
+	std::optional<Value> left, right;
+	node->left = foldExpression(node->left, &left);
+	node->right = foldExpression(node->right, &right);
+	m_node = node;
+	m_value.reset();
+	switch (op->type) {
+		// Short circuit: a known left side may decide the value even if the right side is unknown
+		case TokenType::LOGIC_AND:
+			if (left && !isTruthy(*left)) m_value = Value::fromBool(false);
+			else if (left && right) m_value = Value::fromBool(isTruthy(*right));
+			return;
+		case TokenType::LOGIC_OR:
+			if (left && isTruthy(*left)) m_value = Value::fromBool(true);
+			else if (left && right) m_value = Value::fromBool(isTruthy(*right));
+			return;
+		case TokenType::LESS:
+		case TokenType::GREATER:
+		case TokenType::LESS_EQUAL:
+		case TokenType::GREATER_EQUAL:
+		case TokenType::EQUAL_EQUAL:
+		case TokenType::NOT_EQUAL:
+			if (left && right) m_value = compare(op->type, *left, *right, op->line, op->column);
+			return;
+		default: break;
+	}
+	if (left && right) {
+		try { replace(node, arithmetic(op->type, *left, *right, m_heap, op->line, op->column), op); }
+		catch (const std::runtime_error&) {} // Division by zero is reported when it runs
+		return;
+	}
+	auto isInt = [](const std::optional<Value>& value, int64_t number) { return value && value->type == ValueType::INT && value->i == number; };
+	AST* operand = nullptr;
+	if (op->type == TokenType::MULTIPLY && isInt(right, 1)) operand = node->left;
+	else if (op->type == TokenType::MULTIPLY && isInt(left, 1)) operand = node->right;
+	else if (op->type == TokenType::DIVIDE && isInt(right, 1)) operand = node->left;
+	else if (op->type == TokenType::MINUS && isInt(right, 0)) operand = node->left;
+	if (!operand) return;
+	m_node = makePlus(op, operand);
+	++m_stats.simplified;
+}
+
+void ConstantFolder::visit(EmptyVarDeclNode*) {}
+
+void ConstantFolder::visit(FullVarDeclNode* node) {
+	node->expr = foldExpression(node->expr);
+	m_node = node;
+}
+
+void ConstantFolder::visit(ReasignVarNode* node) {
+	node->expr = foldExpression(node->expr);
+	m_node = node;
+}
+
+void ConstantFolder::visit(BlockOfCodeNode* node) {
+	node->list = foldStatements(node->list);
+	m_node = node;
+}
+
+// if (true) { ... } keeps its block, so the scope of its variables stays the same
+void ConstantFolder::visit(IfStmtNode* node) {
+	std::optional<Value> condition;
+	node->condition = foldExpression(node->condition, &condition);
+	foldStatement(node->code_to_execute);
+	m_node = node;
+	if (!condition) return;
+	m_node = isTruthy(*condition) ? node->code_to_execute : nullptr;
+	++m_stats.branches;
+}
+
+void ConstantFolder::visit(WhileStmtNode* node) {
+	std::optional<Value> condition;
+	node->condition = foldExpression(node->condition, &condition);
+	foldStatement(node->code_to_execute);
+	m_node = node;
+	if (!condition || isTruthy(*condition)) return;
+	m_node = nullptr;
+	++m_stats.branches;
+}
+
+void ConstantFolder::visit(FuncNode* node) {
+	foldStatement(node->code_to_execute);
+	m_node = node;
+}
+
+void ConstantFolder::visit(FuncParamNode*) {}
+
+void ConstantFolder::visit(IncDecNode*) {}
+
+void ConstantFolder::visit(FuncCallNode* node) {
+	for (AST*& arg : node->args) arg = foldExpression(arg);
+	m_node = node;
+	m_value.reset();
+}
+
+void ConstantFolder::visit(ReturnStmtNode* node) {
+	node->expr = foldExpression(node->expr);
+	m_node = node;
+}
@@ -0,0 +1,64 @@
+#ifndef CONSTANT_FOLDER_H
+#define CONSTANT_FOLDER_H
+
+#include <optional>
+#include <span>
+#include <vector>
+#include "value.h"
+#include "../Parser/AST/ast.h"
+
+// Optimization pass run between parsing and execution, rewrites the AST in place:
+//  - operators on int and float literals are evaluated with the backends' own operations
+//  - x * 1, 1 * x, x / 1, x - 0, -(-x) and +(+x) become +x, which keeps the runtime type checks
+//  - if with a constant condition is replaced by its block or removed, while with a false one is removed
+// Anything that would raise an error (1 / 0, "a" * 2) is left for the backend to report at run time.
+// Only int and float results become literals, an operator giving a string stays in the tree.
+class ConstantFolder {
+public:
+	struct Stats {
+		size_t folded = 0; // Operators evaluated at compile time
+		size_t simplified = 0; // Identities removed
+		size_t branches = 0; // if and while statements removed or replaced by their block
+	};
+
+private:
+	Arena& m_arena;
+	Heap m_heap; // Needed by arithmetic(), folded values never live here
+	Stats m_stats;
+	AST* m_node = nullptr; // Replacement of the visited node, nullptr removes a statement
+	std::optional<Value> m_value; // Value of the visited expression if known at compile time
+
+private:
+	AST* foldExpression(AST* ast, std::optional<Value>* value = nullptr);
+	AST* foldStatement(AST* ast);
+	std::span<AST*> foldStatements(std::span<AST*> list); // Drops removed statements
+	AST* makeLiteral(const Value& value, Token* position); // nullptr if no literal node can hold value
+	void replace(AST* node, const Value& value, Token* position); // By a literal of value if one holds it
+	AST* makePlus(Token* position, AST* expression); // +expression, a numeric check without an operation
+
+	void visit(AST* ast) { dispatch(ast, [this](auto* node) { visit(node); }); } // Switch on the kind, then the overload below
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	ConstantFolder(Arena& arena): m_arena(arena) {}
+	void fold(std::vector<AST*>& ast);
+	const Stats& stats() const { return m_stats; }
+};
+#endif // !CONSTANT_FOLDER_H
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "interpreter.h"
+#include "c_emitter.h"
+#include "compiler.h"
+#include "resolver.h"
+#include "tree_walker.h"
+#include "type_checker.h"
+#include "vm.h"
+#include "../Error/error.h"
+
+void Interpreter::check(const std::vector<AST*>& ast) {
+	{
+		ScopedTimer timer(m_stats, Phase::RESOLVE);
+		Resolver().resolve(ast);
+	}
+	ScopedTimer timer(m_stats, Phase::CHECK);
+	TypeChecker checker;
+	checker.check(ast);
+}
+
+void Interpreter::compile(const std::vector<AST*>& ast, Program& program) {
+	check(ast);
+	ScopedTimer timer(m_stats, Phase::COMPILE);
+	Compiler compiler;
+	compiler.compile(ast, program);
+}
+
+void Interpreter::run(const std::vector<AST*>& ast, Backend backend) {
+	if (backend == Backend::TREE_WALKER) {
+		check(ast);
+		ScopedTimer timer(m_stats, Phase::RUN);
+		TreeWalker walker(m_out);
+		walker.run(ast);
+		return;
+	}
+	Program program;
+	compile(ast, program);
+	ScopedTimer timer(m_stats, Phase::RUN);
+	VM vm(m_out, m_jit);
+	vm.run(program);
+}
+
+std::string Interpreter::emitC(const std::vector<AST*>& ast) {
+	Program program; // Compiling first reports the same errors as running would
+	compile(ast, program);
+	ScopedTimer timer(m_stats, Phase::EMIT);
+	return CEmitter().emit(ast, program);
+}
+
+void Interpreter::buildNative(const std::vector<AST*>& ast, const std::string& output, bool shared) {
+	std::string source = output + ".c";
+	{
+		std::string code = emitC(ast);
+		std::ofstream file(source, std::ios::binary);
+		if (!(file << code)) raiseError(std::format("AOT ERROR: Can't write {}\n", source));
+	}
+	ScopedTimer timer(m_stats, Phase::CC);
+	const char* cc = std::getenv("CC");
+	const char* flags = std::getenv("CFLAGS");
+#ifdef _WIN32
+	std::string command = std::format("{} /nologo /std:c11 {} {} \"{}\" /Fe:\"{}\"", cc ? cc : "cl", flags ? flags : "/O2",
+		shared ? "/LD /DDLANG_SHARED" : "", source, output);
+#else
+	std::string command = std::format("{} {} {} -o \"{}\" \"{}\"", cc ? cc : "cc", flags ? flags : "-O2",
+		shared ? "-shared -fPIC -DDLANG_SHARED" : "", output, source);
+#endif
+	if (int status = std::system(command.c_str()))
+		raiseError(std::format("AOT ERROR: {} failed with status {}\n", command, status));
+}
+
+// Output, error and final globals of one backend
+struct RunResult {
+	std::string output;
+	std::string error;
+	std::vector<std::pair<std::string, std::string>> globals;
+	double millis = 0;
+};
+
+// A name or type error stops both backends before they start, it is raised from here and not compared
+bool Interpreter::compare(const std::vector<AST*>& ast, std::ostream& report) {
+	using Clock = std::chrono::steady_clock;
+	RunResult vm_result, walker_result;
+	check(ast);
+
+	std::ostringstream vm_out;
+	Program program;
+	VM vm(vm_out, m_jit);
+	auto start = Clock::now();
+	try {
+		Compiler().compile(ast, program);
+		vm.run(program);
+	}
+	catch (std::exception& err) { vm_result.error = err.what(); }
+	vm_result.millis = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	vm_result.output = vm_out.str();
+	for (size_t i = 0; i < vm.globals().size(); ++i)
+		vm_result.globals.push_back({ program.global_names[i], valueToString(vm.globals()[i]) });
+
+	std::ostringstream walker_out;
+	TreeWalker walker(walker_out);
+	start = Clock::now();
+	try { walker.run(ast); }
+	catch (std::exception& err) { walker_result.error = err.what(); }
+	walker_result.millis = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	walker_result.output = walker_out.str();
+	for (const auto& [name, value] : walker.globals())
+		walker_result.globals.push_back({ name, valueToString(value) });
+
+	bool match = true;
+	if (vm_result.output != walker_result.output) {
+		match = false;
+		report << "Output differs:\n--- vm\n" << vm_result.output << "--- tree walker\n" << walker_result.output;
+	}
+	if (vm_result.error != walker_result.error) {
+		match = false;
+		report << "Error differs:\n--- vm\n" << vm_result.error << "\n--- tree walker\n" << walker_result.error << "\n";
+	}
+	// After an error the backends may have stopped at different points, so the globals are not comparable
+	if (vm_result.error.empty() && walker_result.error.empty()) for (const auto& [name, value] : walker_result.globals) {
+		auto it = std::find_if(vm_result.globals.begin(), vm_result.globals.end(), [&](const auto& global) { return global.first == name; });
+		if (it == vm_result.globals.end() || it->second != value) {
+			match = false;
+			report << "Global " << name << " differs: vm " << ((it == vm_result.globals.end()) ? "<missing>" : it->second) << ", tree walker " << value << "\n";
+		}
+	}
+	report << (match ? "MATCH" : "MISMATCH") << " (vm " << vm_result.millis << " ms, tree walker " << walker_result.millis << " ms)\n";
+	return match;
+}
@@ -1,12 +1,31 @@
 #ifndef INTERPRETER_H
 #define INTERPRETER_H
 
+#include <iostream>
 #include "../Parser/AST/ast_printer.h"
 #include "../Parser/Lexer/lexer.h"
 #include "../Parser/parser.h"
+#include "bytecode.h"
+#include "jit.h"
+#include "../Stats/stats.h"
+
+enum class Backend { VM, TREE_WALKER };
 
 class Interpreter {
+private:
+	std::ostream& m_out;
+	Stats* m_stats; // Compile and run times go here if set
+	JitMode m_jit; // For the VM
+
 public:
-	Interpreter() = default;
+	Interpreter(std::ostream& out = std::cout, Stats* stats = nullptr, JitMode jit = JitMode::TIERED): m_out(out), m_stats(stats), m_jit(jit) {}
+	void run(const std::vector<AST*>& ast, Backend backend = Backend::VM); // Execute script
+	void check(const std::vector<AST*>& ast); // Resolve names, type check and annotate, run and compile do it first
+	void compile(const std::vector<AST*>& ast, Program& program); // Lower AST to bytecode
+	bool compare(const std::vector<AST*>& ast, std::ostream& report); // Run both backends and diff the results
+	std::string emitC(const std::vector<AST*>& ast); // Translate to a standalone C program, see c_emitter.h
+	// Write output.c and build it with the system C compiler ($CC, flags from $CFLAGS, -O2 by default)
+	// into an executable, or into a shared object exporting dlang_main
+	void buildNative(const std::vector<AST*>& ast, const std::string& output, bool shared);
 };
-#endif // !INTERPRETER_H
\ No newline at end of file
+#endif // !INTERPRETER_H
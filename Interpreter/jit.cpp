@@ -0,0 +1,363 @@
+#include "jit.h"
+
+#ifdef DLANG_JIT
+#include <cstddef>
+#include <cstring>
+#include <sys/mman.h>
+
+// Layout of Value the templates rely on
+constexpr int32_t TYPE = 0;
+constexpr int32_t DATA = 8;
+constexpr int32_t SIZE = 16;
+static_assert(offsetof(Value, type) == TYPE && offsetof(Value, i) == DATA && sizeof(Value) == SIZE);
+
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RSI = 6, RDI = 7 }; // rdi frame base, rsi stack top
+enum Xmm : uint8_t { XMM0 = 0, XMM1 = 1 };
+enum Cond : uint8_t { CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_P = 0xA, CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+constexpr uint8_t REX_W = 0x48;
+constexpr uint8_t TYPE_INT = static_cast<uint8_t>(ValueType::INT);
+constexpr uint8_t TYPE_FLOAT = static_cast<uint8_t>(ValueType::FLOAT);
+constexpr uint8_t TYPE_BOOL = static_cast<uint8_t>(ValueType::BOOL);
+
+// Encodes the few instructions the templates need, memory operands are always [reg + disp32]
+class X64Assembler {
+private:
+	std::vector<uint8_t> m_code;
+
+	void mem(uint8_t reg, Reg base, int32_t disp) {
+		byte(0x80 | (reg << 3) | base);
+		dword(disp);
+	}
+
+public:
+	std::vector<uint8_t>& code() { return m_code; }
+	size_t size() const { return m_code.size(); }
+	void byte(uint8_t value) { m_code.push_back(value); }
+	void dword(int32_t value) { for (int shift = 0; shift < 32; shift += 8) byte(static_cast<uint8_t>(value >> shift)); }
+	void qword(uint64_t value) { for (int shift = 0; shift < 64; shift += 8) byte(static_cast<uint8_t>(value >> shift)); }
+
+	// prefix (0 for none), REX (0 for none), opcode bytes, then the memory operand
+	void op(uint8_t prefix, uint8_t rex, std::initializer_list<uint8_t> opcode, uint8_t reg, Reg base, int32_t disp) {
+		if (prefix) byte(prefix);
+		if (rex) byte(rex);
+		for (uint8_t b : opcode) byte(b);
+		mem(reg, base, disp);
+	}
+
+	// One Value as two qwords through rcx and rdx. Types are stored as qwords too, so that a load
+	// always finds a store of its own size to forward from
+	void copy(Reg to, int32_t to_disp, Reg from, int32_t from_disp) {
+		load(RCX, from, from_disp);
+		load(RDX, from, from_disp + 8);
+		store(to, to_disp, RCX);
+		store(to, to_disp + 8, RDX);
+	}
+	void load(Reg reg, Reg base, int32_t disp) { op(0, REX_W, { 0x8B }, reg, base, disp); }
+	void store(Reg base, int32_t disp, Reg reg) { op(0, REX_W, { 0x89 }, reg, base, disp); }
+	void loadFloat(Xmm reg, Reg base, int32_t disp) { op(0xF2, 0, { 0x0F, 0x10 }, reg, base, disp); }
+	void storeFloat(Reg base, int32_t disp, Xmm reg) { op(0xF2, 0, { 0x0F, 0x11 }, reg, base, disp); }
+	void setType(Reg base, int32_t disp, uint8_t type) { op(0, REX_W, { 0xC7 }, 0, base, disp + TYPE); dword(type); } // Clears the padding
+	void cmpType(Reg base, int32_t disp, uint8_t type) { op(0, 0, { 0x80 }, 7, base, disp + TYPE); byte(type); }
+	void movImm(Reg reg, uint64_t value) { byte(REX_W); byte(0xB8 + reg); qword(value); }
+	void addSp(int8_t delta) { byte(REX_W); byte(0x83); byte(delta > 0 ? 0xC6 : 0xEE); byte(static_cast<uint8_t>(delta > 0 ? delta : -delta)); }
+	void zeroXmm(Xmm reg) { byte(0x66); byte(0x0F); byte(0xEF); byte(0xC0 | (reg << 3) | reg); }
+	void ucomisd(Xmm a, Xmm b) { byte(0x66); byte(0x0F); byte(0x2E); byte(0xC0 | (a << 3) | b); }
+	void setcc(Cond cc, Reg reg) { byte(0x0F); byte(0x90 + cc); byte(0xC0 | reg); }
+	void movzxAl() { byte(0x0F); byte(0xB6); byte(0xC0); }
+
+	size_t jcc(Cond cc) { byte(0x0F); byte(0x80 + cc); dword(0); return size(); } // Returns the end of the jump, for patch
+	size_t jmp() { byte(0xE9); dword(0); return size(); }
+	void patch(size_t jump_end, size_t target) {
+		int32_t rel = static_cast<int32_t>(target) - static_cast<int32_t>(jump_end);
+		std::memcpy(m_code.data() + jump_end - 4, &rel, 4);
+	}
+	void bind(size_t jump_end) { patch(jump_end, size()); }
+
+	// Back to the interpreter at instruction index, it finds the stack as rsi left it
+	void exit(int32_t index) {
+		byte(REX_W); byte(0x89); byte(0xF0); // mov rax, rsi
+		byte(0xBA); dword(index); // mov edx, index
+		byte(0xC3);
+	}
+};
+
+// Compiles one function, instruction by instruction
+class FunctionCompiler {
+private:
+	X64Assembler m_asm;
+	const Program& m_program;
+	const Function& m_function;
+	Value* m_globals;
+	std::vector<std::pair<size_t, int32_t>> m_jumps; // Jump end, target instruction
+	std::vector<std::pair<size_t, int32_t>> m_exits; // Jump end, instruction to leave at
+
+	void exitIf(Cond cc, int32_t index) { m_exits.push_back({ m_asm.jcc(cc), index }); }
+	void requireType(int32_t disp, uint8_t type, int32_t index) { m_asm.cmpType(RSI, disp, type); exitIf(CC_NE, index); }
+
+	void intArithmetic(OpCode op, int32_t index) {
+		if (op == OP_DIV_INT) {
+			m_asm.load(RCX, RSI, -SIZE + DATA);
+			m_asm.byte(REX_W); m_asm.byte(0x85); m_asm.byte(0xC9); // test rcx, rcx
+			exitIf(CC_E, index); // The interpreter raises division by zero
+			m_asm.byte(REX_W); m_asm.byte(0x83); m_asm.byte(0xF9); m_asm.byte(0xFF); // cmp rcx, -1
+			exitIf(CC_E, index); // idiv traps on the smallest int / -1, the interpreter wraps it
+			m_asm.load(RAX, RSI, -2 * SIZE + DATA);
+			m_asm.byte(REX_W); m_asm.byte(0x99); // cqo
+			m_asm.byte(REX_W); m_asm.byte(0xF7); m_asm.byte(0xF9); // idiv rcx
+		}
+		else {
+			m_asm.load(RAX, RSI, -2 * SIZE + DATA);
+			switch (op) {
+				case OP_ADD_INT: m_asm.op(0, REX_W, { 0x03 }, RAX, RSI, -SIZE + DATA); break;
+				case OP_SUB_INT: m_asm.op(0, REX_W, { 0x2B }, RAX, RSI, -SIZE + DATA); break;
+				default: m_asm.op(0, REX_W, { 0x0F, 0xAF }, RAX, RSI, -SIZE + DATA); break;
+			}
+		}
+		m_asm.store(RSI, -2 * SIZE + DATA, RAX);
+		m_asm.setType(RSI, -2 * SIZE, TYPE_INT); // An int operand may have been a bool
+		m_asm.addSp(-SIZE);
+	}
+
+	// al is 0 or 1, becomes a bool in sp[-2] and the stack drops one
+	void storeCompare() {
+		m_asm.movzxAl();
+		m_asm.store(RSI, -2 * SIZE + DATA, RAX);
+		m_asm.setType(RSI, -2 * SIZE, TYPE_BOOL);
+		m_asm.addSp(-SIZE);
+	}
+
+	void intCompare(OpCode op) {
+		static constexpr Cond CONDITIONS[] = { CC_L, CC_G, CC_LE, CC_GE, CC_E, CC_NE };
+		m_asm.load(RAX, RSI, -2 * SIZE + DATA);
+		m_asm.op(0, REX_W, { 0x3B }, RAX, RSI, -SIZE + DATA);
+		m_asm.setcc(CONDITIONS[op - OP_LESS_INT], RAX);
+		storeCompare();
+	}
+
+	// Unordered (nan) is false for all but !=, as in C++
+	void floatCompare(OpCode op) {
+		m_asm.loadFloat(XMM0, RSI, -2 * SIZE + DATA);
+		m_asm.loadFloat(XMM1, RSI, -SIZE + DATA);
+		switch (op) {
+			case OP_LESS_FLOAT: m_asm.ucomisd(XMM1, XMM0); m_asm.setcc(CC_A, RAX); break;
+			case OP_GREATER_FLOAT: m_asm.ucomisd(XMM0, XMM1); m_asm.setcc(CC_A, RAX); break;
+			case OP_LESS_EQUAL_FLOAT: m_asm.ucomisd(XMM1, XMM0); m_asm.setcc(CC_AE, RAX); break;
+			case OP_GREATER_EQUAL_FLOAT: m_asm.ucomisd(XMM0, XMM1); m_asm.setcc(CC_AE, RAX); break;
+			case OP_EQUAL_EQUAL_FLOAT:
+				m_asm.ucomisd(XMM0, XMM1); m_asm.setcc(CC_E, RAX); m_asm.setcc(CC_NP, RCX);
+				m_asm.byte(0x20); m_asm.byte(0xC8); // and al, cl
+				break;
+			default:
+				m_asm.ucomisd(XMM0, XMM1); m_asm.setcc(CC_NE, RAX); m_asm.setcc(CC_P, RCX);
+				m_asm.byte(0x08); m_asm.byte(0xC8); // or al, cl
+				break;
+		}
+		storeCompare();
+	}
+
+	void floatArithmetic(OpCode op) {
+		static constexpr uint8_t OPCODES[] = { 0x58, 0x5C, 0x59, 0x5E }; // addsd subsd mulsd divsd
+		m_asm.loadFloat(XMM0, RSI, -2 * SIZE + DATA);
+		m_asm.op(0xF2, 0, { 0x0F, OPCODES[op - OP_ADD_FLOAT] }, XMM0, RSI, -SIZE + DATA);
+		m_asm.storeFloat(RSI, -2 * SIZE + DATA, XMM0);
+		m_asm.addSp(-SIZE);
+	}
+
+	// al = isTruthy(sp[-1]) for bool, int and float, anything else leaves at index
+	void truthy(int32_t index) {
+		m_asm.op(0, 0, { 0x0F, 0xB6 }, RCX, RSI, -SIZE + TYPE); // movzx ecx, type
+		m_asm.byte(0x80); m_asm.byte(0xF9); m_asm.byte(TYPE_BOOL); // cmp cl, BOOL
+		size_t not_bool = m_asm.jcc(CC_NE);
+		m_asm.op(0, 0, { 0x0F, 0xB6 }, RAX, RSI, -SIZE + DATA); // movzx eax, b
+		size_t bool_done = m_asm.jmp();
+		m_asm.bind(not_bool);
+		m_asm.byte(0x80); m_asm.byte(0xF9); m_asm.byte(TYPE_INT);
+		size_t not_int = m_asm.jcc(CC_NE);
+		m_asm.op(0, REX_W, { 0x83 }, 7, RSI, -SIZE + DATA); m_asm.byte(0); // cmp qword i, 0
+		m_asm.setcc(CC_NE, RAX);
+		size_t int_done = m_asm.jmp();
+		m_asm.bind(not_int);
+		m_asm.byte(0x80); m_asm.byte(0xF9); m_asm.byte(TYPE_FLOAT);
+		exitIf(CC_NE, index);
+		m_asm.loadFloat(XMM0, RSI, -SIZE + DATA);
+		m_asm.zeroXmm(XMM1);
+		m_asm.ucomisd(XMM0, XMM1);
+		m_asm.setcc(CC_NE, RAX);
+		m_asm.setcc(CC_P, RCX);
+		m_asm.byte(0x08); m_asm.byte(0xC8); // or al, cl: nan is truthy
+		m_asm.bind(bool_done);
+		m_asm.bind(int_done);
+	}
+
+	void incDec(Reg base, int32_t disp, bool inc, int32_t index) {
+		m_asm.cmpType(base, disp, TYPE_INT);
+		exitIf(CC_NE, index); // Floats and errors are the interpreter's
+		m_asm.op(0, REX_W, { 0xFF }, inc ? 0 : 1, base, disp + DATA);
+	}
+
+	// Generic operations only go native when both operands are ints
+	void requireInts(int32_t index) {
+		requireType(-2 * SIZE, TYPE_INT, index);
+		requireType(-SIZE, TYPE_INT, index);
+	}
+
+	void instruction(const Instruction& instr, int32_t index) {
+		int32_t operand = instr.operand;
+		switch (instr.op) {
+			case OP_PUSH_CONST:
+				m_asm.movImm(RAX, reinterpret_cast<uint64_t>(&m_program.constants[operand]));
+				m_asm.copy(RSI, 0, RAX, 0);
+				m_asm.addSp(SIZE);
+				break;
+			case OP_PUSH_NONE:
+			case OP_PUSH_FALSE:
+				m_asm.zeroXmm(XMM0);
+				m_asm.op(0, 0, { 0x0F, 0x11 }, XMM0, RSI, 0);
+				if (instr.op == OP_PUSH_FALSE) m_asm.setType(RSI, 0, TYPE_BOOL);
+				m_asm.addSp(SIZE);
+				break;
+			case OP_POP: m_asm.addSp(-SIZE); break;
+			case OP_LOAD_LOCAL:
+				m_asm.copy(RSI, 0, RDI, operand * SIZE);
+				m_asm.addSp(SIZE);
+				break;
+			case OP_STORE_LOCAL:
+				m_asm.addSp(-SIZE);
+				m_asm.copy(RDI, operand * SIZE, RSI, 0);
+				break;
+			case OP_LOAD_GLOBAL:
+				m_asm.movImm(RAX, reinterpret_cast<uint64_t>(m_globals + operand));
+				m_asm.cmpType(RAX, 0, static_cast<uint8_t>(ValueType::NONE));
+				exitIf(CC_E, index); // Used before declaration
+				m_asm.copy(RSI, 0, RAX, 0);
+				m_asm.addSp(SIZE);
+				break;
+			case OP_STORE_GLOBAL:
+				m_asm.addSp(-SIZE);
+				m_asm.movImm(RAX, reinterpret_cast<uint64_t>(m_globals + operand));
+				m_asm.copy(RAX, 0, RSI, 0);
+				break;
+			case OP_INC_LOCAL: incDec(RDI, operand * SIZE, true, index); break;
+			case OP_DEC_LOCAL: incDec(RDI, operand * SIZE, false, index); break;
+			case OP_INC_GLOBAL:
+			case OP_DEC_GLOBAL:
+				m_asm.movImm(RAX, reinterpret_cast<uint64_t>(m_globals + operand));
+				incDec(RAX, 0, instr.op == OP_INC_GLOBAL, index);
+				break;
+			case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV:
+				requireInts(index);
+				intArithmetic(typedOp(instr.op, ValueType::INT), index);
+				break;
+			case OP_LESS: case OP_GREATER: case OP_LESS_EQUAL: case OP_GREATER_EQUAL: case OP_EQUAL_EQUAL: case OP_NOT_EQUAL:
+				requireInts(index);
+				intCompare(typedOp(instr.op, ValueType::INT));
+				break;
+			case OP_ADD_INT: case OP_SUB_INT: case OP_MUL_INT: case OP_DIV_INT: intArithmetic(instr.op, index); break;
+			case OP_LESS_INT: case OP_GREATER_INT: case OP_LESS_EQUAL_INT: case OP_GREATER_EQUAL_INT: case OP_EQUAL_EQUAL_INT: case OP_NOT_EQUAL_INT:
+				intCompare(instr.op);
+				break;
+			case OP_ADD_FLOAT: case OP_SUB_FLOAT: case OP_MUL_FLOAT: case OP_DIV_FLOAT: floatArithmetic(instr.op); break;
+			case OP_LESS_FLOAT: case OP_GREATER_FLOAT: case OP_LESS_EQUAL_FLOAT: case OP_GREATER_EQUAL_FLOAT: case OP_EQUAL_EQUAL_FLOAT: case OP_NOT_EQUAL_FLOAT:
+				floatCompare(instr.op);
+				break;
+			case OP_NEGATE:
+				requireType(-SIZE, TYPE_INT, index);
+				[[fallthrough]];
+			case OP_NEGATE_INT:
+				m_asm.op(0, REX_W, { 0xF7 }, 3, RSI, -SIZE + DATA); // neg
+				m_asm.setType(RSI, -SIZE, TYPE_INT);
+				break;
+			case OP_NEGATE_FLOAT:
+				m_asm.op(0, REX_W, { 0x0F, 0xBA }, 7, RSI, -SIZE + DATA); m_asm.byte(63); // btc sign bit
+				break;
+			case OP_PLUS: requireType(-SIZE, TYPE_INT, index); break; // +int is the int
+			case OP_NOT:
+			case OP_TO_BOOL:
+				truthy(index);
+				if (instr.op == OP_NOT) { m_asm.byte(0x34); m_asm.byte(0x01); } // xor al, 1
+				m_asm.movzxAl();
+				m_asm.store(RSI, -SIZE + DATA, RAX);
+				m_asm.setType(RSI, -SIZE, TYPE_BOOL);
+				break;
+			case OP_TO_INT: {
+				m_asm.cmpType(RSI, -SIZE, TYPE_FLOAT);
+				size_t done = m_asm.jcc(CC_NE);
+				m_asm.op(0xF2, REX_W, { 0x0F, 0x2C }, RAX, RSI, -SIZE + DATA); // cvttsd2si
+				m_asm.store(RSI, -SIZE + DATA, RAX);
+				m_asm.setType(RSI, -SIZE, TYPE_INT);
+				m_asm.bind(done);
+				break;
+			}
+			case OP_TO_FLOAT: { // A bool's i is 0 or 1, it converts like an int
+				m_asm.cmpType(RSI, -SIZE, TYPE_INT);
+				size_t is_int = m_asm.jcc(CC_E);
+				m_asm.cmpType(RSI, -SIZE, TYPE_BOOL);
+				size_t done = m_asm.jcc(CC_NE);
+				m_asm.bind(is_int);
+				m_asm.op(0xF2, REX_W, { 0x0F, 0x2A }, XMM0, RSI, -SIZE + DATA); // cvtsi2sd
+				m_asm.storeFloat(RSI, -SIZE + DATA, XMM0);
+				m_asm.setType(RSI, -SIZE, TYPE_FLOAT);
+				m_asm.bind(done);
+				break;
+			}
+			case OP_JUMP: m_jumps.push_back({ m_asm.jmp(), operand }); break;
+			case OP_JUMP_IF_FALSE:
+				truthy(index);
+				m_asm.addSp(-SIZE);
+				m_asm.byte(0x84); m_asm.byte(0xC0); // test al, al
+				m_jumps.push_back({ m_asm.jcc(CC_E), operand });
+				break;
+			default: m_asm.exit(index); break; // NEW_ARRAY CALL CALL_BUILTIN RETURN PRINT CONCAT HALT
+		}
+	}
+
+public:
+	FunctionCompiler(const Program& program, const Function& function, Value* globals)
+		: m_program(program), m_function(function), m_globals(globals) {}
+
+	std::vector<uint8_t>& compile(std::vector<size_t>& starts) {
+		m_asm.byte(0xFF); m_asm.byte(0xE2); // jmp rdx, the entry instruction
+		for (size_t i = 0; i < m_function.code.size(); ++i) {
+			starts.push_back(m_asm.size());
+			instruction(m_function.code[i], static_cast<int32_t>(i));
+		}
+		starts.push_back(m_asm.size());
+		m_asm.exit(static_cast<int32_t>(m_function.code.size())); // Never reached, the code ends with RETURN or HALT
+		for (auto [jump, target] : m_jumps) m_asm.patch(jump, starts[target]);
+		for (auto [jump, index] : m_exits) {
+			m_asm.bind(jump);
+			m_asm.exit(index);
+		}
+		return m_asm.code();
+	}
+};
+
+NativeFunction JIT::compile(const Program& program, const Function& function, Value* globals) {
+	std::vector<size_t> starts;
+	FunctionCompiler compiler(program, function, globals);
+	std::vector<uint8_t>& code = compiler.compile(starts);
+
+	NativeFunction native;
+	void* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) return native;
+	std::memcpy(memory, code.data(), code.size());
+	if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC)) {
+		munmap(memory, code.size());
+		return native;
+	}
+	m_blocks.push_back({ memory, code.size() });
+	const uint8_t* start = static_cast<const uint8_t*>(memory);
+	native.code = reinterpret_cast<NativeExit(*)(Value*, Value*, const uint8_t*)>(memory);
+	for (size_t offset : starts) native.targets.push_back(start + offset);
+	return native;
+}
+
+JIT::~JIT() {
+	for (const Block& block : m_blocks) munmap(block.memory, block.size);
+}
+#else
+NativeFunction JIT::compile(const Program&, const Function&, Value*) { return {}; }
+
+JIT::~JIT() {}
+#endif
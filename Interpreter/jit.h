@@ -0,0 +1,63 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bytecode.h"
+
+// Native code needs x86-64 and the System V calling convention. Elsewhere, or with DLANG_NO_JIT
+// defined, compile() gives nothing and the VM only interprets.
+#if defined(__x86_64__) && !defined(_WIN32) && !defined(DLANG_NO_JIT)
+#define DLANG_JIT
+#endif
+
+// When the VM turns functions into machine code
+enum class JitMode {
+	OFF, // Interpret only
+	TIERED, // Compile a function once its calls and loop iterations reach JIT_THRESHOLD
+	FORCE // Compile every function before running
+};
+
+constexpr uint32_t JIT_THRESHOLD = 1000;
+
+// Where native code gave control back: the interpreter carries on at instruction index with stack top sp
+struct NativeExit {
+	Value* sp;
+	int64_t index;
+};
+
+// Machine code of one bytecode function. It works on the VM's own stack and frame, so it can be
+// entered at any instruction and leave at any other, the interpreter doesn't see the difference.
+struct NativeFunction {
+	NativeExit (*code)(Value* base, Value* sp, const uint8_t* target) = nullptr;
+	std::vector<const uint8_t*> targets; // Native address of every instruction
+
+	NativeExit enter(Value* base, Value* sp, size_t index) const { return code(base, sp, targets[index]); }
+};
+
+// Baseline compiler from bytecode to x86-64, one template per opcode, no register allocation.
+// Typed int and float operations, comparisons, jumps, locals, globals and constants run natively.
+// At anything else (calls, returns, print, strings, a generic operation on values other than ints,
+// division by zero, a global read before its declaration) the code leaves before touching the stack
+// and the interpreter runs that instruction, which raises the error where there is one.
+// Every function is in its own mmap'd block, writable while it's filled and executable after.
+class JIT {
+private:
+	struct Block {
+		void* memory;
+		size_t size;
+	};
+
+	std::vector<Block> m_blocks;
+
+public:
+	JIT() = default;
+	JIT(const JIT&) = delete;
+	JIT& operator=(const JIT&) = delete;
+	~JIT();
+
+	// globals is the VM's array, its address is built into the code. Gives no code if it can't compile
+	NativeFunction compile(const Program& program, const Function& function, Value* globals);
+};
+#endif // !JIT_H
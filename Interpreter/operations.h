@@ -0,0 +1,120 @@
+#ifndef OPERATIONS_H
+#define OPERATIONS_H
+
+#include <format>
+#include <span>
+#include "value.h"
+#include "../Parser/AST/ast.h"
+#include "../Parser/Lexer/lexer.h"
+#include "../Parser/Tokens/tokens.h"
+#include "../Error/error.h"
+
+// Semantics of the operators shared by every backend.
+// Backends may take fast paths for int and float operands, but any other combination goes through here.
+
+constexpr int MAX_CALL_DEPTH = 1000; // Deepest recursion before "Stack overflow"
+
+// Array of a literal, the parser made sure its tokens have one type and fit it
+inline DArray* arrayFromLiteral(std::span<Token* const> elements, Heap& heap) {
+	ElementType type = ElementType::INT;
+	if (!elements.empty() && elements[0]->type == TokenType::FLOAT) type = ElementType::FLOAT;
+	else if (!elements.empty() && elements[0]->type == TokenType::STRING) type = ElementType::STRING;
+	DArray array(type, elements.size());
+	for (Token* token : elements) {
+		switch (token->type) {
+			case TokenType::INT: { int64_t value = 0; parseLiteral(token->value, value); array.append(value); break; }
+			case TokenType::FLOAT: { double value = 0; parseLiteral(token->value, value); array.append(value); break; }
+			case TokenType::STRING: array.append(heap.newString(std::string(token->value.substr(1, token->value.size() - 2)))); break;
+			default: raiseError(std::format("SEMANTIC ERROR: Array element {} must be a literal in {}:{}\n", token->value, token->line, token->column));
+		}
+	}
+	return heap.newArray(std::move(array));
+}
+
+// Int + - * / wrap around like the hardware and the array kernels (simd.cpp), never signed overflow.
+// The smallest int divided by -1 gives itself instead of trapping, callers check for a 0 divisor
+inline int64_t wrapAdd(int64_t l, int64_t r) { return static_cast<int64_t>(static_cast<uint64_t>(l) + static_cast<uint64_t>(r)); }
+inline int64_t wrapSub(int64_t l, int64_t r) { return static_cast<int64_t>(static_cast<uint64_t>(l) - static_cast<uint64_t>(r)); }
+inline int64_t wrapMul(int64_t l, int64_t r) { return static_cast<int64_t>(static_cast<uint64_t>(l) * static_cast<uint64_t>(r)); }
+inline int64_t wrapDiv(int64_t l, int64_t r) { return (r == -1) ? wrapSub(0, l) : l / r; }
+
+// + - * /
+inline Value arithmetic(TokenType op, const Value& left, const Value& right, Heap& heap, size_t line, size_t column) {
+	if (op == TokenType::PLUS && left.type == ValueType::STRING && right.type == ValueType::STRING)
+		return Value::fromString(heap.newString(*left.s + *right.s));
+	if (!left.isNumber() || !right.isNumber())
+		raiseError(std::format("RUNTIME ERROR: Unsupported operand types {} and {} in {}:{}\n", valueTypeName(left.type), valueTypeName(right.type), line, column));
+	if (left.type == ValueType::FLOAT || right.type == ValueType::FLOAT) {
+		double l = left.asFloat(), r = right.asFloat();
+		switch (op) {
+			case TokenType::PLUS: return Value::fromFloat(l + r);
+			case TokenType::MINUS: return Value::fromFloat(l - r);
+			case TokenType::MULTIPLY: return Value::fromFloat(l * r);
+			default: return Value::fromFloat(l / r);
+		}
+	}
+	int64_t l = left.asInt(), r = right.asInt();
+	switch (op) {
+		case TokenType::PLUS: return Value::fromInt(wrapAdd(l, r));
+		case TokenType::MINUS: return Value::fromInt(wrapSub(l, r));
+		case TokenType::MULTIPLY: return Value::fromInt(wrapMul(l, r));
+		default:
+			if (r == 0) raiseError(std::format("RUNTIME ERROR: Division by zero in {}:{}\n", line, column));
+			return Value::fromInt(wrapDiv(l, r));
+	}
+}
+
+// == !=
+inline bool valuesEqual(const Value& left, const Value& right) {
+	if (left.isNumber() && right.isNumber()) {
+		if (left.type == ValueType::FLOAT || right.type == ValueType::FLOAT) return left.asFloat() == right.asFloat();
+		return left.asInt() == right.asInt();
+	}
+	if (left.type != right.type) return false;
+	switch (left.type) {
+		case ValueType::STRING: return *left.s == *right.s;
+		case ValueType::ARRAY: {
+			if (left.a->size() != right.a->size()) return false;
+			for (size_t i = 0; i < left.a->size(); ++i)
+				if (!valuesEqual(arrayElement(*left.a, i), arrayElement(*right.a, i))) return false;
+			return true;
+		}
+		default: return true;
+	}
+}
+
+// < > <= >= == !=
+inline Value compare(TokenType op, const Value& left, const Value& right, size_t line, size_t column) {
+	if (op == TokenType::EQUAL_EQUAL) return Value::fromBool(valuesEqual(left, right));
+	if (op == TokenType::NOT_EQUAL) return Value::fromBool(!valuesEqual(left, right));
+	int order = 0;
+	if (left.isNumber() && right.isNumber()) {
+		if (left.type == ValueType::FLOAT || right.type == ValueType::FLOAT) order = (left.asFloat() < right.asFloat()) ? -1 : (left.asFloat() > right.asFloat()) ? 1 : 0;
+		else order = (left.asInt() < right.asInt()) ? -1 : (left.asInt() > right.asInt()) ? 1 : 0;
+	}
+	else if (left.type == ValueType::STRING && right.type == ValueType::STRING) order = left.s->compare(*right.s);
+	else raiseError(std::format("RUNTIME ERROR: Can't compare {} and {} in {}:{}\n", valueTypeName(left.type), valueTypeName(right.type), line, column));
+	switch (op) {
+		case TokenType::LESS: return Value::fromBool(order < 0);
+		case TokenType::GREATER: return Value::fromBool(order > 0);
+		case TokenType::LESS_EQUAL: return Value::fromBool(order <= 0);
+		default: return Value::fromBool(order >= 0);
+	}
+}
+
+// Unary - and +
+inline Value negate(TokenType op, const Value& value, size_t line, size_t column) {
+	if (!value.isNumber())
+		raiseError(std::format("RUNTIME ERROR: Unsupported operand type {} in {}:{}\n", valueTypeName(value.type), line, column));
+	if (value.type == ValueType::FLOAT) return Value::fromFloat((op == TokenType::MINUS) ? -value.f : value.f);
+	return Value::fromInt((op == TokenType::MINUS) ? wrapSub(0, value.asInt()) : value.asInt());
+}
+
+// ++ --
+inline Value step(const Value& value, int64_t delta, size_t line, size_t column) {
+	if (value.type == ValueType::FLOAT) return Value::fromFloat(value.f + delta);
+	if (value.type == ValueType::INT) return Value::fromInt(wrapAdd(value.i, delta));
+	raiseError(std::format("RUNTIME ERROR: Can't increment or decrement {} in {}:{}\n", valueTypeName(value.type), line, column));
+	return value;
+}
+#endif // !OPERATIONS_H
@@ -0,0 +1,137 @@
+#include "resolver.h"
+#include "../Error/error.h"
+
+// Main function
+void Resolver::resolve(const std::vector<AST*>& ast) {
+	m_locals.clear();
+	m_globals.clear();
+	m_function = nullptr;
+	m_depth = 0;
+
+	for (AST* node : ast)
+		if (node && !nodeCast<FuncNode>(node)) resolveStatement(node);
+	for (AST* node : ast)
+		if (FuncNode* func = nodeCast<FuncNode>(node)) resolveFunction(func);
+}
+
+void Resolver::declare(EmptyVarDeclNode* decl) {
+	IdNode* identifier = decl->identifier;
+	Token* id = identifier->identifier;
+	identifier->declaration = decl;
+	if (!m_function && m_depth == 0) {
+		if (m_globals.count(identifier->symbol))
+			raiseError(std::format("SEMANTIC ERROR: Variable {} is already declared in {}:{}\n", id->value, id->line, id->column));
+		identifier->is_global = true;
+		identifier->slot = static_cast<int32_t>(m_globals.size());
+		m_globals[identifier->symbol] = decl;
+		return;
+	}
+	for (auto it = m_locals.rbegin(); it != m_locals.rend() && it->depth == m_depth; ++it)
+		if (it->symbol == identifier->symbol)
+			raiseError(std::format("SEMANTIC ERROR: Variable {} is already declared in {}:{}\n", id->value, id->line, id->column));
+	identifier->is_global = false;
+	identifier->slot = static_cast<int32_t>(m_locals.size());
+	m_locals.push_back({ identifier->symbol, m_depth, decl });
+	if (m_function && identifier->slot + 1 > m_function->num_locals) m_function->num_locals = identifier->slot + 1;
+}
+
+// Innermost local first, then globals
+void Resolver::resolveVariable(IdNode* identifier) {
+	for (size_t slot = m_locals.size(); slot-- > 0;) {
+		if (m_locals[slot].symbol != identifier->symbol) continue;
+		identifier->is_global = false;
+		identifier->slot = static_cast<int32_t>(slot);
+		identifier->declaration = m_locals[slot].decl;
+		return;
+	}
+	auto global = m_globals.find(identifier->symbol);
+	if (global == m_globals.end()) {
+		Token* id = identifier->identifier;
+		raiseError(std::format("SEMANTIC ERROR: Undefined variable {} in {}:{}\n", id->value, id->line, id->column));
+	}
+	identifier->is_global = true;
+	identifier->slot = global->second->identifier->slot;
+	identifier->declaration = global->second;
+}
+
+void Resolver::resolveWrite(IdNode* identifier, Token* position, const char* action) {
+	resolveVariable(identifier);
+	if (identifier->declaration->key_word->type == TokenType::CONST_KEYWORD)
+		raiseError(std::format("SEMANTIC ERROR: Can't {} constant {} in {}:{}\n", action, identifier->identifier->value, position->line, position->column));
+}
+
+void Resolver::resolveStatement(AST* ast) {
+	if (!ast) return;
+	if (FuncNode* func = nodeCast<FuncNode>(ast))
+		raiseError(std::format("SEMANTIC ERROR: Function {} must be declared at top level in {}:{}\n",
+			func->func_name->identifier->value, func->func_name->identifier->line, func->func_name->identifier->column));
+	visit(ast);
+}
+
+void Resolver::resolveFunction(FuncNode* node) {
+	m_function = node;
+	m_locals.clear();
+	node->num_locals = 0;
+	++m_depth;
+	visit(node->params);
+	visit(node->code_to_execute);
+	--m_depth;
+	m_function = nullptr;
+}
+
+void Resolver::visit(UnOpNode* node) {
+	Token* op = node->operation;
+	if (op->type != TokenType::INCREMENT && op->type != TokenType::DECREMENT) {
+		visit(node->right);
+		return;
+	}
+	IdNode* id = nodeCast<IdNode>(node->right);
+	if (!id) raiseError(std::format("SEMANTIC ERROR: Operand of {} must be a variable in {}:{}\n", op->value, op->line, op->column));
+	resolveWrite(id, op, "modify");
+}
+
+void Resolver::visit(BinOpNode* node) {
+	visit(node->left);
+	visit(node->right);
+}
+
+void Resolver::visit(FullVarDeclNode* node) {
+	visit(node->expr);
+	declare(node->declaration);
+}
+
+void Resolver::visit(ReasignVarNode* node) {
+	resolveWrite(node->identifier, node->assign, "assign to");
+	visit(node->expr);
+}
+
+void Resolver::visit(BlockOfCodeNode* node) {
+	++m_depth;
+	for (AST* ast : node->list) resolveStatement(ast);
+	--m_depth;
+	while (!m_locals.empty() && m_locals.back().depth > m_depth) m_locals.pop_back();
+}
+
+void Resolver::visit(IfStmtNode* node) {
+	visit(node->condition);
+	visit(node->code_to_execute);
+}
+
+void Resolver::visit(WhileStmtNode* node) {
+	visit(node->condition);
+	visit(node->code_to_execute);
+}
+
+void Resolver::visit(FuncParamNode* node) {
+	for (EmptyVarDeclNode* param : node->params) declare(param);
+}
+
+void Resolver::visit(IncDecNode* node) { resolveWrite(node->identifier, node->operation, "modify"); }
+
+void Resolver::visit(FuncCallNode* node) {
+	for (AST* arg : node->args) visit(arg);
+}
+
+void Resolver::visit(ReturnStmtNode* node) {
+	if (node->expr) visit(node->expr);
+}
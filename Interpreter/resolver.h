@@ -0,0 +1,60 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <unordered_map>
+#include <vector>
+#include "../Parser/AST/ast.h"
+
+// Binds every variable use to its declaration before anything runs, so the backends index arrays
+// instead of looking names up. Top level declarations get global slots in the order they appear.
+// Anything else gets a slot in its frame: the function's, or the top level code's for its blocks.
+// Parameters come first, and a block's slots are reused after it ends.
+// Each IdNode of a variable gets its slot, is_global and declaration, and each FuncNode gets num_locals.
+//
+// Raises the name errors: undefined or redeclared variables, writes to constants, ++ of a non variable.
+// The walk is in the compiler's order (top level code, then the functions), so every function sees
+// all the globals and the top level code only the ones declared above.
+class Resolver {
+private:
+	struct Local {
+		SymbolId symbol;
+		int depth;
+		EmptyVarDeclNode* decl;
+	};
+
+	std::vector<Local> m_locals; // Index is the slot
+	std::unordered_map<SymbolId, EmptyVarDeclNode*> m_globals;
+	FuncNode* m_function = nullptr; // Being resolved, null at top level
+	int m_depth = 0;
+
+private:
+	void declare(EmptyVarDeclNode* decl);
+	void resolveVariable(IdNode* identifier);
+	void resolveWrite(IdNode* identifier, Token* position, const char* action); // Also rejects constants
+	void resolveStatement(AST* ast);
+	void resolveFunction(FuncNode* node);
+
+	void visit(AST* ast) { dispatch(ast, [this](auto* node) { visit(node); }); } // Switch on the kind, then the overload below
+	void visit(IntNode*) {}
+	void visit(FloatNode*) {}
+	void visit(StrNode*) {}
+	void visit(ArrayNode*) {}
+	void visit(IdNode* node) { resolveVariable(node); }
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node) { declare(node); }
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node) { resolveFunction(node); }
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	void resolve(const std::vector<AST*>& ast); // Raises the first error found
+};
+#endif // !RESOLVER_H
@@ -1,33 +1,179 @@
 #include <iostream>
-#include <fstream>
+#include <format>
+#include <cstdlib>
+#include <cstring>
 #include "interpreter.h"
+#include "ast_cache.h"
+#include "batch.h"
+#include "../Parser/AST/ast_dumper.h"
 #include "../Error/error.h"
 
-std::string readFromFile(const std::string& file_name) {
-	std::ifstream file(file_name);
-	if (!file.is_open()) {
-		std::cerr << "Cant't find file: " << file_name << std::endl;
-		exit(1);
-	}
-	std::string temp;
-	std::string line;
-	while (std::getline(file, line))
-		temp += line + "\n";
-	return temp;
+enum class Mode { RUN, TREE_WALK, COMPARE, PRINT_AST, DUMP_JSON, DUMP_BINARY, PRINT_BYTECODE, PRINT_C, AOT, CHECK, CHECK_AOT };
+
+void printUsage() {
+	std::cerr << "Usage: DLang [--ast | --ast-json | --ast-binary | --bytecode | --emit-c | --aot | --tree-walk | --compare | --check] [-j threads] <file | ->...\n"
+		<< "  --ast        print the syntax tree\n"
+		<< "  --ast-json   dump the syntax tree as JSON, one array per file\n"
+		<< "  --ast-binary dump the syntax tree in the compact binary format of ast_dumper.h\n"
+		<< "  --bytecode   print the compiled bytecode\n"
+		<< "  --emit-c     print the script translated to a standalone C program\n"
+		<< "  --aot        translate to C and build a native executable with the system C compiler ($CC, $CFLAGS).\n"
+		<< "               It is named after the script without .dl, the C file is kept next to it with .c added.\n"
+		<< "               The array builtins (len, get, set, push, slice, fill, range, sum, dot, ...) have no C version,\n"
+		<< "               a script calling one is rejected and only runs in the VM\n"
+		<< "  --shared     with --aot, build a shared object exporting int dlang_main(void) instead\n"
+		<< "  -o output    with --aot, name of the executable or shared object, for a single script\n"
+		<< "  --tree-walk  run with the reference tree walking interpreter\n"
+		<< "  --compare    run with the VM and the tree walker and compare the results\n"
+		<< "  --check      only lex, parse, resolve names and check types, report the errors.\n"
+		<< "               With --aot also translate to C, reporting what the C backend rejects, without building\n"
+		<< "  -j threads   threads parsing several files, one per core by default.\n"
+		<< "               A single large file is lexed in parallel chunks when threads is above 1\n"
+		<< "  --jit        compile every function to machine code before running\n"
+		<< "  --no-jit     only interpret bytecode. By default functions are compiled once they get hot\n"
+		<< "  --no-fold    skip constant folding\n"
+		<< "  --fold-stats print how many nodes constant folding removed\n"
+		<< "  --no-cache   always parse, don't read or write the tree cache ($DLANG_CACHE_DIR or ~/.cache/dlang)\n"
+		<< "  --stats      print the time and arena bytes of every phase and the tokens and nodes per kind\n"
+		<< "Several files are parsed in parallel, then handled one by one in the order given.\n";
+}
+
+// Where --aot puts the build of a script: script.dl gives script, or script.so with --shared
+std::string nativeOutput(const std::string& path, bool shared) {
+	std::filesystem::path output = (path == "-") ? std::filesystem::path("a") : std::filesystem::path(path);
+	if (output.extension() == ".dl") output.replace_extension();
+	else if (!shared) output += ".out";
+	if (shared) output += ".so";
+	return output.string();
 }
 
-int main() {
-	Lexer lexer;
-	Parser parser;
+// Print, compile or run one parsed script, returns the exit status
+int runUnit(CompilationUnit& unit, Mode mode, JitMode jit, const std::string& output, bool shared) {
 	ASTPrinter printer;
+	Interpreter interpreter(std::cout, &unit.stats, jit);
+	switch (mode) {
+		case Mode::CHECK: // The passes run and compile start with, a tree any of them rejects fails the check
+			interpreter.check(unit.ast);
+			break;
+		case Mode::CHECK_AOT: // Everything --aot does before the C compiler runs
+			interpreter.emitC(unit.ast);
+			break;
+		case Mode::PRINT_AST: {
+			ScopedTimer timer(&unit.stats, Phase::PRINT);
+			printer.print(unit.ast);
+			break;
+		}
+		case Mode::DUMP_JSON: {
+			ScopedTimer timer(&unit.stats, Phase::PRINT);
+			JSONDumper().dump(unit.ast);
+			break;
+		}
+		case Mode::DUMP_BINARY: {
+			ScopedTimer timer(&unit.stats, Phase::PRINT);
+			BinaryDumper().dump(unit.ast);
+			break;
+		}
+		case Mode::PRINT_BYTECODE: {
+			Program program;
+			interpreter.compile(unit.ast, program);
+			ScopedTimer timer(&unit.stats, Phase::PRINT);
+			std::cout << disassemble(program);
+			break;
+		}
+		case Mode::PRINT_C: {
+			std::string code = interpreter.emitC(unit.ast);
+			ScopedTimer timer(&unit.stats, Phase::PRINT);
+			std::cout << code;
+			break;
+		}
+		case Mode::AOT:
+			interpreter.buildNative(unit.ast, output.empty() ? nativeOutput(unit.path, shared) : output, shared);
+			break;
+		case Mode::COMPARE:
+			return interpreter.compare(unit.ast, std::cout) ? 0 : 2;
+		case Mode::TREE_WALK:
+			interpreter.run(unit.ast, Backend::TREE_WALKER);
+			break;
+		default:
+			interpreter.run(unit.ast);
+	}
+	return 0;
+}
 
-	try {
-		std::vector<Token*> tokens = lexer.lex(readFromFile("path_file"));
-		std::vector<AST*> data = parser.parse(tokens);
-		for (AST* ast : data) if (ast) printer.print(ast);
+int main(int argc, char** argv) {
+	Mode mode = Mode::RUN;
+	std::vector<std::string> paths;
+	size_t threads = 0;
+	bool fold_stats = false, use_cache = true, shared = false;
+	JitMode jit = JitMode::TIERED;
+	std::string output;
+	ParseOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--ast")) mode = Mode::PRINT_AST;
+		else if (!std::strcmp(argv[i], "--ast-json")) mode = Mode::DUMP_JSON;
+		else if (!std::strcmp(argv[i], "--ast-binary")) mode = Mode::DUMP_BINARY;
+		else if (!std::strcmp(argv[i], "--bytecode")) mode = Mode::PRINT_BYTECODE;
+		else if (!std::strcmp(argv[i], "--emit-c")) mode = Mode::PRINT_C;
+		else if (!std::strcmp(argv[i], "--aot")) mode = (mode == Mode::CHECK) ? Mode::CHECK_AOT : Mode::AOT;
+		else if (!std::strcmp(argv[i], "--shared")) shared = true;
+		else if (!std::strcmp(argv[i], "-o") && i + 1 < argc) output = argv[++i];
+		else if (!std::strcmp(argv[i], "--tree-walk")) mode = Mode::TREE_WALK;
+		else if (!std::strcmp(argv[i], "--compare")) mode = Mode::COMPARE;
+		else if (!std::strcmp(argv[i], "--check")) mode = (mode == Mode::AOT) ? Mode::CHECK_AOT : Mode::CHECK;
+		else if (!std::strcmp(argv[i], "--jit")) jit = JitMode::FORCE;
+		else if (!std::strcmp(argv[i], "--no-jit")) jit = JitMode::OFF;
+		else if (!std::strcmp(argv[i], "--no-fold")) options.fold = false;
+		else if (!std::strcmp(argv[i], "--fold-stats")) fold_stats = true;
+		else if (!std::strcmp(argv[i], "--no-cache")) use_cache = false;
+		else if (!std::strcmp(argv[i], "--stats")) options.stats = true;
+		else if (!std::strcmp(argv[i], "-j") && i + 1 < argc) threads = std::strtoul(argv[++i], nullptr, 10);
+		else if (argv[i][0] != '-' || !argv[i][1]) paths.push_back(argv[i]); // "-" reads stdin
+		else { printUsage(); return 1; }
 	}
-	catch (std::exception& err) {
-		std::cout << err.what();
+	if (paths.empty() || (!output.empty() && paths.size() > 1)) { printUsage(); return 1; }
+
+	std::unique_ptr<ASTCache> cache;
+	if (std::filesystem::path dir = ASTCache::defaultDirectory(); use_cache && !dir.empty()) cache = std::make_unique<ASTCache>(dir);
+	options.cache = cache.get();
+
+	// Each unit owns its source, arena and symbols: tokens and AST of a script are freed at once on exit
+	std::vector<std::unique_ptr<CompilationUnit>> units;
+	bool batch = paths.size() > 1;
+	if (!batch) {
+		units.push_back(std::make_unique<CompilationUnit>(paths[0]));
+		std::unique_ptr<ThreadPool> lex_pool;
+		if (threads > 1) lex_pool = std::make_unique<ThreadPool>(threads);
+		options.lex_pool = lex_pool.get();
+		parseUnit(*units[0], options);
 	}
-	return 0;
-}
\ No newline at end of file
+	else {
+		ThreadPool pool(threads ? threads : std::thread::hardware_concurrency());
+		units = parseFiles(paths, pool, options);
+	}
+
+	// Diagnostics and output follow the order of the command line, not the order files finished in
+	int status = 0;
+	size_t failed = 0;
+	for (auto& unit : units) {
+		std::string prefix = batch ? unit->path + ": " : "";
+		if (fold_stats && unit->error.empty()) std::cerr << std::format("{}folded {} operators, simplified {} identities, removed {} branches\n",
+			prefix, unit->fold_stats.folded, unit->fold_stats.simplified, unit->fold_stats.branches);
+		std::string error = unit->error;
+		if (error.empty()) {
+			try { status = std::max(status, runUnit(*unit, mode, jit, output, shared)); continue; }
+			catch (std::exception& err) { error = err.what(); }
+		}
+		++failed;
+		status = std::max(status, 1);
+		if (batch && error.back() != '\n') error += '\n';
+		(unit->found ? std::cout : std::cerr) << prefix << error;
+	}
+	if (batch && (mode == Mode::CHECK || mode == Mode::CHECK_AOT)) std::cerr << std::format("checked {} files, {} with errors\n", units.size(), failed);
+	if (options.stats) {
+		// Phase times of a batch are summed over its files, with several threads they add up to more than the wall time
+		Stats total;
+		for (auto& unit : units) total.merge(unit->stats);
+		total.report(std::cerr);
+	}
+	return status;
+}
@@ -0,0 +1,244 @@
+#include "tree_walker.h"
+#include "builtins.h"
+#include "operations.h"
+
+// Main function
+void TreeWalker::run(const std::vector<AST*>& ast) {
+	m_globals.clear();
+	m_main.clear();
+	m_global_order.clear();
+	m_functions.clear();
+	m_frame = &m_main;
+	m_returning = false;
+	m_call_depth = 0;
+
+	// Functions are hoisted, so a call may come before the declaration
+	for (AST* node : ast) {
+		FuncNode* func = nodeCast<FuncNode>(node);
+		if (!func) continue;
+		Token* name = func->func_name->identifier;
+		if (m_functions.count(func->func_name->symbol))
+			raiseError(std::format("SEMANTIC ERROR: Function {} is already declared in {}:{}\n", name->value, name->line, name->column));
+		m_functions[func->func_name->symbol] = func;
+	}
+	// Every top level declaration has a slot, reached or not. An empty one is used before its declaration
+	for (AST* node : ast)
+		if (nodeCast<EmptyVarDeclNode>(node) || nodeCast<FullVarDeclNode>(node)) m_globals.emplace_back();
+	for (AST* node : ast)
+		if (node && !nodeCast<FuncNode>(node)) execute(node);
+}
+
+std::vector<std::pair<std::string, Value>> TreeWalker::globals() const {
+	std::vector<std::pair<std::string, Value>> temp;
+	for (IdNode* id : m_global_order) temp.push_back({ std::string(id->identifier->value), m_globals[id->slot].value });
+	return temp;
+}
+
+Value TreeWalker::evaluate(AST* ast) {
+	visit(ast);
+	return m_result;
+}
+
+void TreeWalker::execute(AST* ast) {
+	if (!ast) return;
+	if (FuncNode* func = nodeCast<FuncNode>(ast))
+		raiseError(std::format("SEMANTIC ERROR: Function {} must be declared at top level in {}:{}\n",
+			func->func_name->identifier->value, func->func_name->identifier->line, func->func_name->identifier->column));
+	visit(ast);
+}
+
+TreeWalker::Variable& TreeWalker::lookup(IdNode* identifier) {
+	if (!identifier->is_global) return (*m_frame)[identifier->slot];
+	Variable& var = m_globals[identifier->slot];
+	if (var.value.type == ValueType::NONE) {
+		Token* id = identifier->identifier;
+		raiseError(std::format("RUNTIME ERROR: Variable {} used before declaration in {}:{}\n", id->value, id->line, id->column));
+	}
+	return var;
+}
+
+// Blocks of the top level code may need m_main to grow, a function's frame is sized on the call
+void TreeWalker::declare(IdNode* identifier, Token* var_type, Value value) {
+	Frame& frame = identifier->is_global ? m_globals : *m_frame;
+	size_t slot = static_cast<size_t>(identifier->slot);
+	if (slot >= frame.size()) frame.resize(slot + 1);
+	ValueType type = valueTypeFromName(var_type->value);
+	frame[slot] = { coerce(value, type), type };
+	if (identifier->is_global) m_global_order.push_back(identifier);
+}
+
+void TreeWalker::visit(IntNode* node) { m_result = Value::fromInt(node->value); }
+
+void TreeWalker::visit(FloatNode* node) { m_result = Value::fromFloat(node->value); }
+
+void TreeWalker::visit(StrNode* node) {
+	std::string str(node->value);
+	if (!str.empty() && str.front() == '"') str.erase(0, 1);
+	if (!str.empty() && str.back() == '"') str.pop_back();
+	m_result = Value::fromString(m_heap.newString(std::move(str)));
+}
+
+void TreeWalker::visit(ArrayNode* node) {
+	m_result = Value::fromArray(arrayFromLiteral(node->elements, m_heap));
+}
+
+void TreeWalker::visit(IdNode* node) { m_result = lookup(node).value; }
+
+void TreeWalker::visit(UnOpNode* node) {
+	Token* op = node->operation;
+	switch (op->type) {
+		case TokenType::INCREMENT:
+		case TokenType::DECREMENT: { // id++ as expression gives the old value
+			Variable& var = lookup(nodeCast<IdNode>(node->right));
+			m_result = var.value;
+			var.value = step(var.value, (op->type == TokenType::INCREMENT) ? 1 : -1, op->line, op->column);
+			return;
+		}
+		case TokenType::MINUS:
+		case TokenType::PLUS:
+			m_result = negate(op->type, evaluate(node->right), op->line, op->column);
+			return;
+		default:
+			m_result = Value::fromBool(!isTruthy(evaluate(node->right)));
+	}
+}
+
+void TreeWalker::visit(BinOpNode* node) {
+	Token* op = node->operation;
+	// && and || are short circuit
+	if (op->type == TokenType::LOGIC_AND) {
+		m_result = Value::fromBool(isTruthy(evaluate(node->left)) && isTruthy(evaluate(node->right)));
+		return;
+	}
+	if (op->type == TokenType::LOGIC_OR) {
+		m_result = Value::fromBool(isTruthy(evaluate(node->left)) || isTruthy(evaluate(node->right)));
+		return;
+	}
+	Value left = evaluate(node->left);
+	Value right = evaluate(node->right);
+	switch (op->type) {
+		case TokenType::PLUS:
+		case TokenType::MINUS:
+		case TokenType::MULTIPLY:
+		case TokenType::DIVIDE:
+			m_result = arithmetic(op->type, left, right, m_heap, op->line, op->column);
+			break;
+		case TokenType::LESS:
+		case TokenType::GREATER:
+		case TokenType::LESS_EQUAL:
+		case TokenType::GREATER_EQUAL:
+		case TokenType::EQUAL_EQUAL:
+		case TokenType::NOT_EQUAL:
+			m_result = compare(op->type, left, right, op->line, op->column);
+			break;
+		default: raiseError(std::format("SEMANTIC ERROR: Unknown operation {} in {}:{}\n", op->value, op->line, op->column));
+	}
+}
+
+void TreeWalker::visit(EmptyVarDeclNode* node) {
+	declare(node->identifier, node->var_type, defaultValue(valueTypeFromName(node->var_type->value), m_heap));
+}
+
+void TreeWalker::visit(FullVarDeclNode* node) {
+	Value value = evaluate(node->expr);
+	declare(node->declaration->identifier, node->declaration->var_type, value);
+}
+
+void TreeWalker::visit(ReasignVarNode* node) {
+	Token* assign = node->assign;
+	Variable& var = lookup(node->identifier);
+	Value current = var.value;
+	Value value = evaluate(node->expr);
+	switch (assign->type) {
+		case TokenType::PLUS_EQUAL: value = arithmetic(TokenType::PLUS, current, value, m_heap, assign->line, assign->column); break;
+		case TokenType::MINUS_EQUAL: value = arithmetic(TokenType::MINUS, current, value, m_heap, assign->line, assign->column); break;
+		case TokenType::MULTIPLY_EQUAL: value = arithmetic(TokenType::MULTIPLY, current, value, m_heap, assign->line, assign->column); break;
+		case TokenType::DIVIDE_EQUAL: value = arithmetic(TokenType::DIVIDE, current, value, m_heap, assign->line, assign->column); break;
+		default: break;
+	}
+	var.value = coerce(value, var.type);
+}
+
+void TreeWalker::visit(BlockOfCodeNode* node) {
+	for (AST* ast : node->list) {
+		execute(ast);
+		if (m_returning) break;
+	}
+}
+
+void TreeWalker::visit(IfStmtNode* node) {
+	if (isTruthy(evaluate(node->condition))) visit(node->code_to_execute);
+}
+
+void TreeWalker::visit(WhileStmtNode* node) {
+	while (!m_returning && isTruthy(evaluate(node->condition))) visit(node->code_to_execute);
+}
+
+void TreeWalker::visit(FuncNode*) {}
+
+void TreeWalker::visit(FuncParamNode*) {}
+
+void TreeWalker::visit(IncDecNode* node) {
+	Token* op = node->operation;
+	Variable& var = lookup(node->identifier);
+	var.value = step(var.value, (op->type == TokenType::INCREMENT) ? 1 : -1, op->line, op->column);
+}
+
+void TreeWalker::visit(FuncCallNode* node) {
+	Token* name = node->func_name->identifier;
+	auto it = m_functions.find(node->func_name->symbol);
+	// print is builtin unless the script declares its own
+	if (it == m_functions.end() && name->value == "print") {
+		std::vector<Value> args;
+		for (AST* arg : node->args) args.push_back(evaluate(arg));
+		for (size_t i = 0; i < args.size(); ++i) m_out << (i ? " " : "") << valueToString(args[i]);
+		m_out << "\n";
+		m_result = Value();
+		return;
+	}
+	int index = (it == m_functions.end()) ? findBuiltin(name->value) : -1;
+	if (index >= 0) {
+		if (static_cast<int>(node->args.size()) != builtin(index).arity)
+			raiseError(std::format("SEMANTIC ERROR: Function {} takes {} arguments but {} were given in {}:{}\n",
+				name->value, builtin(index).arity, node->args.size(), name->line, name->column));
+		Value args[MAX_BUILTIN_ARITY];
+		for (size_t i = 0; i < node->args.size(); ++i) args[i] = evaluate(node->args[i]);
+		m_result = callBuiltin(index, args, m_heap, name->line, name->column);
+		return;
+	}
+	if (it == m_functions.end())
+		raiseError(std::format("SEMANTIC ERROR: Undefined function {} in {}:{}\n", name->value, name->line, name->column));
+	FuncNode* func = it->second;
+	std::span<EmptyVarDeclNode*> params = func->params->params;
+	if (node->args.size() != params.size())
+		raiseError(std::format("SEMANTIC ERROR: Function {} takes {} arguments but {} were given in {}:{}\n",
+			name->value, params.size(), node->args.size(), name->line, name->column));
+	if (m_call_depth >= MAX_CALL_DEPTH)
+		raiseError(std::format("RUNTIME ERROR: Stack overflow in {}:{}\n", name->line, name->column));
+
+	std::vector<Value> args;
+	for (AST* arg : node->args) args.push_back(evaluate(arg));
+
+	// Function body sees its parameters and the globals only
+	Frame frame(func->num_locals);
+	Frame* caller = m_frame;
+	m_frame = &frame;
+	for (size_t i = 0; i < params.size(); ++i)
+		declare(params[i]->identifier, params[i]->var_type, args[i]);
+	++m_call_depth;
+	m_returning = false;
+	visit(func->code_to_execute);
+	ValueType return_type = valueTypeFromName(func->func_return_type->value);
+	Value result = m_returning ? m_result : defaultValue(return_type, m_heap);
+	m_returning = false;
+	--m_call_depth;
+	m_frame = caller;
+	m_result = coerce(result, return_type);
+}
+
+void TreeWalker::visit(ReturnStmtNode* node) {
+	if (m_call_depth == 0)
+		raiseError(std::format("SEMANTIC ERROR: Return outside of function in {}:{}\n", node->key_word->line, node->key_word->column));
+	m_result = node->expr ? evaluate(node->expr) : Value();
+	m_returning = true;
+}
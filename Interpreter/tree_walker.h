@@ -0,0 +1,64 @@
+#ifndef TREE_WALKER_H
+#define TREE_WALKER_H
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "value.h"
+#include "../Parser/AST/ast.h"
+
+// Reference interpreter that evaluates the AST directly.
+// It is slow on purpose (recursive evaluation, no compilation) and is used to check the VM.
+// The tree must have been through the Resolver, variables live in the slots it gave them.
+class TreeWalker {
+private:
+	struct Variable {
+		Value value;
+		ValueType type;
+	};
+	using Frame = std::vector<Variable>; // Index is the slot
+
+	Heap m_heap;
+	std::ostream& m_out;
+	Frame m_globals;
+	Frame m_main; // Locals of the top level code's blocks, grows as they are declared
+	Frame* m_frame = &m_main;
+	std::vector<IdNode*> m_global_order; // globals in declaration order
+	std::unordered_map<SymbolId, FuncNode*> m_functions;
+	Value m_result; // value of the last evaluated expression
+	bool m_returning = false;
+	int m_call_depth = 0;
+
+private:
+	Value evaluate(AST* ast);
+	Variable& lookup(IdNode* identifier);
+	void declare(IdNode* identifier, Token* var_type, Value value);
+	void execute(AST* ast);
+
+	void visit(AST* ast) { dispatch(ast, [this](auto* node) { visit(node); }); } // Switch on the kind, then the overload below
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	TreeWalker(std::ostream& out = std::cout): m_out(out) {}
+	void run(const std::vector<AST*>& ast);
+	std::vector<std::pair<std::string, Value>> globals() const;
+};
+#endif // !TREE_WALKER_H
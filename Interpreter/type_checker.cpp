@@ -0,0 +1,240 @@
+#include "type_checker.h"
+#include "builtins.h"
+#include "../Error/error.h"
+
+static bool isNumeric(ValueType type) { return type == ValueType::INT || type == ValueType::FLOAT || type == ValueType::BOOL; }
+
+// What a variable, parameter or return value of type target may be given, as the backends accept it.
+// int and float convert into each other on the way and bool into both (see coerce), a bool keeps an int.
+// A float is never given to a bool: the bool would hold the float and arithmetic on it expects an int.
+static bool assignable(ValueType target, ValueType source) {
+	if (target == ValueType::NONE || source == ValueType::NONE || target == source) return true;
+	if (target == ValueType::INT || target == ValueType::FLOAT) return isNumeric(source);
+	return target == ValueType::BOOL && source == ValueType::INT;
+}
+
+// Main function
+void TypeChecker::check(const std::vector<AST*>& ast) {
+	m_functions.clear();
+	m_dynamic.clear();
+
+	std::vector<FuncNode*> functions;
+	for (AST* node : ast) {
+		FuncNode* func = nodeCast<FuncNode>(node);
+		if (!func) continue;
+		Token* name = func->func_name->identifier;
+		if (m_functions.count(func->func_name->symbol))
+			raiseError(std::format("SEMANTIC ERROR: Function {} is already declared in {}:{}\n", name->value, name->line, name->column));
+		m_functions[func->func_name->symbol] = func;
+		functions.push_back(func);
+	}
+	// Reading a dynamic declaration gives NONE, which can make more of them
+	size_t dynamic;
+	do {
+		dynamic = m_dynamic.size();
+		walk(ast, functions);
+	} while (m_dynamic.size() != dynamic);
+}
+
+void TypeChecker::walk(const std::vector<AST*>& ast, const std::vector<FuncNode*>& functions) {
+	for (AST* node : ast)
+		if (node && !nodeCast<FuncNode>(node)) visit(node);
+	for (FuncNode* func : functions) visit(func);
+}
+
+ValueType TypeChecker::typeOf(AST* expr) {
+	visit(expr);
+	return m_type;
+}
+
+ValueType TypeChecker::readType(IdNode* variable) {
+	EmptyVarDeclNode* decl = variable->declaration;
+	return m_dynamic.count(decl) ? ValueType::NONE : valueTypeFromName(decl->var_type->value);
+}
+
+void TypeChecker::checkAssign(EmptyVarDeclNode* target, ValueType source, Token* position) {
+	ValueType type = valueTypeFromName(target->var_type->value);
+	if (!assignable(type, source))
+		raiseError(std::format("TYPE ERROR: Can't assign {} to {} of type {} in {}:{}\n",
+			valueTypeName(source), target->identifier->identifier->value, valueTypeName(type), position->line, position->column));
+	if (source == ValueType::NONE && type != ValueType::NONE) m_dynamic.insert(target);
+}
+
+ValueType TypeChecker::arithmeticType(ValueType left, ValueType right, Token* position) {
+	if (left == ValueType::NONE || right == ValueType::NONE) return ValueType::NONE;
+	if (position->type == TokenType::PLUS && left == ValueType::STRING && right == ValueType::STRING) return ValueType::STRING;
+	if (!isNumeric(left) || !isNumeric(right))
+		raiseError(std::format("TYPE ERROR: Unsupported operand types {} and {} in {}:{}\n", valueTypeName(left), valueTypeName(right), position->line, position->column));
+	return (left == ValueType::FLOAT || right == ValueType::FLOAT) ? ValueType::FLOAT : ValueType::INT;
+}
+
+void TypeChecker::visit(FuncNode* node) {
+	m_function = node;
+	visit(node->code_to_execute);
+	m_function = nullptr;
+}
+
+void TypeChecker::visit(IntNode*) { m_type = ValueType::INT; }
+
+void TypeChecker::visit(FloatNode*) { m_type = ValueType::FLOAT; }
+
+void TypeChecker::visit(StrNode*) { m_type = ValueType::STRING; }
+
+void TypeChecker::visit(ArrayNode*) { m_type = ValueType::ARRAY; }
+
+void TypeChecker::visit(IdNode* node) { m_type = readType(node); }
+
+void TypeChecker::visit(UnOpNode* node) {
+	Token* op = node->operation;
+	switch (op->type) {
+		case TokenType::INCREMENT:
+		case TokenType::DECREMENT: {
+			node->operand_type = m_type = readType(nodeCast<IdNode>(node->right));
+			if (m_type != ValueType::INT && m_type != ValueType::FLOAT && m_type != ValueType::NONE)
+				raiseError(std::format("TYPE ERROR: Can't increment or decrement {} in {}:{}\n", valueTypeName(m_type), op->line, op->column));
+			return;
+		}
+		case TokenType::MINUS:
+		case TokenType::PLUS: {
+			ValueType operand = node->operand_type = typeOf(node->right);
+			if (operand != ValueType::NONE && !isNumeric(operand))
+				raiseError(std::format("TYPE ERROR: Unsupported operand type {} in {}:{}\n", valueTypeName(operand), op->line, op->column));
+			m_type = (operand == ValueType::NONE || operand == ValueType::FLOAT) ? operand : ValueType::INT;
+			return;
+		}
+		default:
+			node->operand_type = typeOf(node->right);
+			m_type = ValueType::BOOL;
+	}
+}
+
+void TypeChecker::visit(BinOpNode* node) {
+	Token* op = node->operation;
+	ValueType left = node->left_type = typeOf(node->left);
+	ValueType right = node->right_type = typeOf(node->right);
+	switch (op->type) {
+		case TokenType::PLUS:
+		case TokenType::MINUS:
+		case TokenType::MULTIPLY:
+		case TokenType::DIVIDE:
+			m_type = arithmeticType(left, right, op);
+			break;
+		case TokenType::LESS:
+		case TokenType::GREATER:
+		case TokenType::LESS_EQUAL:
+		case TokenType::GREATER_EQUAL: {
+			bool known = left != ValueType::NONE && right != ValueType::NONE;
+			bool ordered = (isNumeric(left) && isNumeric(right)) || (left == ValueType::STRING && right == ValueType::STRING);
+			if (known && !ordered)
+				raiseError(std::format("TYPE ERROR: Can't compare {} and {} in {}:{}\n", valueTypeName(left), valueTypeName(right), op->line, op->column));
+			m_type = ValueType::BOOL;
+			break;
+		}
+		case TokenType::EQUAL_EQUAL:
+		case TokenType::NOT_EQUAL:
+		case TokenType::LOGIC_AND:
+		case TokenType::LOGIC_OR:
+			m_type = ValueType::BOOL;
+			break;
+		default: raiseError(std::format("SEMANTIC ERROR: Unknown operation {} in {}:{}\n", op->value, op->line, op->column));
+	}
+}
+
+void TypeChecker::visit(EmptyVarDeclNode*) {}
+
+void TypeChecker::visit(FullVarDeclNode* node) {
+	checkAssign(node->declaration, typeOf(node->expr), node->assign);
+}
+
+void TypeChecker::visit(ReasignVarNode* node) {
+	Token* assign = node->assign;
+	ValueType value = typeOf(node->expr);
+	switch (assign->type) {
+		case TokenType::PLUS_EQUAL: case TokenType::MINUS_EQUAL: case TokenType::MULTIPLY_EQUAL: case TokenType::DIVIDE_EQUAL:
+			value = arithmeticType(readType(node->identifier), value, assign);
+			break;
+		default: break;
+	}
+	checkAssign(node->identifier->declaration, value, assign);
+}
+
+void TypeChecker::visit(BlockOfCodeNode* node) {
+	for (AST* ast : node->list)
+		if (ast) visit(ast);
+}
+
+void TypeChecker::visit(IfStmtNode* node) {
+	typeOf(node->condition);
+	visit(node->code_to_execute);
+}
+
+void TypeChecker::visit(WhileStmtNode* node) {
+	typeOf(node->condition);
+	visit(node->code_to_execute);
+}
+
+void TypeChecker::visit(FuncParamNode*) {}
+
+void TypeChecker::visit(IncDecNode* node) {
+	Token* op = node->operation;
+	ValueType type = readType(node->identifier);
+	if (type != ValueType::INT && type != ValueType::FLOAT && type != ValueType::NONE)
+		raiseError(std::format("TYPE ERROR: Can't increment or decrement {} in {}:{}\n", valueTypeName(type), op->line, op->column));
+}
+
+void TypeChecker::visit(FuncCallNode* node) {
+	Token* name = node->func_name->identifier;
+	auto it = m_functions.find(node->func_name->symbol);
+	// print is builtin unless the script declares its own
+	if (it == m_functions.end() && name->value == "print") {
+		for (AST* arg : node->args) typeOf(arg);
+		m_type = ValueType::NONE;
+		return;
+	}
+	int index = (it == m_functions.end()) ? findBuiltin(name->value) : -1;
+	if (index >= 0) {
+		const Builtin& function = builtin(index);
+		if (static_cast<int>(node->args.size()) != function.arity)
+			raiseError(std::format("SEMANTIC ERROR: Function {} takes {} arguments but {} were given in {}:{}\n",
+				name->value, function.arity, node->args.size(), name->line, name->column));
+		for (int i = 0; i < function.arity; ++i) {
+			ValueType arg = typeOf(node->args[i]);
+			if (!assignable(function.params[i].type, arg))
+				raiseError(std::format("TYPE ERROR: Argument {} of {} must be {}, not {} in {}:{}\n",
+					function.params[i].name, name->value, valueTypeName(function.params[i].type), valueTypeName(arg), name->line, name->column));
+		}
+		m_type = function.result;
+		return;
+	}
+	if (it == m_functions.end())
+		raiseError(std::format("SEMANTIC ERROR: Undefined function {} in {}:{}\n", name->value, name->line, name->column));
+	std::span<EmptyVarDeclNode*> params = it->second->params->params;
+	if (node->args.size() != params.size())
+		raiseError(std::format("SEMANTIC ERROR: Function {} takes {} arguments but {} were given in {}:{}\n",
+			name->value, params.size(), node->args.size(), name->line, name->column));
+	for (size_t i = 0; i < params.size(); ++i) {
+		ValueType param = valueTypeFromName(params[i]->var_type->value);
+		ValueType arg = typeOf(node->args[i]);
+		if (!assignable(param, arg))
+			raiseError(std::format("TYPE ERROR: Argument {} of {} must be {}, not {} in {}:{}\n",
+				params[i]->identifier->identifier->value, name->value, valueTypeName(param), valueTypeName(arg), name->line, name->column));
+		if (arg == ValueType::NONE && param != ValueType::NONE) m_dynamic.insert(params[i]);
+	}
+	m_type = m_dynamic.count(it->second) ? ValueType::NONE : valueTypeFromName(it->second->func_return_type->value);
+}
+
+// A bare return gives the caller no value, only a void function may do it
+void TypeChecker::visit(ReturnStmtNode* node) {
+	Token* key_word = node->key_word;
+	if (!m_function)
+		raiseError(std::format("SEMANTIC ERROR: Return outside of function in {}:{}\n", key_word->line, key_word->column));
+	std::string_view name = m_function->func_name->identifier->value;
+	ValueType expected = valueTypeFromName(m_function->func_return_type->value);
+	ValueType type = node->expr ? typeOf(node->expr) : ValueType::NONE;
+	if (!node->expr && expected != ValueType::NONE)
+		raiseError(std::format("TYPE ERROR: Function {} must return {} in {}:{}\n", name, valueTypeName(expected), key_word->line, key_word->column));
+	if (!assignable(expected, type))
+		raiseError(std::format("TYPE ERROR: Function {} returns {}, not {} in {}:{}\n",
+			name, valueTypeName(expected), valueTypeName(type), key_word->line, key_word->column));
+	if (type == ValueType::NONE && expected != ValueType::NONE) m_dynamic.insert(m_function);
+}
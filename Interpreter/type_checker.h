@@ -0,0 +1,58 @@
+#ifndef TYPE_CHECKER_H
+#define TYPE_CHECKER_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "value.h"
+#include "../Parser/AST/ast.h"
+
+// Resolves the static type of every expression from the declared types of variables, parameters and
+// return values, and rejects the programs that would mix them wrongly before any of it runs.
+// Every BinOpNode and UnOpNode gets its operand types, the compiler picks int, float and string
+// opcodes from them. NONE stands for a type only known at run time (results of void functions and
+// print, void variables): nothing is checked against it and the VM keeps its generic operations there.
+// A variable, parameter or function that may be given such a value reads as NONE too. That can
+// show up after its first use, so the walk repeats until no new one is found (once for most scripts).
+// An int may hold a bool (coerce keeps it), the int opcodes read its i, which fromBool leaves 0 or 1.
+//
+// Runs on a tree the Resolver has bound, variables are found through IdNode::declaration.
+// Checks the functions: redeclared or undefined, argument counts, return outside of one.
+class TypeChecker {
+private:
+	std::unordered_map<SymbolId, FuncNode*> m_functions;
+	std::unordered_set<const AST*> m_dynamic; // Declarations and functions that may hold or return NONE
+	FuncNode* m_function = nullptr; // Being checked, null at top level
+	ValueType m_type; // Type of the last visited expression
+
+private:
+	ValueType typeOf(AST* expr);
+	ValueType readType(IdNode* variable);
+	void checkAssign(EmptyVarDeclNode* target, ValueType source, Token* position);
+	void walk(const std::vector<AST*>& ast, const std::vector<FuncNode*>& functions);
+	ValueType arithmeticType(ValueType left, ValueType right, Token* position); // + - * /
+
+	void visit(AST* ast) { dispatch(ast, [this](auto* node) { visit(node); }); } // Switch on the kind, then the overload below
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	void check(const std::vector<AST*>& ast); // Annotate ast, raises the first error found
+};
+#endif // !TYPE_CHECKER_H
@@ -0,0 +1,139 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Object/Array/darray.h"
+
+enum class ValueType : uint8_t { NONE, INT, FLOAT, BOOL, STRING, ARRAY };
+
+// Runtime value shared by the VM and the tree walker
+struct Value {
+	ValueType type = ValueType::NONE;
+	union {
+		int64_t i;
+		double f;
+		bool b;
+		const std::string* s;
+		DArray* a; // Builtins like set and push change arrays in place
+	};
+
+	Value(): i(0) {}
+	static Value fromInt(int64_t value) { Value v; v.type = ValueType::INT; v.i = value; return v; }
+	static Value fromFloat(double value) { Value v; v.type = ValueType::FLOAT; v.f = value; return v; }
+	static Value fromBool(bool value) { Value v; v.type = ValueType::BOOL; v.i = 0; v.b = value; return v; }
+	static Value fromString(const std::string* value) { Value v; v.type = ValueType::STRING; v.s = value; return v; }
+	static Value fromArray(DArray* value) { Value v; v.type = ValueType::ARRAY; v.a = value; return v; }
+
+	bool isNumber() const { return type == ValueType::INT || type == ValueType::FLOAT || type == ValueType::BOOL; }
+	double asFloat() const { return (type == ValueType::FLOAT) ? f : (type == ValueType::BOOL) ? b : static_cast<double>(i); }
+	int64_t asInt() const { return (type == ValueType::FLOAT) ? static_cast<int64_t>(f) : (type == ValueType::BOOL) ? b : i; }
+};
+
+// Owns every string and array created while a program runs.
+// There is no collector yet: objects live until the owning backend is destroyed.
+class Heap {
+private:
+	std::vector<std::unique_ptr<std::string>> m_strings;
+	std::vector<std::unique_ptr<DArray>> m_arrays;
+
+public:
+	const std::string* newString(std::string str) {
+		m_strings.push_back(std::make_unique<std::string>(std::move(str)));
+		return m_strings.back().get();
+	}
+	DArray* newArray(DArray array) {
+		m_arrays.push_back(std::make_unique<DArray>(std::move(array)));
+		return m_arrays.back().get();
+	}
+};
+
+// Element of an array as a value, chars read as ints like char variables
+inline Value arrayElement(const DArray& array, size_t index) {
+	switch (array.type()) {
+		case ElementType::INT: return Value::fromInt(array.at<int64_t>(index));
+		case ElementType::FLOAT: return Value::fromFloat(array.at<double>(index));
+		case ElementType::BOOL: return Value::fromBool(array.at<uint8_t>(index));
+		case ElementType::CHAR: return Value::fromInt(array.at<char>(index));
+		default: return Value::fromString(array.at<const std::string*>(index));
+	}
+}
+
+// Names of the types that can be declared ( var id: type )
+inline const char* valueTypeName(ValueType type) {
+	switch (type) {
+		case ValueType::INT: return "int";
+		case ValueType::FLOAT: return "float";
+		case ValueType::BOOL: return "bool";
+		case ValueType::STRING: return "string";
+		case ValueType::ARRAY: return "array";
+		default: return "void";
+	}
+}
+
+inline bool isTruthy(const Value& value) {
+	switch (value.type) {
+		case ValueType::INT: return value.i != 0;
+		case ValueType::FLOAT: return value.f != 0.0;
+		case ValueType::BOOL: return value.b;
+		case ValueType::STRING: return !value.s->empty();
+		case ValueType::ARRAY: return !value.a->empty();
+		default: return false;
+	}
+}
+
+inline std::string valueToString(const Value& value) {
+	switch (value.type) {
+		case ValueType::INT: return std::to_string(value.i);
+		case ValueType::FLOAT: {
+			char buffer[32];
+			std::snprintf(buffer, sizeof(buffer), "%g", value.f);
+			return buffer;
+		}
+		case ValueType::BOOL: return value.b ? "true" : "false";
+		case ValueType::STRING: return *value.s;
+		case ValueType::ARRAY: {
+			std::string temp = "[";
+			for (size_t i = 0; i < value.a->size(); ++i) {
+				if (i) temp += ", ";
+				temp += valueToString(arrayElement(*value.a, i));
+			}
+			return temp + "]";
+		}
+		default: return "none";
+	}
+}
+
+// Default value of a declared variable type
+inline Value defaultValue(ValueType type, Heap& heap) {
+	switch (type) {
+		case ValueType::INT: return Value::fromInt(0);
+		case ValueType::FLOAT: return Value::fromFloat(0.0);
+		case ValueType::BOOL: return Value::fromBool(false);
+		case ValueType::STRING: return Value::fromString(heap.newString(""));
+		case ValueType::ARRAY: return Value::fromArray(heap.newArray(DArray()));
+		default: return Value();
+	}
+}
+
+// Map the type keyword of a declaration to a value type ( char is stored as int )
+inline ValueType valueTypeFromName(std::string_view name) {
+	if (name == "int" || name == "char") return ValueType::INT;
+	if (name == "float") return ValueType::FLOAT;
+	if (name == "bool") return ValueType::BOOL;
+	if (name == "string") return ValueType::STRING;
+	if (name == "array") return ValueType::ARRAY;
+	return ValueType::NONE;
+}
+
+// Convert a value stored into a variable of declared type int or float
+inline Value coerce(const Value& value, ValueType type) {
+	if (type == ValueType::INT && value.type == ValueType::FLOAT) return Value::fromInt(static_cast<int64_t>(value.f));
+	if (type == ValueType::FLOAT && (value.type == ValueType::INT || value.type == ValueType::BOOL)) return Value::fromFloat(value.asFloat());
+	return value;
+}
+#endif // !VALUE_H
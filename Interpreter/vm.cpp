@@ -0,0 +1,241 @@
+#include "vm.h"
+#include "operations.h"
+
+constexpr size_t STACK_SIZE = 1 << 16;
+
+void VM::runtimeError(const Function* function, const Instruction* ip, const std::string& msg) {
+	size_t pos = ip - function->code.data();
+	raiseError(std::format("RUNTIME ERROR: {} in {}:{}\n", msg, function->lines[pos], function->columns[pos]));
+}
+
+bool VM::hot(size_t function) {
+	if (m_native[function].code) return true;
+	if (m_jit_mode != JitMode::TIERED || m_heat[function] == JIT_THRESHOLD) return false; // Reached and failed to compile
+	if (++m_heat[function] < JIT_THRESHOLD) return false;
+	m_native[function] = m_jit.compile(*m_program, m_program->functions[function], m_globals.data());
+	return m_native[function].code != nullptr;
+}
+
+// Main function
+void VM::run(const Program& program) {
+	m_program = &program;
+	m_stack.assign(STACK_SIZE, Value());
+	m_frames.clear();
+	m_globals.assign(program.global_names.size(), Value());
+	m_native.assign(program.functions.size(), NativeFunction());
+	m_heat.assign(program.functions.size(), 0);
+	if (m_jit_mode == JitMode::FORCE)
+		for (size_t i = 0; i < program.functions.size(); ++i) m_native[i] = m_jit.compile(program, program.functions[i], m_globals.data());
+
+	const Function* function = &program.functions[0];
+	const Instruction* ip = function->code.data();
+	const Instruction* instr = ip;
+	const Value* constants = program.constants.data();
+	Value* globals = m_globals.data();
+	Value* base = m_stack.data();
+	Value* stack_end = m_stack.data() + m_stack.size();
+	Value* sp = base + function->num_locals;
+	if (sp + function->max_stack > stack_end) runtimeError(function, ip, "Stack overflow");
+
+// Fast paths for int and float operands, everything else goes to operations.h
+#define POSITION function->lines[instr - function->code.data()], function->columns[instr - function->code.data()]
+#define BINARY_ARITH(token, op, wrap) { \
+		Value& l = sp[-2]; Value r = sp[-1]; --sp; \
+		if (l.type == ValueType::INT && r.type == ValueType::INT) l.i = wrap(l.i, r.i); \
+		else if (l.type == ValueType::FLOAT && r.type == ValueType::FLOAT) l.f = l.f op r.f; \
+		else l = arithmetic(token, l, r, m_heap, POSITION); \
+	}
+#define BINARY_COMPARE(token, op) { \
+		Value& l = sp[-2]; Value r = sp[-1]; --sp; \
+		if (l.type == ValueType::INT && r.type == ValueType::INT) l = Value::fromBool(l.i op r.i); \
+		else if (l.type == ValueType::FLOAT && r.type == ValueType::FLOAT) l = Value::fromBool(l.f op r.f); \
+		else l = compare(token, l, r, POSITION); \
+	}
+// Typed opcodes: the checker proved the operand types. An int slot may hold a bool, whose i is 0 or 1.
+// Int results wrap like arithmetic() does
+#define INT_ARITH(wrap) { Value& l = sp[-2]; l.type = ValueType::INT; l.i = wrap(l.i, sp[-1].i); --sp; }
+#define FLOAT_ARITH(op) { sp[-2].f = sp[-2].f op sp[-1].f; --sp; }
+#define INT_COMPARE(op) { sp[-2] = Value::fromBool(sp[-2].i op sp[-1].i); --sp; }
+#define FLOAT_COMPARE(op) { sp[-2] = Value::fromBool(sp[-2].f op sp[-1].f); --sp; }
+// Run the current function's native code from instruction at until it gives control back
+#define ENTER_NATIVE(at) { \
+		NativeExit exit = m_native[function - program.functions.data()].enter(base, sp, at); \
+		sp = exit.sp; \
+		ip = function->code.data() + exit.index; \
+	}
+
+#ifdef DLANG_COMPUTED_GOTO
+	static void* dispatch_table[] = {
+#define DLANG_OPCODE_LABEL(name) &&L_##name,
+		DLANG_OPCODES(DLANG_OPCODE_LABEL)
+#undef DLANG_OPCODE_LABEL
+	};
+#define DISPATCH() goto *dispatch_table[(instr = ip++)->op]
+#define TARGET(name) L_##name
+#else
+#define DISPATCH() goto dispatch
+#define TARGET(name) case OP_##name
+#endif
+
+	if (m_native[0].code) ENTER_NATIVE(0);
+	DISPATCH();
+#ifndef DLANG_COMPUTED_GOTO
+dispatch:
+	instr = ip++;
+	switch (instr->op) {
+#endif
+	TARGET(PUSH_CONST): *sp++ = constants[instr->operand]; DISPATCH();
+	TARGET(PUSH_NONE): *sp++ = Value(); DISPATCH();
+	TARGET(PUSH_FALSE): *sp++ = Value::fromBool(false); DISPATCH();
+	TARGET(NEW_ARRAY): *sp++ = Value::fromArray(m_heap.newArray(*constants[instr->operand].a)); DISPATCH();
+	TARGET(POP): --sp; DISPATCH();
+	TARGET(LOAD_LOCAL): *sp++ = base[instr->operand]; DISPATCH();
+	TARGET(STORE_LOCAL): base[instr->operand] = *--sp; DISPATCH();
+	TARGET(LOAD_GLOBAL): {
+		const Value& value = globals[instr->operand];
+		if (value.type == ValueType::NONE)
+			runtimeError(function, instr, std::format("Variable {} used before declaration", program.global_names[instr->operand]));
+		*sp++ = value;
+		DISPATCH();
+	}
+	TARGET(STORE_GLOBAL): globals[instr->operand] = *--sp; DISPATCH();
+	TARGET(INC_LOCAL): {
+		Value& value = base[instr->operand];
+		if (value.type == ValueType::INT) value.i = wrapAdd(value.i, 1);
+		else value = step(value, 1, POSITION);
+		DISPATCH();
+	}
+	TARGET(DEC_LOCAL): {
+		Value& value = base[instr->operand];
+		if (value.type == ValueType::INT) value.i = wrapSub(value.i, 1);
+		else value = step(value, -1, POSITION);
+		DISPATCH();
+	}
+	TARGET(INC_GLOBAL): {
+		Value& value = globals[instr->operand];
+		if (value.type == ValueType::INT) value.i = wrapAdd(value.i, 1);
+		else value = step(value, 1, POSITION);
+		DISPATCH();
+	}
+	TARGET(DEC_GLOBAL): {
+		Value& value = globals[instr->operand];
+		if (value.type == ValueType::INT) value.i = wrapSub(value.i, 1);
+		else value = step(value, -1, POSITION);
+		DISPATCH();
+	}
+	TARGET(ADD): BINARY_ARITH(TokenType::PLUS, +, wrapAdd); DISPATCH();
+	TARGET(SUB): BINARY_ARITH(TokenType::MINUS, -, wrapSub); DISPATCH();
+	TARGET(MUL): BINARY_ARITH(TokenType::MULTIPLY, *, wrapMul); DISPATCH();
+	TARGET(DIV): {
+		Value& l = sp[-2]; Value r = sp[-1]; --sp;
+		if (l.type == ValueType::FLOAT && r.type == ValueType::FLOAT) l.f = l.f / r.f;
+		else l = arithmetic(TokenType::DIVIDE, l, r, m_heap, POSITION);
+		DISPATCH();
+	}
+	TARGET(LESS): BINARY_COMPARE(TokenType::LESS, <); DISPATCH();
+	TARGET(GREATER): BINARY_COMPARE(TokenType::GREATER, >); DISPATCH();
+	TARGET(LESS_EQUAL): BINARY_COMPARE(TokenType::LESS_EQUAL, <=); DISPATCH();
+	TARGET(GREATER_EQUAL): BINARY_COMPARE(TokenType::GREATER_EQUAL, >=); DISPATCH();
+	TARGET(EQUAL_EQUAL): BINARY_COMPARE(TokenType::EQUAL_EQUAL, ==); DISPATCH();
+	TARGET(NOT_EQUAL): BINARY_COMPARE(TokenType::NOT_EQUAL, !=); DISPATCH();
+	TARGET(ADD_INT): INT_ARITH(wrapAdd); DISPATCH();
+	TARGET(SUB_INT): INT_ARITH(wrapSub); DISPATCH();
+	TARGET(MUL_INT): INT_ARITH(wrapMul); DISPATCH();
+	TARGET(DIV_INT): {
+		if (sp[-1].i == 0) runtimeError(function, instr, "Division by zero");
+		INT_ARITH(wrapDiv);
+		DISPATCH();
+	}
+	TARGET(LESS_INT): INT_COMPARE(<); DISPATCH();
+	TARGET(GREATER_INT): INT_COMPARE(>); DISPATCH();
+	TARGET(LESS_EQUAL_INT): INT_COMPARE(<=); DISPATCH();
+	TARGET(GREATER_EQUAL_INT): INT_COMPARE(>=); DISPATCH();
+	TARGET(EQUAL_EQUAL_INT): INT_COMPARE(==); DISPATCH();
+	TARGET(NOT_EQUAL_INT): INT_COMPARE(!=); DISPATCH();
+	TARGET(ADD_FLOAT): FLOAT_ARITH(+); DISPATCH();
+	TARGET(SUB_FLOAT): FLOAT_ARITH(-); DISPATCH();
+	TARGET(MUL_FLOAT): FLOAT_ARITH(*); DISPATCH();
+	TARGET(DIV_FLOAT): FLOAT_ARITH(/); DISPATCH();
+	TARGET(LESS_FLOAT): FLOAT_COMPARE(<); DISPATCH();
+	TARGET(GREATER_FLOAT): FLOAT_COMPARE(>); DISPATCH();
+	TARGET(LESS_EQUAL_FLOAT): FLOAT_COMPARE(<=); DISPATCH();
+	TARGET(GREATER_EQUAL_FLOAT): FLOAT_COMPARE(>=); DISPATCH();
+	TARGET(EQUAL_EQUAL_FLOAT): FLOAT_COMPARE(==); DISPATCH();
+	TARGET(NOT_EQUAL_FLOAT): FLOAT_COMPARE(!=); DISPATCH();
+	TARGET(CONCAT): sp[-2] = Value::fromString(m_heap.newString(*sp[-2].s + *sp[-1].s)); --sp; DISPATCH();
+	TARGET(NEGATE_INT): sp[-1] = Value::fromInt(wrapSub(0, sp[-1].i)); DISPATCH();
+	TARGET(NEGATE_FLOAT): sp[-1].f = -sp[-1].f; DISPATCH();
+	TARGET(NEGATE): sp[-1] = negate(TokenType::MINUS, sp[-1], POSITION); DISPATCH();
+	TARGET(PLUS): sp[-1] = negate(TokenType::PLUS, sp[-1], POSITION); DISPATCH();
+	TARGET(NOT): sp[-1] = Value::fromBool(!isTruthy(sp[-1])); DISPATCH();
+	TARGET(TO_BOOL): sp[-1] = Value::fromBool(isTruthy(sp[-1])); DISPATCH();
+	TARGET(TO_INT): sp[-1] = coerce(sp[-1], ValueType::INT); DISPATCH();
+	TARGET(TO_FLOAT): sp[-1] = coerce(sp[-1], ValueType::FLOAT); DISPATCH();
+	TARGET(JUMP): {
+		ip = function->code.data() + instr->operand;
+		if (ip < instr && hot(function - program.functions.data())) ENTER_NATIVE(instr->operand); // A loop iteration
+		DISPATCH();
+	}
+	TARGET(JUMP_IF_FALSE): {
+		const Value& cond = *--sp;
+		bool truthy = (cond.type == ValueType::BOOL) ? cond.b : isTruthy(cond);
+		if (!truthy) ip = function->code.data() + instr->operand;
+		DISPATCH();
+	}
+	TARGET(CALL): {
+		const Function* callee = &program.functions[instr->operand];
+		if (m_frames.size() >= MAX_CALL_DEPTH) runtimeError(function, instr, "Stack overflow");
+		Value* callee_base = sp - callee->arity;
+		if (callee_base + callee->num_locals + callee->max_stack > stack_end) runtimeError(function, instr, "Stack overflow");
+		m_frames.push_back({ function, ip, base });
+		for (Value* slot = sp; slot < callee_base + callee->num_locals; ++slot) *slot = Value();
+		function = callee;
+		base = callee_base;
+		sp = base + callee->num_locals;
+		ip = callee->code.data();
+		if (hot(instr->operand)) ENTER_NATIVE(0);
+		DISPATCH();
+	}
+	TARGET(RETURN): {
+		Value result = *--sp;
+		sp = base;
+		*sp++ = result;
+		const CallFrame& frame = m_frames.back();
+		function = frame.function;
+		ip = frame.ip;
+		base = frame.base;
+		m_frames.pop_back();
+		if (m_native[function - program.functions.data()].code) ENTER_NATIVE(ip - function->code.data());
+		DISPATCH();
+	}
+	TARGET(CALL_BUILTIN): {
+		Value* args = sp - builtin(instr->operand).arity;
+		Value result = callBuiltin(instr->operand, args, m_heap, POSITION);
+		sp = args;
+		*sp++ = result;
+		DISPATCH();
+	}
+	TARGET(PRINT): {
+		Value* args = sp - instr->operand;
+		for (int i = 0; i < instr->operand; ++i) m_out << (i ? " " : "") << valueToString(args[i]);
+		m_out << "\n";
+		sp = args;
+		*sp++ = Value();
+		DISPATCH();
+	}
+	TARGET(HALT): return;
+#ifndef DLANG_COMPUTED_GOTO
+	}
+#endif
+
+#undef POSITION
+#undef BINARY_ARITH
+#undef BINARY_COMPARE
+#undef INT_ARITH
+#undef FLOAT_ARITH
+#undef INT_COMPARE
+#undef FLOAT_COMPARE
+#undef ENTER_NATIVE
+#undef DISPATCH
+#undef TARGET
+}
@@ -0,0 +1,44 @@
+#ifndef VM_H
+#define VM_H
+
+#include <iostream>
+#include <vector>
+#include "bytecode.h"
+#include "jit.h"
+
+// Computed goto dispatch where the compiler supports labels as values, switch dispatch otherwise.
+// Define DLANG_NO_COMPUTED_GOTO to force the switch.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(DLANG_NO_COMPUTED_GOTO)
+#define DLANG_COMPUTED_GOTO
+#endif
+
+// Stack machine that runs compiled bytecode
+class VM {
+private:
+	struct CallFrame {
+		const Function* function;
+		const Instruction* ip;
+		Value* base;
+	};
+
+	Heap m_heap; // strings and arrays created at run time
+	std::ostream& m_out;
+	std::vector<Value> m_stack;
+	std::vector<CallFrame> m_frames;
+	std::vector<Value> m_globals;
+	const Program* m_program = nullptr;
+	JitMode m_jit_mode;
+	JIT m_jit;
+	std::vector<NativeFunction> m_native; // Index is the function's, no code until it's compiled
+	std::vector<uint32_t> m_heat; // Calls and loop iterations of every function
+
+private:
+	void runtimeError(const Function* function, const Instruction* ip, const std::string& msg);
+	bool hot(size_t function); // Counts one call or iteration, true once the function has native code
+
+public:
+	VM(std::ostream& out = std::cout, JitMode jit = JitMode::TIERED): m_out(out), m_jit_mode(jit) {}
+	void run(const Program& program);
+	const std::vector<Value>& globals() const { return m_globals; }
+};
+#endif // !VM_H
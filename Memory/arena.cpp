@@ -0,0 +1,33 @@
+#include <algorithm>
+#include <cstdlib>
+#include "arena.h"
+
+void* Arena::allocateSlow(size_t size, size_t align) {
+	// Oversized requests get a block of their own
+	size_t block_size = std::max(m_block_size, size + align + sizeof(Block));
+	Block* block = static_cast<Block*>(std::malloc(block_size));
+	if (!block) throw std::bad_alloc();
+	block->next = m_blocks;
+	block->size = block_size;
+	m_blocks = block;
+	m_bytes_reserved += block_size;
+
+	m_current = reinterpret_cast<char*>(block) + sizeof(Block);
+	m_end = reinterpret_cast<char*>(block) + block_size;
+	uintptr_t pos = (reinterpret_cast<uintptr_t>(m_current) + align - 1) & ~(uintptr_t)(align - 1);
+	m_current = reinterpret_cast<char*>(pos + size);
+	return reinterpret_cast<void*>(pos);
+}
+
+void Arena::release() {
+	for (Finalizer* finalizer = m_finalizers; finalizer; finalizer = finalizer->next)
+		finalizer->destroy(finalizer->object);
+	m_finalizers = nullptr;
+	while (m_blocks) {
+		Block* next = m_blocks->next;
+		std::free(m_blocks);
+		m_blocks = next;
+	}
+	m_current = m_end = nullptr;
+	m_bytes_used = m_bytes_reserved = m_allocations = 0;
+}
@@ -0,0 +1,103 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for everything one compilation creates (tokens, AST nodes, their strings and child lists).
+//
+// Lifetime rules:
+//  - every object made by an arena lives exactly as long as the arena;
+//  - objects are never freed one by one, release() (or the destructor) drops all of them at once;
+//  - trivially destructible objects cost nothing to release. Objects with a destructor are
+//    recorded on a finalizer list and destroyed in reverse order, so hot node types keep their
+//    members trivial (std::span, std::string_view) and make release O(number of blocks).
+class Arena {
+private:
+	struct Block {
+		Block* next;
+		size_t size;
+	};
+	struct Finalizer {
+		void (*destroy)(void*);
+		void* object;
+		Finalizer* next;
+	};
+
+	Block* m_blocks = nullptr;
+	char* m_current = nullptr;
+	char* m_end = nullptr;
+	Finalizer* m_finalizers = nullptr;
+	size_t m_block_size;
+	size_t m_bytes_used = 0;
+	size_t m_bytes_reserved = 0;
+	size_t m_allocations = 0;
+
+private:
+	void* allocateSlow(size_t size, size_t align); // Start a new block
+
+public:
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+	explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE): m_block_size(block_size) {}
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena() { release(); }
+
+	void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+		++m_allocations;
+		m_bytes_used += size;
+		uintptr_t pos = (reinterpret_cast<uintptr_t>(m_current) + align - 1) & ~(uintptr_t)(align - 1);
+		if (m_current && pos + size <= reinterpret_cast<uintptr_t>(m_end)) {
+			m_current = reinterpret_cast<char*>(pos + size);
+			return reinterpret_cast<void*>(pos);
+		}
+		return allocateSlow(size, align);
+	}
+
+	// Construct object inside the arena
+	template<typename T, typename... Args>
+	T* make(Args&&... args) {
+		T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			Finalizer* finalizer = new (allocate(sizeof(Finalizer), alignof(Finalizer))) Finalizer;
+			finalizer->destroy = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+			finalizer->object = object;
+			finalizer->next = m_finalizers;
+			m_finalizers = finalizer;
+		}
+		return object;
+	}
+
+	// Copy a list into the arena, the result stays valid until release
+	template<typename T>
+	std::span<T> copy(const std::vector<T>& list) {
+		static_assert(std::is_trivially_copyable_v<T>, "arena lists hold trivially copyable elements");
+		if (list.empty()) return {};
+		T* data = static_cast<T*>(allocate(sizeof(T) * list.size(), alignof(T)));
+		std::memcpy(data, list.data(), sizeof(T) * list.size());
+		return { data, list.size() };
+	}
+
+	// Copy characters into the arena
+	std::string_view copy(std::string_view str) {
+		if (str.empty()) return {};
+		char* data = static_cast<char*>(allocate(str.size(), 1));
+		std::memcpy(data, str.data(), str.size());
+		return { data, str.size() };
+	}
+
+	void release(); // Destroy every object and free all blocks
+
+	size_t bytesUsed() const { return m_bytes_used; } // Requested bytes
+	size_t bytesReserved() const { return m_bytes_reserved; } // Bytes taken from the system
+	size_t allocationCount() const { return m_allocations; }
+};
+#endif // !ARENA_H
@@ -1,16 +1,45 @@
+#include <algorithm>
 #include "darray.h"
 
-std::string DArray::stringRepresentation() {
-	if (m_data.empty()) return std::string();
-	std::string temp;
-	for (int i = 0; i < m_data.size(); ++i)
-		temp += m_data[i]->value + ((i == m_data.size() - 1) ? '\0' : ',');
-	return temp;
+DArray::DArray(ElementType type, size_t capacity) {
+	switch (type) {
+		case ElementType::INT: m_buffer = std::make_shared<Buffer>(std::in_place_index<0>); break;
+		case ElementType::FLOAT: m_buffer = std::make_shared<Buffer>(std::in_place_index<1>); break;
+		case ElementType::BOOL: m_buffer = std::make_shared<Buffer>(std::in_place_index<2>); break;
+		case ElementType::CHAR: m_buffer = std::make_shared<Buffer>(std::in_place_index<3>); break;
+		default: m_buffer = std::make_shared<Buffer>(std::in_place_index<4>); break;
+	}
+	if (capacity) reserve(capacity);
 }
 
-bool DArray::validateArray(std::vector<Token*> token_array) {
-	TokenType token_type = token_array[0]->type;
-	for (int i = 0; i < m_data.size(); ++i)
-		if (m_data[i]->type != token_type) return false;
-	return true;
-}
\ No newline at end of file
+DArray DArray::slice(size_t from, size_t to) const {
+	size_t first = std::min(from, m_size), last = std::clamp(to, first, m_size);
+	DArray result = *this;
+	result.m_offset = m_offset + first;
+	result.m_size = last - first;
+	return result;
+}
+
+void DArray::resize(size_t size) {
+	std::visit([&](auto& buffer) { buffer.resize(m_offset + size); }, detach(size > m_size ? size - m_size : 0));
+	m_size = size;
+}
+
+// A shared buffer is copied, only the viewed elements. An unshared one drops what's past the view, so
+// appends land right after it; the space before the offset stays until the next copy
+DArray::Buffer& DArray::detach(size_t extra) {
+	std::visit([&](auto& buffer) {
+		using Vector = std::remove_reference_t<decltype(buffer)>;
+		if (m_buffer.use_count() > 1) {
+			Vector copy;
+			copy.reserve(m_size + extra);
+			copy.assign(buffer.begin() + m_offset, buffer.begin() + m_offset + m_size);
+			m_buffer = std::make_shared<Buffer>(std::move(copy));
+			m_offset = 0;
+			return;
+		}
+		buffer.resize(m_offset + m_size);
+		if (buffer.capacity() < buffer.size() + extra) buffer.reserve(std::max(buffer.size() + extra, buffer.capacity() * 2));
+	}, *m_buffer);
+	return *m_buffer;
+}
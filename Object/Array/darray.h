@@ -1,26 +1,57 @@
 #ifndef DARRAY_H
 #define DARRAY_H
 
-#include <iostream>
-#include <vector>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
-#include "../../Parser/Lexer/lexer.h"
-#include "../../Error/error.h"
+#include <variant>
+#include <vector>
 
-class DArray { // I'LL RETURN HERE WHEN I START IMPLEMENTING THE INTERPRETER CLASS
+// Type of every element of one DArray, in the order of DArray::Buffer
+enum class ElementType : uint8_t { INT, FLOAT, BOOL, CHAR, STRING };
+
+// Array of one element type, stored unboxed and contiguous: 8 bytes per int, float or string (a pointer
+// to a string the caller owns, like Heap strings), 1 byte per bool or char. Bools are uint8_t 0 or 1.
+//
+// A DArray is a view (offset and size) of a buffer it may share. Copies and slices take O(1) and share
+// the buffer until one of them writes, which first gives the writer a buffer of its own (copy on write).
+// Element access is typed: T must be the C++ type of type(), std::get checks it.
+class DArray {
 private:
-	std::vector<Token*> m_data;
+	using Buffer = std::variant<std::vector<int64_t>, std::vector<double>, std::vector<uint8_t>, std::vector<char>, std::vector<const std::string*>>;
+	std::shared_ptr<Buffer> m_buffer;
+	size_t m_offset = 0;
+	size_t m_size = 0;
 
 public:
-	DArray(std::vector<Token*> token_array): m_data(token_array) {
-		if (!validateArray(m_data)) {
-			raiseError(std::format("SYNTAX ERROR: All array elements must have one type! Error in line {}\n", m_data[0]->line));
-			m_data.clear();
-		}
+	explicit DArray(ElementType type = ElementType::INT, size_t capacity = 0);
+
+	ElementType type() const { return static_cast<ElementType>(m_buffer->index()); }
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	bool sharesBuffer() const { return m_buffer.use_count() > 1; }
+
+	template <typename T> std::span<const T> elements() const { return std::span<const T>(std::get<std::vector<T>>(*m_buffer)).subspan(m_offset, m_size); }
+	template <typename T> const T& at(size_t index) const { return std::get<std::vector<T>>(*m_buffer)[m_offset + index]; }
+
+	// Writes detach a shared buffer first
+	template <typename T> std::span<T> mutableElements() { return std::span<T>(std::get<std::vector<T>>(writable())).subspan(m_offset, m_size); }
+	template <typename T> void set(size_t index, T value) { std::get<std::vector<T>>(writable())[m_offset + index] = value; }
+	template <typename T> void append(T value) {
+		std::vector<T>* buffer = std::get_if<std::vector<T>>(m_buffer.get());
+		if (!buffer || sharesBuffer() || buffer->size() != m_offset + m_size) buffer = &std::get<std::vector<T>>(detach(1));
+		buffer->push_back(value);
+		++m_size;
 	}
-	std::string stringRepresentation();
+	void reserve(size_t capacity) { detach(capacity > m_size ? capacity - m_size : 0); }
+	void resize(size_t size); // New elements are 0, false or null
+
+	DArray slice(size_t from, size_t to) const; // Elements [from, to), clamped to the array, sharing the buffer
 
 private:
-	bool validateArray(std::vector<Token*> token_array);
+	Buffer& writable() { return sharesBuffer() ? detach(0) : *m_buffer; }
+	// The buffer, unshared and ending with this view, with room to append extra elements
+	Buffer& detach(size_t extra);
 };
-#endif // !DARRAY_H
\ No newline at end of file
+#endif // !DARRAY_H
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include "simd.h"
+#ifdef DLANG_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang build single functions for AVX2 on request, MSVC takes AVX2 intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+constexpr size_t LANES = 8; // Of the float reductions, at every level
+
+const char* simdLevelName(SimdLevel level) {
+	switch (level) {
+		case SimdLevel::AVX2: return "avx2";
+		case SimdLevel::SSE2: return "sse2";
+		default: return "scalar";
+	}
+}
+
+// SSE2 is part of x86-64. AVX2 also needs the OS to save the ymm registers
+SimdLevel supportedSimdLevel() {
+#if defined(DLANG_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#elif defined(DLANG_SIMD_X86)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return SimdLevel::SSE2;
+	__cpuid(info, 1);
+	bool saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+	__cpuidex(info, 7, 0);
+	return (saves_ymm && (info[1] & (1 << 5))) ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#else
+	return SimdLevel::SCALAR;
+#endif
+}
+
+static SimdLevel initialLevel() {
+	SimdLevel level = supportedSimdLevel();
+	if (const char* name = std::getenv("DLANG_SIMD"))
+		for (SimdLevel lower : { SimdLevel::SCALAR, SimdLevel::SSE2 })
+			if (!std::strcmp(name, simdLevelName(lower))) level = std::min(level, lower);
+	return level;
+}
+
+static std::atomic<SimdLevel> s_level = initialLevel();
+
+SimdLevel simdLevel() { return s_level.load(std::memory_order_relaxed); }
+
+void setSimdLevel(SimdLevel level) { s_level.store(std::min(level, supportedSimdLevel()), std::memory_order_relaxed); }
+
+// Scalar kernels, the vector ones finish their last elements with them
+
+static double addLanes(const double* lanes) {
+	double sum = lanes[0];
+	for (size_t j = 1; j < LANES; ++j) sum += lanes[j];
+	return sum;
+}
+
+// x if it beats best, else best: what minpd and maxpd do, NaN never beats anything
+template <bool MIN> static double better(double x, double best) { return (MIN ? x < best : x > best) ? x : best; }
+
+template <bool MIN> static double pickLanes(const double* lanes) {
+	double best = lanes[0];
+	for (size_t j = 1; j < LANES; ++j) best = better<MIN>(lanes[j], best);
+	return best;
+}
+
+static int64_t sumIntScalar(const int64_t* a, size_t i, size_t n) {
+	uint64_t sum = 0;
+	for (; i < n; ++i) sum += static_cast<uint64_t>(a[i]);
+	return static_cast<int64_t>(sum);
+}
+
+static void sumFloatLanes(double* lanes, const double* a, size_t i, size_t n) {
+	for (; i < n; ++i) lanes[i % LANES] += a[i];
+}
+
+static void dotFloatLanes(double* lanes, const double* a, const double* b, size_t i, size_t n) {
+	for (; i < n; ++i) lanes[i % LANES] += a[i] * b[i];
+}
+
+template <bool MIN> static int64_t extremeIntScalar(const int64_t* a, size_t i, size_t n, int64_t best) {
+	for (; i < n; ++i) best = MIN ? std::min(best, a[i]) : std::max(best, a[i]);
+	return best;
+}
+
+template <bool MIN> static void extremeFloatLanes(double* lanes, const double* a, size_t i, size_t n) {
+	for (; i < n; ++i) lanes[i % LANES] = better<MIN>(a[i], lanes[i % LANES]);
+}
+
+static void arithmeticIntScalar(TokenType op, const int64_t* a, const int64_t* b, int64_t* out, size_t i, size_t n) {
+	switch (op) {
+		case TokenType::PLUS: for (; i < n; ++i) out[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) + static_cast<uint64_t>(b[i])); break;
+		case TokenType::MINUS: for (; i < n; ++i) out[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) - static_cast<uint64_t>(b[i])); break;
+		case TokenType::MULTIPLY: for (; i < n; ++i) out[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i])); break;
+		default: // The smallest int divided by -1 wraps to itself instead of trapping
+			for (; i < n; ++i) out[i] = (b[i] == -1) ? static_cast<int64_t>(0 - static_cast<uint64_t>(a[i])) : a[i] / b[i];
+			break;
+	}
+}
+
+static void arithmeticFloatScalar(TokenType op, const double* a, const double* b, double* out, size_t i, size_t n) {
+	switch (op) {
+		case TokenType::PLUS: for (; i < n; ++i) out[i] = a[i] + b[i]; break;
+		case TokenType::MINUS: for (; i < n; ++i) out[i] = a[i] - b[i]; break;
+		case TokenType::MULTIPLY: for (; i < n; ++i) out[i] = a[i] * b[i]; break;
+		default: for (; i < n; ++i) out[i] = a[i] / b[i]; break;
+	}
+}
+
+template <typename T> static void compareScalar(TokenType op, const T* a, const T* b, uint8_t* out, size_t i, size_t n) {
+	switch (op) {
+		case TokenType::LESS: for (; i < n; ++i) out[i] = a[i] < b[i]; break;
+		case TokenType::GREATER: for (; i < n; ++i) out[i] = a[i] > b[i]; break;
+		case TokenType::LESS_EQUAL: for (; i < n; ++i) out[i] = a[i] <= b[i]; break;
+		case TokenType::GREATER_EQUAL: for (; i < n; ++i) out[i] = a[i] >= b[i]; break;
+		case TokenType::EQUAL_EQUAL: for (; i < n; ++i) out[i] = a[i] == b[i]; break;
+		default: for (; i < n; ++i) out[i] = a[i] != b[i]; break;
+	}
+}
+
+#ifdef DLANG_SIMD_X86
+// One byte per bit of a movemask
+static void storeMask(uint8_t* out, int bits, int count) {
+	for (int j = 0; j < count; ++j) out[j] = (bits >> j) & 1;
+}
+
+// Loop over blocks of width elements, then the scalar kernel does the rest from i
+#define VECTOR_LOOP(width, body) for (; i + (width) <= n; i += (width)) { body; }
+
+// SSE2: two doubles or int64 per register, four registers make the eight lanes
+
+static int64_t sumIntSse2(const int64_t* a, size_t n) {
+	__m128i acc = _mm_setzero_si128();
+	size_t i = 0;
+	VECTOR_LOOP(2, acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i))))
+	int64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+	return static_cast<int64_t>(static_cast<uint64_t>(lanes[0]) + static_cast<uint64_t>(lanes[1]) + static_cast<uint64_t>(sumIntScalar(a, i, n)));
+}
+
+static double sumFloatSse2(const double* a, size_t n) {
+	__m128d acc0 = _mm_setzero_pd(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+	size_t i = 0;
+	VECTOR_LOOP(LANES,
+		acc0 = _mm_add_pd(acc0, _mm_loadu_pd(a + i)); acc1 = _mm_add_pd(acc1, _mm_loadu_pd(a + i + 2));
+		acc2 = _mm_add_pd(acc2, _mm_loadu_pd(a + i + 4)); acc3 = _mm_add_pd(acc3, _mm_loadu_pd(a + i + 6)))
+	double lanes[LANES];
+	_mm_storeu_pd(lanes, acc0); _mm_storeu_pd(lanes + 2, acc1); _mm_storeu_pd(lanes + 4, acc2); _mm_storeu_pd(lanes + 6, acc3);
+	sumFloatLanes(lanes, a, i, n);
+	return addLanes(lanes);
+}
+
+static double dotFloatSse2(const double* a, const double* b, size_t n) {
+	__m128d acc0 = _mm_setzero_pd(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+	size_t i = 0;
+	VECTOR_LOOP(LANES,
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+		acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+		acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+		acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6))))
+	double lanes[LANES];
+	_mm_storeu_pd(lanes, acc0); _mm_storeu_pd(lanes + 2, acc1); _mm_storeu_pd(lanes + 4, acc2); _mm_storeu_pd(lanes + 6, acc3);
+	dotFloatLanes(lanes, a, b, i, n);
+	return addLanes(lanes);
+}
+
+template <bool MIN> static double extremeFloatSse2(const double* a, size_t n) {
+	__m128d acc0 = _mm_set1_pd(a[0]), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+	size_t i = 0;
+#define PICK(acc, offset) acc = MIN ? _mm_min_pd(_mm_loadu_pd(a + i + (offset)), acc) : _mm_max_pd(_mm_loadu_pd(a + i + (offset)), acc)
+	VECTOR_LOOP(LANES, PICK(acc0, 0); PICK(acc1, 2); PICK(acc2, 4); PICK(acc3, 6))
+#undef PICK
+	double lanes[LANES];
+	_mm_storeu_pd(lanes, acc0); _mm_storeu_pd(lanes + 2, acc1); _mm_storeu_pd(lanes + 4, acc2); _mm_storeu_pd(lanes + 6, acc3);
+	extremeFloatLanes<MIN>(lanes, a, i, n);
+	return pickLanes<MIN>(lanes);
+}
+
+static void arithmeticIntSse2(TokenType op, const int64_t* a, const int64_t* b, int64_t* out, size_t n) {
+	size_t i = 0;
+#define INT_OP(intrinsic) VECTOR_LOOP(2, _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), \
+	intrinsic(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)))))
+	if (op == TokenType::PLUS) INT_OP(_mm_add_epi64)
+	else if (op == TokenType::MINUS) INT_OP(_mm_sub_epi64)
+#undef INT_OP
+	arithmeticIntScalar(op, a, b, out, i, n);
+}
+
+static void arithmeticFloatSse2(TokenType op, const double* a, const double* b, double* out, size_t n) {
+	size_t i = 0;
+#define FLOAT_OP(intrinsic) VECTOR_LOOP(2, _mm_storeu_pd(out + i, intrinsic(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))))
+	switch (op) {
+		case TokenType::PLUS: FLOAT_OP(_mm_add_pd) break;
+		case TokenType::MINUS: FLOAT_OP(_mm_sub_pd) break;
+		case TokenType::MULTIPLY: FLOAT_OP(_mm_mul_pd) break;
+		default: FLOAT_OP(_mm_div_pd) break;
+	}
+#undef FLOAT_OP
+	arithmeticFloatScalar(op, a, b, out, i, n);
+}
+
+static void compareFloatSse2(TokenType op, const double* a, const double* b, uint8_t* out, size_t n) {
+	size_t i = 0;
+#define COMPARE(intrinsic) VECTOR_LOOP(2, storeMask(out + i, _mm_movemask_pd(intrinsic(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))), 2))
+	switch (op) {
+		case TokenType::LESS: COMPARE(_mm_cmplt_pd) break;
+		case TokenType::GREATER: COMPARE(_mm_cmpgt_pd) break;
+		case TokenType::LESS_EQUAL: COMPARE(_mm_cmple_pd) break;
+		case TokenType::GREATER_EQUAL: COMPARE(_mm_cmpge_pd) break;
+		case TokenType::EQUAL_EQUAL: COMPARE(_mm_cmpeq_pd) break;
+		default: COMPARE(_mm_cmpneq_pd) break;
+	}
+#undef COMPARE
+	compareScalar(op, a, b, out, i, n);
+}
+
+// AVX2: four doubles or int64 per register, two registers make the eight lanes
+
+AVX2_TARGET static int64_t sumIntAvx2(const int64_t* a, size_t n) {
+	__m256i acc = _mm256_setzero_si256();
+	size_t i = 0;
+	VECTOR_LOOP(4, acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i))))
+	int64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+	return static_cast<int64_t>(static_cast<uint64_t>(sumIntScalar(lanes, 0, 4)) + static_cast<uint64_t>(sumIntScalar(a, i, n)));
+}
+
+AVX2_TARGET static double sumFloatAvx2(const double* a, size_t n) {
+	__m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+	size_t i = 0;
+	VECTOR_LOOP(LANES, acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i)); acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4)))
+	double lanes[LANES];
+	_mm256_storeu_pd(lanes, acc0); _mm256_storeu_pd(lanes + 4, acc1);
+	sumFloatLanes(lanes, a, i, n);
+	return addLanes(lanes);
+}
+
+AVX2_TARGET static double dotFloatAvx2(const double* a, const double* b, size_t n) {
+	__m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+	size_t i = 0;
+	VECTOR_LOOP(LANES,
+		acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+		acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4))))
+	double lanes[LANES];
+	_mm256_storeu_pd(lanes, acc0); _mm256_storeu_pd(lanes + 4, acc1);
+	dotFloatLanes(lanes, a, b, i, n);
+	return addLanes(lanes);
+}
+
+template <bool MIN> AVX2_TARGET static int64_t extremeIntAvx2(const int64_t* a, size_t n) {
+	__m256i acc = _mm256_set1_epi64x(a[0]);
+	size_t i = 0;
+	VECTOR_LOOP(4,
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		acc = _mm256_blendv_epi8(acc, x, MIN ? _mm256_cmpgt_epi64(acc, x) : _mm256_cmpgt_epi64(x, acc)))
+	int64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+	return extremeIntScalar<MIN>(a, i, n, extremeIntScalar<MIN>(lanes, 0, 4, lanes[0]));
+}
+
+template <bool MIN> AVX2_TARGET static double extremeFloatAvx2(const double* a, size_t n) {
+	__m256d acc0 = _mm256_set1_pd(a[0]), acc1 = acc0;
+	size_t i = 0;
+#define PICK(acc, offset) acc = MIN ? _mm256_min_pd(_mm256_loadu_pd(a + i + (offset)), acc) : _mm256_max_pd(_mm256_loadu_pd(a + i + (offset)), acc)
+	VECTOR_LOOP(LANES, PICK(acc0, 0); PICK(acc1, 4))
+#undef PICK
+	double lanes[LANES];
+	_mm256_storeu_pd(lanes, acc0); _mm256_storeu_pd(lanes + 4, acc1);
+	extremeFloatLanes<MIN>(lanes, a, i, n);
+	return pickLanes<MIN>(lanes);
+}
+
+AVX2_TARGET static void arithmeticIntAvx2(TokenType op, const int64_t* a, const int64_t* b, int64_t* out, size_t n) {
+	size_t i = 0;
+#define INT_OP(intrinsic) VECTOR_LOOP(4, _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), \
+	intrinsic(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)))))
+	if (op == TokenType::PLUS) INT_OP(_mm256_add_epi64)
+	else if (op == TokenType::MINUS) INT_OP(_mm256_sub_epi64)
+#undef INT_OP
+	arithmeticIntScalar(op, a, b, out, i, n);
+}
+
+AVX2_TARGET static void arithmeticFloatAvx2(TokenType op, const double* a, const double* b, double* out, size_t n) {
+	size_t i = 0;
+#define FLOAT_OP(intrinsic) VECTOR_LOOP(4, _mm256_storeu_pd(out + i, intrinsic(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i))))
+	switch (op) {
+		case TokenType::PLUS: FLOAT_OP(_mm256_add_pd) break;
+		case TokenType::MINUS: FLOAT_OP(_mm256_sub_pd) break;
+		case TokenType::MULTIPLY: FLOAT_OP(_mm256_mul_pd) break;
+		default: FLOAT_OP(_mm256_div_pd) break;
+	}
+#undef FLOAT_OP
+	arithmeticFloatScalar(op, a, b, out, i, n);
+}
+
+// Predicates are ordered and quiet like C++ comparisons, only != is true for NaN
+AVX2_TARGET static void compareFloatAvx2(TokenType op, const double* a, const double* b, uint8_t* out, size_t n) {
+	size_t i = 0;
+#define COMPARE(predicate) VECTOR_LOOP(4, storeMask(out + i, _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), predicate)), 4))
+	switch (op) {
+		case TokenType::LESS: COMPARE(_CMP_LT_OQ) break;
+		case TokenType::GREATER: COMPARE(_CMP_GT_OQ) break;
+		case TokenType::LESS_EQUAL: COMPARE(_CMP_LE_OQ) break;
+		case TokenType::GREATER_EQUAL: COMPARE(_CMP_GE_OQ) break;
+		case TokenType::EQUAL_EQUAL: COMPARE(_CMP_EQ_OQ) break;
+		default: COMPARE(_CMP_NEQ_UQ) break;
+	}
+#undef COMPARE
+	compareScalar(op, a, b, out, i, n);
+}
+
+// Greater than and equal give the six comparisons, inverting the mask for the other three
+AVX2_TARGET static void compareIntAvx2(TokenType op, const int64_t* a, const int64_t* b, uint8_t* out, size_t n) {
+	bool swap = op == TokenType::LESS || op == TokenType::GREATER_EQUAL;
+	bool equal = op == TokenType::EQUAL_EQUAL || op == TokenType::NOT_EQUAL;
+	int invert = (op == TokenType::LESS_EQUAL || op == TokenType::GREATER_EQUAL || op == TokenType::NOT_EQUAL) ? 0xF : 0;
+	size_t i = 0;
+	VECTOR_LOOP(4,
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		__m256i mask = equal ? _mm256_cmpeq_epi64(x, y) : swap ? _mm256_cmpgt_epi64(y, x) : _mm256_cmpgt_epi64(x, y);
+		storeMask(out + i, _mm256_movemask_pd(_mm256_castsi256_pd(mask)) ^ invert, 4))
+	compareScalar(op, a, b, out, i, n);
+}
+#undef VECTOR_LOOP
+#endif
+
+// Kernels at the current level
+
+#ifdef DLANG_SIMD_X86
+#define SSE2_OR(kernel) case SimdLevel::SSE2: return kernel;
+#define AVX2_OR(kernel) case SimdLevel::AVX2: return kernel;
+#else
+#define SSE2_OR(kernel)
+#define AVX2_OR(kernel)
+#endif
+
+int64_t sumInt(const int64_t* a, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(sumIntAvx2(a, n))
+		SSE2_OR(sumIntSse2(a, n))
+		default: return sumIntScalar(a, 0, n);
+	}
+}
+
+double sumFloat(const double* a, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(sumFloatAvx2(a, n))
+		SSE2_OR(sumFloatSse2(a, n))
+		default: {
+			double lanes[LANES] = {};
+			sumFloatLanes(lanes, a, 0, n);
+			return addLanes(lanes);
+		}
+	}
+}
+
+int64_t dotInt(const int64_t* a, const int64_t* b, size_t n) {
+	uint64_t sum = 0;
+	for (size_t i = 0; i < n; ++i) sum += static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i]);
+	return static_cast<int64_t>(sum);
+}
+
+double dotFloat(const double* a, const double* b, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(dotFloatAvx2(a, b, n))
+		SSE2_OR(dotFloatSse2(a, b, n))
+		default: {
+			double lanes[LANES] = {};
+			dotFloatLanes(lanes, a, b, 0, n);
+			return addLanes(lanes);
+		}
+	}
+}
+
+int64_t minInt(const int64_t* a, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(extremeIntAvx2<true>(a, n))
+		default: return extremeIntScalar<true>(a, 0, n, a[0]);
+	}
+}
+
+int64_t maxInt(const int64_t* a, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(extremeIntAvx2<false>(a, n))
+		default: return extremeIntScalar<false>(a, 0, n, a[0]);
+	}
+}
+
+template <bool MIN> static double extremeFloat(const double* a, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(extremeFloatAvx2<MIN>(a, n))
+		SSE2_OR(extremeFloatSse2<MIN>(a, n))
+		default: {
+			double lanes[LANES];
+			std::fill(lanes, lanes + LANES, a[0]);
+			extremeFloatLanes<MIN>(lanes, a, 0, n);
+			return pickLanes<MIN>(lanes);
+		}
+	}
+}
+
+double minFloat(const double* a, size_t n) { return extremeFloat<true>(a, n); }
+
+double maxFloat(const double* a, size_t n) { return extremeFloat<false>(a, n); }
+
+void arithmeticInt(TokenType op, const int64_t* a, const int64_t* b, int64_t* out, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(arithmeticIntAvx2(op, a, b, out, n))
+		SSE2_OR(arithmeticIntSse2(op, a, b, out, n))
+		default: return arithmeticIntScalar(op, a, b, out, 0, n);
+	}
+}
+
+void arithmeticFloat(TokenType op, const double* a, const double* b, double* out, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(arithmeticFloatAvx2(op, a, b, out, n))
+		SSE2_OR(arithmeticFloatSse2(op, a, b, out, n))
+		default: return arithmeticFloatScalar(op, a, b, out, 0, n);
+	}
+}
+
+void compareInt(TokenType op, const int64_t* a, const int64_t* b, uint8_t* out, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(compareIntAvx2(op, a, b, out, n))
+		default: return compareScalar(op, a, b, out, 0, n);
+	}
+}
+
+void compareFloat(TokenType op, const double* a, const double* b, uint8_t* out, size_t n) {
+	switch (simdLevel()) {
+		AVX2_OR(compareFloatAvx2(op, a, b, out, n))
+		SSE2_OR(compareFloatSse2(op, a, b, out, n))
+		default: return compareScalar(op, a, b, out, 0, n);
+	}
+}
+#undef SSE2_OR
+#undef AVX2_OR
@@ -0,0 +1,45 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include "../../Parser/Tokens/tokens.h"
+
+// Kernels of the numeric array builtins, on contiguous int64 and double buffers.
+// Each has a scalar version and, on x86-64, SSE2 and AVX2 versions picked at run time from what the CPU
+// supports. The environment variable DLANG_SIMD (scalar, sse2 or avx2) can lower the choice.
+//
+// Results don't depend on the level. Float sums and dot products add element i into lane i % 8 and then
+// add the 8 lanes in order, at every level; min and max are the same per lane reduction, which only
+// leaves it open which of 0.0 and -0.0 comes out. Int arithmetic wraps around.
+// Levels without a 64-bit instruction for an operation (int multiply, divide and dot everywhere,
+// int compare, min and max below AVX2) run the scalar loop.
+#if defined(__x86_64__) || defined(_M_X64)
+#define DLANG_SIMD_X86
+#endif
+
+// Each level includes the ones before it
+enum class SimdLevel : uint8_t { SCALAR, SSE2, AVX2 };
+
+const char* simdLevelName(SimdLevel level);
+SimdLevel supportedSimdLevel(); // Best level of this CPU and build, ignores DLANG_SIMD
+SimdLevel simdLevel(); // Level the kernels use
+void setSimdLevel(SimdLevel level); // Clamped to the supported level, for benchmarks
+
+int64_t sumInt(const int64_t* a, size_t n);
+double sumFloat(const double* a, size_t n);
+int64_t dotInt(const int64_t* a, const int64_t* b, size_t n);
+double dotFloat(const double* a, const double* b, size_t n);
+// n must not be 0. Float NaNs are skipped unless the first element is one, like a loop keeping x < min
+int64_t minInt(const int64_t* a, size_t n);
+int64_t maxInt(const int64_t* a, size_t n);
+double minFloat(const double* a, size_t n);
+double maxFloat(const double* a, size_t n);
+
+// out[i] = a[i] op b[i] for PLUS, MINUS, MULTIPLY, DIVIDE. Int division expects no zero in b
+void arithmeticInt(TokenType op, const int64_t* a, const int64_t* b, int64_t* out, size_t n);
+void arithmeticFloat(TokenType op, const double* a, const double* b, double* out, size_t n);
+// out[i] = a[i] op b[i] as 0 or 1 for LESS, GREATER, LESS_EQUAL, GREATER_EQUAL, EQUAL_EQUAL, NOT_EQUAL
+void compareInt(TokenType op, const int64_t* a, const int64_t* b, uint8_t* out, size_t n);
+void compareFloat(TokenType op, const double* a, const double* b, uint8_t* out, size_t n);
+#endif // !SIMD_H
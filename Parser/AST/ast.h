@@ -1,286 +1,308 @@
 #ifndef AST_H
 #define AST_H
 
+#include <charconv>
+#include <span>
 #include <sstream>
+#include <string_view>
 #include <vector>
 #include "../Lexer/Lexer.h"
-#include "../../Object/Array/darray.h"
-
-class IntNode;
-class FloatNode;
-class StrNode;
-class ArrayNode;
-class IdNode;
-class BinOpNode;
-class UnOpNode;
-class FullVarDeclNode;
-class EmptyVarDeclNode;
-class ReasignVarNode;
-class IfStmtNode;
-class WhileStmtNode;
-class BlockOfCodeNode;
-class FuncNode;
-class FuncParamNode;
-class IncDecNode;
-// class FuncCallNode;
-
-// Interface for AstPrinter
-struct PrintVisitor {
-	virtual std::stringstream visit(IntNode* node, int deep) = 0;
-	virtual std::stringstream visit(FloatNode* node, int deep) = 0;
-	virtual std::stringstream visit(StrNode* node, int deep) = 0;
-	virtual std::stringstream visit(ArrayNode* node, int deep) = 0;
-	virtual std::stringstream visit(IdNode* node, int deep) = 0;
-	virtual std::stringstream visit(UnOpNode* node, int deep) = 0;
-	virtual std::stringstream visit(BinOpNode* node, int deep) = 0;
-	virtual std::stringstream visit(EmptyVarDeclNode* node, int deep) = 0;
-	virtual std::stringstream visit(FullVarDeclNode* node, int deep) = 0;
-	virtual std::stringstream visit(ReasignVarNode* node, int deep) = 0;
-	virtual std::stringstream visit(BlockOfCodeNode* node, int deep) = 0;
-	virtual std::stringstream visit(IfStmtNode* node, int deep) = 0;
-	virtual std::stringstream visit(WhileStmtNode* node, int deep) = 0;
-	virtual std::stringstream visit(FuncNode* node, int deep) = 0;
-	virtual std::stringstream visit(FuncParamNode* node, int deep) = 0;
-	virtual std::stringstream visit(IncDecNode* node, int deep) = 0;
-	// virtual std::stringstream visit(FuncCallNode* node, int deep) = 0;
-};
 
-// Interface for Interpreter
-struct Visitor {
-	virtual void visit(IntNode* node) = 0;
-	virtual void visit(FloatNode* node) = 0;
-	virtual void visit(StrNode* node) = 0;
-	virtual void visit(ArrayNode* node) = 0;
-	virtual void visit(IdNode* node) = 0;
-	virtual void visit(UnOpNode* node) = 0;
-	virtual void visit(BinOpNode* node) = 0;
-	virtual void visit(EmptyVarDeclNode* node) = 0;
-	virtual void visit(FullVarDeclNode* node) = 0;
-	virtual void visit(ReasignVarNode* node) = 0;
-	virtual void visit(BlockOfCodeNode* node) = 0;
-	virtual void visit(IfStmtNode* node) = 0;
-	virtual void visit(WhileStmtNode* node) = 0;
-	virtual void visit(FuncNode* node) = 0;
-	virtual void visit(FuncParamNode* node) = 0;
-	virtual void visit(IncDecNode* node) = 0;
-	// virtual void visit(FuncCallNode* node) = 0;
+// One per node class, the set is closed: passes switch on it through dispatch() instead of calling virtual functions
+enum class NodeKind : uint8_t { INT, FLOAT, STR, ARRAY, ID, UN_OP, BIN_OP, EMPTY_VAR_DECL, FULL_VAR_DECL, REASIGN_VAR,
+	BLOCK_OF_CODE, IF_STMT, WHILE_STMT, FUNC, FUNC_PARAM, INC_DEC, FUNC_CALL, RETURN_STMT, COUNT };
+
+// Class name of every kind, for stats and dumps
+constexpr const char* NODE_KIND_NAMES[] = {
+	"IntNode", "FloatNode", "StrNode", "ArrayNode", "IdNode", "UnOpNode", "BinOpNode", "EmptyVarDeclNode", "FullVarDeclNode",
+	"ReasignVarNode", "BlockOfCodeNode", "IfStmtNode", "WhileStmtNode", "FuncNode", "FuncParamNode", "IncDecNode", "FuncCallNode", "ReturnStmtNode"
 };
+static_assert(std::size(NODE_KIND_NAMES) == static_cast<size_t>(NodeKind::COUNT));
 
+// Runtime type of a value, defined with the values (Interpreter/value.h). Nodes only store it
+enum class ValueType : uint8_t;
+
+// Nodes are allocated from the parser's arena. Keep them trivially destructible
+// (std::span for child lists, std::string_view for text) so releasing a compilation stays cheap.
+// Nodes have no virtual functions, kind tells what class a node is and every class has its KIND.
 struct AST {
-	virtual std::stringstream handler(PrintVisitor* print_visitor, int deep) = 0;
-	virtual void handler(Visitor* visitor) = 0;
+	NodeKind kind;
+
+	AST(NodeKind kind): kind(kind) {}
 };
 
+// Value of an int (int64_t) or float (double) literal, false when the text is out of range.
+// The parsers reject such literals, so every backend reads the same value from a token
+template <typename T>
+bool parseLiteral(std::string_view text, T& value) {
+	auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	return error == std::errc() && end == text.data() + text.size();
+}
+
 // Node for int
 class IntNode: public AST {
 public:
-	int value;
+	static constexpr NodeKind KIND = NodeKind::INT;
+	int64_t value;
 	size_t line, column;
 	TokenType type;
 
 public:
-	IntNode(Token* token)
-		: value(std::stoi(token->value)), line(token->line), column(token->column), type(token->type) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override{ visitor->visit(this); }
+	IntNode(Token* token, int64_t value) // value parsed from token
+		: AST(KIND), value(value), line(token->line), column(token->column), type(token->type) {}
+	IntNode(int64_t value, size_t line, size_t column) // Literal computed at compile time
+		: AST(KIND), value(value), line(line), column(column), type(TokenType::INT) {}
 };
 
 // Node for float
 class FloatNode: public AST {
 public:
-	float value;
+	static constexpr NodeKind KIND = NodeKind::FLOAT;
+	double value;
 	size_t line, column;
 	TokenType type;
 
 public:
-	FloatNode(Token* token) 
-		: value(std::stof(token->value)), line(token->line), column(token->column), type(token->type) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+	FloatNode(Token* token, double value) // value parsed from token
+		: AST(KIND), value(value), line(token->line), column(token->column), type(token->type) {}
+	FloatNode(double value, size_t line, size_t column) // Literal computed at compile time
+		: AST(KIND), value(value), line(line), column(column), type(TokenType::FLOAT) {}
 };
 
 // Node for string
 class StrNode: public AST{
 public:
-	std::string value;
+	static constexpr NodeKind KIND = NodeKind::STR;
+	std::string_view value;
 	size_t line, column;
 	TokenType type;
 
 public:
 	StrNode(Token* token) 
-		: value(token->value), line(token->line), column(token->column), type(token->type) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), value(token->value), line(token->line), column(token->column), type(token->type) {}
 };
 
 // Node for array
 class ArrayNode: public AST{
 public:
-	DArray array;
+	static constexpr NodeKind KIND = NodeKind::ARRAY;
+	std::span<Token*> elements; // Literal tokens of one type, checked by the parser
 
 public:
-	ArrayNode(std::vector<Token*> array)
-		: array(array){}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+	ArrayNode(std::span<Token*> elements)
+		: AST(KIND), elements(elements){}
 };
 
+class EmptyVarDeclNode;
+
 // Node for identifiers
 class IdNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::ID;
+	bool is_global = false; // Set by Resolver with slot and declaration, it fits next to kind
 	Token* identifier;
+	SymbolId symbol; // Interned name, compare this instead of identifier->value
+	int32_t slot = -1; // Index of the variable in the globals or the frame, -1 for function names
+	EmptyVarDeclNode* declaration = nullptr; // Of the variable, the declaration's own IdNode points to it too
 
 public:
 	IdNode(Token* token) 
-		: identifier(token) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), identifier(token), symbol(token->symbol) {}
 };
 
 // Node for Unary operations
 class UnOpNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::UN_OP;
+	ValueType operand_type{}; // Static type of right, set by TypeChecker, NONE if only known at run time
 	Token* operation;
 	AST* right;
 
 public:
 	UnOpNode(Token* operation, AST* expression)
-		: right(expression), operation(operation) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), right(expression), operation(operation) {}
 };
 
 // Node for Binary operations
 class BinOpNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::BIN_OP;
+	ValueType left_type{}, right_type{}; // Same as UnOpNode::operand_type, they fit next to kind
 	AST* left;
 	AST* right;
 	Token* operation;
 
 public:
 	BinOpNode(AST* left, Token* operation, AST* right)
-		: left(left), operation(operation), right(right) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), left(left), operation(operation), right(right) {}
 };
 
 // Node for Variable declaration statement
 class EmptyVarDeclNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::EMPTY_VAR_DECL;
 	Token* key_word;
 	Token* var_type;
 	IdNode* identifier;
 
 public:
 	EmptyVarDeclNode(Token* key_word, IdNode* identifier, Token* var_type)
-		: key_word(key_word), identifier(identifier), var_type(var_type) {} // -> key_word id: type;
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), key_word(key_word), identifier(identifier), var_type(var_type) {} // -> key_word id: type;
 };
 
 // Node for Variable declaration statement
 class FullVarDeclNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::FULL_VAR_DECL;
 	EmptyVarDeclNode* declaration;
 	Token* assign;
 	AST* expr;
 
 public:
 	FullVarDeclNode(EmptyVarDeclNode* declaration, Token* assign, AST* expr) 
-		: declaration(declaration), assign(assign), expr(expr) {} // -> key_word id: type = expr;
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), declaration(declaration), assign(assign), expr(expr) {} // -> key_word id: type = expr;
 };
 
 // Node for Variable reasigment statement
 class ReasignVarNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::REASIGN_VAR;
 	IdNode* identifier;
 	Token* assign;
 	AST* expr;
 
 public:
 	ReasignVarNode(IdNode* identifier, Token* assign, AST* expr) 
-		: identifier(identifier), assign(assign), expr(expr) {} // -> id = expr; || id [+ - * /]= expr;
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), identifier(identifier), assign(assign), expr(expr) {} // -> id = expr; || id [+ - * /]= expr;
 };
 
 // Node for list of statements
 class BlockOfCodeNode: public AST {
 public:
-	std::vector<AST*> list;
+	static constexpr NodeKind KIND = NodeKind::BLOCK_OF_CODE;
+	std::span<AST*> list;
 
 public:
-	BlockOfCodeNode(std::vector<AST*> list)
-		: list(std::move(list)) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+	BlockOfCodeNode(std::span<AST*> list)
+		: AST(KIND), list(list) {}
 };
 
 // Node for if statement
 class IfStmtNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::IF_STMT;
 	AST* condition;
 	BlockOfCodeNode* code_to_execute;
 
 public:
 	IfStmtNode(AST* condition, BlockOfCodeNode* code_to_execute)
-		: condition(condition), code_to_execute(code_to_execute) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), condition(condition), code_to_execute(code_to_execute) {}
 };
 
 // Node for while statement
 class WhileStmtNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::WHILE_STMT;
 	AST* condition;
 	BlockOfCodeNode* code_to_execute;
 
 public:
 	WhileStmtNode(AST* condition, BlockOfCodeNode* code_to_execute)
-		: condition(condition), code_to_execute(code_to_execute) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), condition(condition), code_to_execute(code_to_execute) {}
 };
 
 // Node for functions statement
-class FuncNode: public AST {
+class FuncParamNode: public AST {
 public:
-	IdNode* func_name;
-	FuncParamNode* params;
-	Token* func_return_type;
-	BlockOfCodeNode* code_to_execute;
+	static constexpr NodeKind KIND = NodeKind::FUNC_PARAM;
+	std::span<EmptyVarDeclNode*> params;
 
 public:
-	FuncNode(IdNode* func_name, FuncParamNode* params, Token* func_return_type, BlockOfCodeNode* code_to_execute)
-		: func_name(func_name), params(params), func_return_type(func_return_type), code_to_execute(code_to_execute) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+	FuncParamNode(std::span<EmptyVarDeclNode*> params)
+		: AST(KIND), params(params) {}
 };
 
 // Node for functions statement
-class FuncParamNode: public AST {
+class FuncNode: public AST {
 public:
-	std::vector<EmptyVarDeclNode*> params;
+	static constexpr NodeKind KIND = NodeKind::FUNC;
+	int32_t num_locals = 0; // Frame slots of the body, parameters first, set by Resolver
+	IdNode* func_name;
+	FuncParamNode* params;
+	Token* func_return_type;
+	BlockOfCodeNode* code_to_execute;
 
 public:
-	FuncParamNode(std::vector<EmptyVarDeclNode*> params)
-		: params(params) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+	FuncNode(IdNode* func_name, FuncParamNode* params, Token* func_return_type, BlockOfCodeNode* code_to_execute)
+		: AST(KIND), func_name(func_name), params(params), func_return_type(func_return_type), code_to_execute(code_to_execute) {}
 };
 
 // Node for increment, decrement
 class IncDecNode: public AST {
 public:
+	static constexpr NodeKind KIND = NodeKind::INC_DEC;
 	IdNode* identifier;
 	Token* operation;
 
 public:
 	IncDecNode(IdNode* id, Token* operation)
-		: identifier(id), operation(operation) {}
-	std::stringstream handler(PrintVisitor* print_visitor, int deep) override { return print_visitor->visit(this, deep); }
-	void handler(Visitor* visitor) override { visitor->visit(this); }
+		: AST(KIND), identifier(id), operation(operation) {}
+};
+
+// Node for function call
+class FuncCallNode: public AST {
+public:
+	static constexpr NodeKind KIND = NodeKind::FUNC_CALL;
+	IdNode* func_name;
+	std::span<AST*> args;
+
+public:
+	FuncCallNode(IdNode* func_name, std::span<AST*> args)
+		: AST(KIND), func_name(func_name), args(args) {} // -> id(expr, ...)
 };
+
+// Node for return statement
+class ReturnStmtNode: public AST {
+public:
+	static constexpr NodeKind KIND = NodeKind::RETURN_STMT;
+	Token* key_word;
+	AST* expr;
+
+public:
+	ReturnStmtNode(Token* key_word, AST* expr)
+		: AST(KIND), key_word(key_word), expr(expr) {} // -> return expr; || return;
+};
+
+// Calls visit(node) with node cast to its class and returns what it returns. One switch the compiler can
+// inline into the pass, where the visitor interfaces needed two virtual calls per node. visit is usually a
+// generic lambda forwarding to overloads: dispatch(ast, [this](auto* node) { visit(node); })
+template<typename Visit>
+decltype(auto) dispatch(AST* node, Visit&& visit) {
+	switch (node->kind) {
+		case NodeKind::INT: return visit(static_cast<IntNode*>(node));
+		case NodeKind::FLOAT: return visit(static_cast<FloatNode*>(node));
+		case NodeKind::STR: return visit(static_cast<StrNode*>(node));
+		case NodeKind::ARRAY: return visit(static_cast<ArrayNode*>(node));
+		case NodeKind::ID: return visit(static_cast<IdNode*>(node));
+		case NodeKind::UN_OP: return visit(static_cast<UnOpNode*>(node));
+		case NodeKind::BIN_OP: return visit(static_cast<BinOpNode*>(node));
+		case NodeKind::EMPTY_VAR_DECL: return visit(static_cast<EmptyVarDeclNode*>(node));
+		case NodeKind::FULL_VAR_DECL: return visit(static_cast<FullVarDeclNode*>(node));
+		case NodeKind::REASIGN_VAR: return visit(static_cast<ReasignVarNode*>(node));
+		case NodeKind::BLOCK_OF_CODE: return visit(static_cast<BlockOfCodeNode*>(node));
+		case NodeKind::IF_STMT: return visit(static_cast<IfStmtNode*>(node));
+		case NodeKind::WHILE_STMT: return visit(static_cast<WhileStmtNode*>(node));
+		case NodeKind::FUNC: return visit(static_cast<FuncNode*>(node));
+		case NodeKind::FUNC_PARAM: return visit(static_cast<FuncParamNode*>(node));
+		case NodeKind::INC_DEC: return visit(static_cast<IncDecNode*>(node));
+		case NodeKind::FUNC_CALL: return visit(static_cast<FuncCallNode*>(node));
+		default: return visit(static_cast<ReturnStmtNode*>(node)); // RETURN_STMT, nodes never hold another kind
+	}
+}
+
+// node as a Node, nullptr if it is null or of another class. Replaces dynamic_cast, nodes have no vtable
+template<typename Node>
+Node* nodeCast(AST* node) {
+	return (node && node->kind == Node::KIND) ? static_cast<Node*>(node) : nullptr;
+}
 #endif // !AST_H
\ No newline at end of file
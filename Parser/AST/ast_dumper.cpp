@@ -0,0 +1,343 @@
+#include <bit>
+#include <cmath>
+#include "ast_dumper.h"
+#include "flat_ast.h"
+
+void JSONDumper::dump(const std::vector<AST*>& ast, std::ostream& out) {
+	OutputBuffer buffer(out);
+	m_out = &buffer;
+	buffer << "[";
+	for (size_t i = 0; i < ast.size(); ++i) {
+		buffer << (i ? ",\n" : "\n");
+		show(ast[i]);
+	}
+	buffer << "\n]\n";
+	buffer.flush();
+}
+
+void JSONDumper::show(AST* node) {
+	if (node) dispatch(node, [this](auto* child) { visit(child); });
+	else *m_out << "null";
+}
+
+void JSONDumper::string(std::string_view text) {
+	static constexpr char HEX[] = "0123456789abcdef";
+	m_out->put('"');
+	for (char c : text) {
+		unsigned char byte = static_cast<unsigned char>(c);
+		if (c == '"' || c == '\\') *m_out << '\\' << c;
+		else if (byte < 0x20) *m_out << "\\u00" << HEX[byte >> 4] << HEX[byte & 15];
+		else m_out->put(c);
+	}
+	m_out->put('"');
+}
+
+void JSONDumper::begin(AST* node, const Token* position) {
+	*m_out << "{\"kind\":\"" << NODE_KIND_NAMES[static_cast<size_t>(node->kind)] << "\"";
+	if (position) *m_out << ",\"line\":" << position->line << ",\"column\":" << position->column;
+}
+
+template<typename T>
+void JSONDumper::list(const char* name, std::span<T*> nodes) {
+	field(name);
+	m_out->put('[');
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (i) m_out->put(',');
+		show(nodes[i]);
+	}
+	m_out->put(']');
+}
+
+void JSONDumper::visit(IntNode* node) {
+	*m_out << "{\"kind\":\"IntNode\",\"line\":" << node->line << ",\"column\":" << node->column << ",\"value\":" << node->value << "}";
+}
+
+// Folding can make inf or nan, which JSON has no number for
+void JSONDumper::visit(FloatNode* node) {
+	*m_out << "{\"kind\":\"FloatNode\",\"line\":" << node->line << ",\"column\":" << node->column << ",\"value\":";
+	if (std::isfinite(node->value)) {
+		char digits[32];
+		auto [end, error] = std::to_chars(digits, digits + sizeof(digits), node->value);
+		m_out->write(digits, end - digits);
+	}
+	else *m_out << "null";
+	m_out->put('}');
+}
+
+void JSONDumper::visit(StrNode* node) {
+	*m_out << "{\"kind\":\"StrNode\",\"line\":" << node->line << ",\"column\":" << node->column << ",\"value\":";
+	string(node->value);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(ArrayNode* node) {
+	std::span<Token*> elements = node->elements;
+	begin(node, elements.empty() ? nullptr : elements[0]);
+	field("array");
+	m_out->put('[');
+	for (size_t i = 0; i < elements.size(); ++i) {
+		if (i) m_out->put(',');
+		string(elements[i]->value);
+	}
+	*m_out << "]}";
+}
+
+void JSONDumper::visit(IdNode* node) {
+	begin(node, node->identifier);
+	field("identifier");
+	string(node->identifier->value);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(UnOpNode* node) {
+	begin(node, node->operation);
+	field("operation");
+	string(node->operation->value);
+	field("right");
+	show(node->right);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(BinOpNode* node) {
+	begin(node, node->operation);
+	field("left");
+	show(node->left);
+	field("operation");
+	string(node->operation->value);
+	field("right");
+	show(node->right);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(EmptyVarDeclNode* node) {
+	begin(node, node->key_word);
+	field("key_word");
+	string(node->key_word->value);
+	field("identifier");
+	show(node->identifier);
+	field("var_type");
+	string(node->var_type->value);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(FullVarDeclNode* node) {
+	begin(node, node->assign);
+	field("declaration");
+	show(node->declaration);
+	field("assign");
+	string(node->assign->value);
+	field("expr");
+	show(node->expr);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(ReasignVarNode* node) {
+	begin(node, node->assign);
+	field("identifier");
+	show(node->identifier);
+	field("assign");
+	string(node->assign->value);
+	field("expr");
+	show(node->expr);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(BlockOfCodeNode* node) {
+	begin(node, nullptr);
+	list("list", node->list);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(IfStmtNode* node) {
+	begin(node, nullptr);
+	field("condition");
+	show(node->condition);
+	field("code_to_execute");
+	show(node->code_to_execute);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(WhileStmtNode* node) {
+	begin(node, nullptr);
+	field("condition");
+	show(node->condition);
+	field("code_to_execute");
+	show(node->code_to_execute);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(FuncNode* node) {
+	begin(node, nullptr);
+	field("func_name");
+	show(node->func_name);
+	field("params");
+	show(node->params);
+	field("func_return_type");
+	string(node->func_return_type->value);
+	field("code_to_execute");
+	show(node->code_to_execute);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(FuncParamNode* node) {
+	begin(node, nullptr);
+	list("params", node->params);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(IncDecNode* node) {
+	begin(node, node->operation);
+	field("identifier");
+	show(node->identifier);
+	field("operation");
+	string(node->operation->value);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(FuncCallNode* node) {
+	begin(node, nullptr);
+	field("func_name");
+	show(node->func_name);
+	list("args", node->args);
+	m_out->put('}');
+}
+
+void JSONDumper::visit(ReturnStmtNode* node) {
+	begin(node, node->key_word);
+	field("expr");
+	show(node->expr);
+	m_out->put('}');
+}
+
+void BinaryDumper::dump(const std::vector<AST*>& ast, std::ostream& out) {
+	OutputBuffer buffer(out);
+	m_out = &buffer;
+	buffer.write(DUMP_MAGIC, sizeof(DUMP_MAGIC));
+	buffer.put(static_cast<char>(DUMP_FORMAT_VERSION));
+	varint(ast.size());
+	for (AST* root : ast) show(root);
+	buffer.flush();
+}
+
+void BinaryDumper::show(AST* node) {
+	if (!node) { m_out->put(static_cast<char>(NO_NODE_BYTE)); return; }
+	m_out->put(static_cast<char>(node->kind));
+	dispatch(node, [this](auto* child) { visit(child); });
+}
+
+void BinaryDumper::varint(uint64_t value) {
+	while (value >= 0x80) {
+		m_out->put(static_cast<char>(value | 0x80));
+		value >>= 7;
+	}
+	m_out->put(static_cast<char>(value));
+}
+
+void BinaryDumper::text(std::string_view text) {
+	varint(text.size());
+	m_out->write(text.data(), text.size());
+}
+
+void BinaryDumper::token(const Token* token) {
+	m_out->put(static_cast<char>(token->type));
+	varint(token->line);
+	varint(token->column);
+	if (tokenSpelling(token->type).empty()) text(token->value);
+}
+
+template<typename T>
+void BinaryDumper::list(std::span<T*> nodes) {
+	varint(nodes.size());
+	for (T* node : nodes) show(node);
+}
+
+void BinaryDumper::visit(IntNode* node) {
+	signedVarint(node->value);
+	varint(node->line);
+	varint(node->column);
+}
+
+void BinaryDumper::visit(FloatNode* node) {
+	uint64_t bits = std::bit_cast<uint64_t>(node->value);
+	for (int shift = 0; shift < 64; shift += 8) m_out->put(static_cast<char>(bits >> shift));
+	varint(node->line);
+	varint(node->column);
+}
+
+void BinaryDumper::visit(StrNode* node) {
+	text(node->value);
+	varint(node->line);
+	varint(node->column);
+}
+
+void BinaryDumper::visit(ArrayNode* node) {
+	varint(node->elements.size());
+	for (const Token* element : node->elements) token(element);
+}
+
+void BinaryDumper::visit(IdNode* node) { token(node->identifier); }
+
+void BinaryDumper::visit(UnOpNode* node) {
+	token(node->operation);
+	show(node->right);
+}
+
+void BinaryDumper::visit(BinOpNode* node) {
+	show(node->left);
+	token(node->operation);
+	show(node->right);
+}
+
+void BinaryDumper::visit(EmptyVarDeclNode* node) {
+	token(node->key_word);
+	show(node->identifier);
+	token(node->var_type);
+}
+
+void BinaryDumper::visit(FullVarDeclNode* node) {
+	show(node->declaration);
+	token(node->assign);
+	show(node->expr);
+}
+
+void BinaryDumper::visit(ReasignVarNode* node) {
+	show(node->identifier);
+	token(node->assign);
+	show(node->expr);
+}
+
+void BinaryDumper::visit(BlockOfCodeNode* node) { list(node->list); }
+
+void BinaryDumper::visit(IfStmtNode* node) {
+	show(node->condition);
+	show(node->code_to_execute);
+}
+
+void BinaryDumper::visit(WhileStmtNode* node) {
+	show(node->condition);
+	show(node->code_to_execute);
+}
+
+void BinaryDumper::visit(FuncNode* node) {
+	show(node->func_name);
+	show(node->params);
+	token(node->func_return_type);
+	show(node->code_to_execute);
+}
+
+void BinaryDumper::visit(FuncParamNode* node) { list(node->params); }
+
+void BinaryDumper::visit(IncDecNode* node) {
+	show(node->identifier);
+	token(node->operation);
+}
+
+void BinaryDumper::visit(FuncCallNode* node) {
+	show(node->func_name);
+	list(node->args);
+}
+
+void BinaryDumper::visit(ReturnStmtNode* node) {
+	token(node->key_word);
+	show(node->expr);
+}
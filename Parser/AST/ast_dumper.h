@@ -0,0 +1,107 @@
+#ifndef AST_DUMPER_H
+#define AST_DUMPER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "ast.h"
+#include "../../Source/output_buffer.h"
+
+// Machine readable dumps of a tree for tools. Both write in one preorder pass through an OutputBuffer,
+// so dumping is linear in the nodes and needs the buffer plus a stack frame per level of nesting.
+
+// JSON: an array with one object per root, one root per line. An object has "kind" (the class name),
+// the node's fields under their member names and "line" and "column" when the node has a token.
+// Tokens are their text, a missing child is null.
+class JSONDumper {
+private:
+	OutputBuffer* m_out = nullptr;
+
+private:
+	void show(AST* node);
+	void string(std::string_view text); // Quoted and escaped
+	void begin(AST* node, const Token* position); // Opens the object, position may be null
+	void field(const char* name) { *m_out << ",\"" << name << "\":"; }
+	template<typename T>
+	void list(const char* name, std::span<T*> nodes);
+
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	void dump(const std::vector<AST*>& ast, std::ostream& out = std::cout);
+};
+
+// Binary: magic, version byte, varint root count, then every root as a node.
+// A node is its kind byte (NO_NODE_BYTE for a missing child) followed by its fields in the order below,
+// children inline in preorder. Numbers are LEB128 varints, signed ones zigzag encoded first. Text is a
+// varint length and the bytes. A token is its type byte, line and column, then its text if tokenSpelling
+// of its type is empty (names, literals and types, the lexer always spells the others the same).
+//   INT             value, line, column            FLOAT  8 byte little endian IEEE value, line, column
+//   STR             text, line, column             ARRAY  count, count tokens
+//   ID              token
+//   UN_OP           token, operand                 BIN_OP left, token, right
+//   EMPTY_VAR_DECL  key token, id, type token
+//   FULL_VAR_DECL   declaration, assign token, expression
+//   REASIGN_VAR     id, assign token, expression
+//   BLOCK_OF_CODE   count, statements              FUNC_PARAM  count, declarations
+//   IF_STMT         condition, block               WHILE_STMT  condition, block
+//   FUNC            id, parameters, return type token, block
+//   INC_DEC         id, token                      FUNC_CALL   id, count, arguments
+//   RETURN_STMT     key token, expression
+constexpr char DUMP_MAGIC[4] = { 'D', 'L', 'A', 'D' };
+constexpr uint8_t DUMP_FORMAT_VERSION = 2;
+constexpr uint8_t NO_NODE_BYTE = 0xFF;
+
+class BinaryDumper {
+private:
+	OutputBuffer* m_out = nullptr;
+
+private:
+	void show(AST* node);
+	void varint(uint64_t value);
+	void signedVarint(int64_t value) { varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+	void text(std::string_view text);
+	void token(const Token* token);
+	template<typename T>
+	void list(std::span<T*> nodes);
+
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	void dump(const std::vector<AST*>& ast, std::ostream& out = std::cout);
+};
+#endif // !AST_DUMPER_H
@@ -0,0 +1,122 @@
+#include "ast_printer.h"
+
+// Mirrors the visit functions in the header case by case
+void ASTPrinter::write(const FlatAST& ast, NodeId node, size_t deep) {
+	OutputBuffer& out = *m_out;
+	if (node == NO_NODE) { out << "null"; return; }
+	Spaces pad{ deep + 3 };
+	switch (ast.kind(node)) {
+		case NodeKind::INT:
+			out << "IntNode(" << ast.intValue(node) << ")";
+			break;
+		case NodeKind::FLOAT:
+			out << "FloatNode(" << std::to_string(ast.floatValue(node)) << ")";
+			break;
+		case NodeKind::STR:
+			out << "StrNode(" << ast.strValue(node) << ")";
+			break;
+		case NodeKind::ARRAY: {
+			std::span<const FlatLiteral> elements = ast.elements(node);
+			out << "ArrayNode(";
+			for (size_t i = 0; i < elements.size(); ++i) out << elements[i].text() << ((i == elements.size() - 1) ? '\0' : ',');
+			out << ")";
+			break;
+		}
+		case NodeKind::ID:
+			out << "IdNode(" << ast.name(ast.lhs(node)) << ")";
+			break;
+		case NodeKind::UN_OP:
+			out << "UnOpNode ->\n" << pad << "Op(" << ast.tokenText(node) << ")\n" << pad << "Expr(";
+			write(ast, ast.lhs(node), deep + 3);
+			out << ")";
+			break;
+		case NodeKind::BIN_OP:
+			out << "BinOpNode ->\n" << pad << "Left(";
+			write(ast, ast.lhs(node), deep + 3);
+			out << ")\n" << pad << "Op(" << ast.tokenText(node) << ")\n" << pad << "Right(";
+			write(ast, ast.rhs(node), deep + 3);
+			out << ")";
+			break;
+		case NodeKind::EMPTY_VAR_DECL:
+			out << "EmptyVarDeclNode ->\n" << pad << "Key(" << ast.tokenText(node) << ")\n" << pad;
+			write(ast, ast.lhs(node), deep + 3);
+			out << "\n" << pad << "Type(" << ast.name(ast.rhs(node)) << ")\n";
+			break;
+		case NodeKind::FULL_VAR_DECL:
+			out << "FullVarDeclNode ->\n" << pad;
+			write(ast, ast.lhs(node), deep + 3);
+			out << pad << "Assign(" << ast.tokenText(node) << ")\n" << pad;
+			write(ast, ast.rhs(node), deep + 3);
+			out << "\n";
+			break;
+		case NodeKind::REASIGN_VAR:
+			out << "ReasignNode ->\n" << pad;
+			write(ast, ast.lhs(node), deep + 3);
+			out << "\n" << pad << "Op(" << ast.tokenText(node) << ")\n" << pad;
+			write(ast, ast.rhs(node), deep + 3);
+			out << "\n";
+			break;
+		case NodeKind::BLOCK_OF_CODE:
+		case NodeKind::FUNC_PARAM: {
+			std::span<const NodeId> list = ast.list(node);
+			out << (ast.kind(node) == NodeKind::BLOCK_OF_CODE ? "StmtListNode ->" : "FuncParamNode ->") << (list.empty() ? " null\n" : "\n");
+			for (NodeId item : list) {
+				if (item == NO_NODE) continue;
+				out << pad;
+				write(ast, item, deep + 3);
+			}
+			break;
+		}
+		case NodeKind::IF_STMT:
+		case NodeKind::WHILE_STMT: {
+			bool is_if = ast.kind(node) == NodeKind::IF_STMT;
+			out << (is_if ? "IfNode ->\n" : "WhileNode ->\n") << pad << (is_if ? "Condition - >" : "Condition ->");
+			if (ast.lhs(node) != NO_NODE) {
+				out << "\n" << Spaces{ deep + 6 };
+				write(ast, ast.lhs(node), deep + 6);
+			}
+			else out << " null";
+			if (ast.rhs(node) != NO_NODE) {
+				out << "\n" << pad;
+				write(ast, ast.rhs(node), deep + 3);
+			}
+			break;
+		}
+		case NodeKind::FUNC:
+			out << "FuncNode ->\n" << pad;
+			write(ast, ast.lhs(node), deep + 3);
+			out << "\n" << pad;
+			write(ast, ast.rhs(node), deep + 3);
+			out << pad << "RetType(" << ast.name(ast.extra(ast.rhs(node))) << ")\n" << pad;
+			write(ast, ast.extra(node), deep + 3);
+			break;
+		case NodeKind::INC_DEC:
+			out << "IncDecNode\n" << pad;
+			write(ast, ast.lhs(node), deep + 3);
+			out << "\n" << pad << "Op(" << ast.tokenText(node) << ")\n";
+			break;
+		case NodeKind::FUNC_CALL: {
+			std::span<const NodeId> args = ast.list(node);
+			out << "FuncCallNode ->\n" << pad;
+			write(ast, ast.lhs(node), deep + 3);
+			out << "\n" << pad << "Args ->" << (args.empty() ? " null" : "");
+			for (NodeId arg : args) {
+				if (arg == NO_NODE) continue;
+				out << "\n" << Spaces{ deep + 6 };
+				write(ast, arg, deep + 6);
+			}
+			break;
+		}
+		case NodeKind::RETURN_STMT:
+			out << "ReturnNode ->";
+			if (ast.lhs(node) != NO_NODE) {
+				out << "\n" << pad;
+				write(ast, ast.lhs(node), deep + 3);
+				out << "\n";
+			}
+			else out << " null\n";
+			break;
+		default:
+			break;
+	}
+}
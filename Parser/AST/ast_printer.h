@@ -3,187 +3,225 @@
 
 #include <iostream>
 #include "ast.h"
+#include "flat_ast.h"
+#include "../../Source/output_buffer.h"
 
-class ASTPrinter: public PrintVisitor {
+// Prints a tree as indented text in one pass: every node appends to one OutputBuffer, which hands
+// the stream fixed size chunks, so the cost is linear in the output and the memory doesn't grow with it.
+class ASTPrinter {
 private:
+	OutputBuffer* m_out = nullptr;
+
+private:
+	// A missing child prints as null
+	void show(AST* node, size_t deep) {
+		if (node) dispatch(node, [&](auto* child) { visit(child, deep); });
+		else *m_out << "null";
+	}
+
 	// Print Int node
-	std::stringstream visit(IntNode* node, int deep) override{
-		std::stringstream stream;
-		stream << "IntNode(" << ((node) ? std::to_string(node->value) : "null") << ")";
-		return stream;
+	void visit(IntNode* node, size_t) {
+		*m_out << "IntNode(" << node->value << ")";
 	}
 
 	// Print Float node
-	std::stringstream visit(FloatNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "FloatNode(" << ((node) ? std::to_string(node->value) : "null") << ")";
-		return stream;
+	void visit(FloatNode* node, size_t) {
+		*m_out << "FloatNode(" << std::to_string(node->value) << ")";
 	}
 
 	// Print String node
-	std::stringstream visit(StrNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "StrNode(" << ((node) ? node->value : "null") << ")";
-		return stream;
+	void visit(StrNode* node, size_t) {
+		*m_out << "StrNode(" << node->value << ")";
 	}
 
 	// Print Array node
-	std::stringstream visit(ArrayNode* node, int deep) override {
-		std::stringstream stream;
-		if (node) stream << "ArrayNode(" << node->array.stringRepresentation() << ")";
-		return stream;
+	void visit(ArrayNode* node, size_t) {
+		std::span<Token*> elements = node->elements;
+		*m_out << "ArrayNode(";
+		for (size_t i = 0; i < elements.size(); ++i) *m_out << elements[i]->value << ((i == elements.size() - 1) ? '\0' : ',');
+		*m_out << ")";
 	}
 
 	// Print Identifiers node
-	std::stringstream visit(IdNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "IdNode(" << ((node) ? node->identifier->value : "null") << ")";
-		return stream;
+	void visit(IdNode* node, size_t) {
+		*m_out << "IdNode(" << node->identifier->value << ")";
 	}
 
 	// Print Unary operation node
-	std::stringstream visit(UnOpNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "UnOpNode ->\n";
+	void visit(UnOpNode* node, size_t deep) {
+		*m_out << "UnOpNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ') << "Op(" << node->operation->value << ")\n" << std::string(deep, ' ');
-		stream << "Expr(" << node->right->handler(this, deep).str() << ")";
-		return stream;
+		*m_out << Spaces{ deep } << "Op(" << node->operation->value << ")\n" << Spaces{ deep } << "Expr(";
+		show(node->right, deep);
+		*m_out << ")";
 	}
 
 	// Print Binary operation node
-	std::stringstream visit(BinOpNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "BinOpNode ->\n";
+	void visit(BinOpNode* node, size_t deep) {
+		*m_out << "BinOpNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ')
-			<< "Left(" << node->left->handler(this, deep).str() << ")\n" << std::string(deep, ' ')
-			<< "Op(" << node->operation->value << ")\n" << std::string(deep, ' ')
-			<< "Right(" << node->right->handler(this, deep).str() << ")";
-		return stream;
+		*m_out << Spaces{ deep } << "Left(";
+		show(node->left, deep);
+		*m_out << ")\n" << Spaces{ deep } << "Op(" << node->operation->value << ")\n" << Spaces{ deep } << "Right(";
+		show(node->right, deep);
+		*m_out << ")";
 	}
 
 	// Print Empty variable declaration node ( key id: type; )
-	std::stringstream visit(EmptyVarDeclNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "EmptyVarDeclNode ->\n";
+	void visit(EmptyVarDeclNode* node, size_t deep) {
+		*m_out << "EmptyVarDeclNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ')
-			<< "Key(" << node->key_word->value << ")\n" << std::string(deep, ' ')
-			<< node->identifier->handler(this, deep).str() << "\n" << std::string(deep, ' ')
-			<< "Type(" << node->var_type->value << ")\n";
-		deep -= 3;
-		return stream;
+		*m_out << Spaces{ deep } << "Key(" << node->key_word->value << ")\n" << Spaces{ deep };
+		show(node->identifier, deep);
+		*m_out << "\n" << Spaces{ deep } << "Type(" << node->var_type->value << ")\n";
 	}
 
 	// Print Full variable declaration node ( key id: type = expr; )
-	std::stringstream visit(FullVarDeclNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "FullVarDeclNode ->\n";
+	void visit(FullVarDeclNode* node, size_t deep) {
+		*m_out << "FullVarDeclNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ')
-			<< node->declaration->handler(this, deep).str() << std::string(deep, ' ')
-			<< "Assign(" << node->assign->value << ")\n" << std::string(deep, ' ')
-			<< node->expr->handler(this, deep).str() << "\n";
-		deep -= 3;
-		return stream;
+		*m_out << Spaces{ deep };
+		show(node->declaration, deep);
+		*m_out << Spaces{ deep } << "Assign(" << node->assign->value << ")\n" << Spaces{ deep };
+		show(node->expr, deep);
+		*m_out << "\n";
 	}
 
 	// Print variable reasigment node ( id = expr; || id [+ - * /]= expr; )
-	std::stringstream visit(ReasignVarNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "ReasignNode ->\n";
+	void visit(ReasignVarNode* node, size_t deep) {
+		*m_out << "ReasignNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ')
-			<< node->identifier->handler(this, deep).str() << "\n" << std::string(deep, ' ')
-			<< "Op(" << node->assign->value << ")\n" << std::string(deep, ' ')
-			<< node->expr->handler(this, deep).str() << "\n";
-		deep -= 3;
-		return stream;
+		*m_out << Spaces{ deep };
+		show(node->identifier, deep);
+		*m_out << "\n" << Spaces{ deep } << "Op(" << node->assign->value << ")\n" << Spaces{ deep };
+		show(node->expr, deep);
+		*m_out << "\n";
 	}
 
 	// Print list of statement
-	std::stringstream visit(BlockOfCodeNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "StmtListNode ->" << (node->list.empty() ? " null\n" : "\n");
+	void visit(BlockOfCodeNode* node, size_t deep) {
+		*m_out << "StmtListNode ->" << (node->list.empty() ? " null\n" : "\n");
 		deep += 3;
-		for (size_t i = 0; i < node->list.size(); ++i) {
-			if (node->list[i]) stream << std::string(deep, ' ') << node->list[i]->handler(this, deep).str();
+		for (AST* statement : node->list) {
+			if (!statement) continue;
+			*m_out << Spaces{ deep };
+			show(statement, deep);
 		}
-		deep -= 3;
-		return stream;
 	}
 
 	// Print if statement node
-	std::stringstream visit(IfStmtNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "IfNode ->\n";
+	void visit(IfStmtNode* node, size_t deep) {
+		*m_out << "IfNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ') << "Condition - >";
+		*m_out << Spaces{ deep } << "Condition - >";
 		if (node->condition) {
-			deep += 3;
-			stream << "\n" << std::string(deep, ' ') << node->condition->handler(this, deep).str();
-			deep -= 3;
-		} else { stream << " null"; }
-		if (node->code_to_execute) stream << "\n" << std::string(deep, ' ') << node->code_to_execute->handler(this, deep).str();
-		deep -= 3;
-		return stream;
+			*m_out << "\n" << Spaces{ deep + 3 };
+			show(node->condition, deep + 3);
+		} else *m_out << " null";
+		if (node->code_to_execute) {
+			*m_out << "\n" << Spaces{ deep };
+			show(node->code_to_execute, deep);
+		}
 	}
 
 	// Print while statement node
-	std::stringstream visit(WhileStmtNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "WhileNode ->\n";
+	void visit(WhileStmtNode* node, size_t deep) {
+		*m_out << "WhileNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ') << "Condition ->" << ((node->condition == nullptr) ? " null" : "\n");
+		*m_out << Spaces{ deep } << "Condition ->" << (node->condition ? "\n" : " null");
 		if (node->condition) {
-			deep += 3;
-			stream << std::string(deep, ' ') << node->condition->handler(this, deep).str();
-			deep -= 3;
+			*m_out << Spaces{ deep + 3 };
+			show(node->condition, deep + 3);
+		}
+		if (node->code_to_execute) {
+			*m_out << "\n" << Spaces{ deep };
+			show(node->code_to_execute, deep);
 		}
-		if (node->code_to_execute) stream << "\n" << std::string(deep, ' ') << node->code_to_execute->handler(this, deep).str();
-		deep -= 3;
-		return stream;
 	}
 
 	// Print func node
-	std::stringstream visit(FuncNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "FuncNode ->\n";
+	void visit(FuncNode* node, size_t deep) {
+		*m_out << "FuncNode ->\n";
 		deep += 3;
-		stream << std::string(deep, ' ') << node->func_name->handler(this, deep).str() << "\n"
-		<< std::string(deep, ' ') << node->params->handler(this, deep).str()
-		<< std::string(deep, ' ') << "RetType(" << node->func_return_type->value << ")\n"
-		<< std::string(deep, ' ') << node->code_to_execute->handler(this, deep).str();
-		deep -= 3;
-		return stream;
+		*m_out << Spaces{ deep };
+		show(node->func_name, deep);
+		*m_out << "\n" << Spaces{ deep };
+		show(node->params, deep);
+		*m_out << Spaces{ deep } << "RetType(" << node->func_return_type->value << ")\n" << Spaces{ deep };
+		show(node->code_to_execute, deep);
 	}
 
 	// Print func parameters node
-	std::stringstream visit(FuncParamNode* node, int deep) override {
-		std::stringstream stream;
-		stream << "FuncParamNode ->" << (node->params.empty() ? " null\n" : "\n");
+	void visit(FuncParamNode* node, size_t deep) {
+		*m_out << "FuncParamNode ->" << (node->params.empty() ? " null\n" : "\n");
 		deep += 3;
-		for (EmptyVarDeclNode* node: node->params)
-			if (node) stream << std::string(deep, ' ') << node->handler(this, deep).str();
-		deep -= 3;
-		return stream;
+		for (EmptyVarDeclNode* param : node->params) {
+			if (!param) continue;
+			*m_out << Spaces{ deep };
+			show(param, deep);
+		}
 	}
 
 	// Print Increment Decrement node
-	std::stringstream visit(IncDecNode* node, int deep) override {
-		std::stringstream stream;
+	void visit(IncDecNode* node, size_t deep) {
 		deep += 3;
-		stream << "IncDecNode\n"
-			<< std::string(deep, ' ') << node->identifier->handler(this, deep).str() << "\n"
-			<< std::string(deep, ' ') << "Op(" << node->operation->value << ")\n";
-		deep -= 3;
-		return stream;
+		*m_out << "IncDecNode\n" << Spaces{ deep };
+		show(node->identifier, deep);
+		*m_out << "\n" << Spaces{ deep } << "Op(" << node->operation->value << ")\n";
 	}
 
+	// Print function call node
+	void visit(FuncCallNode* node, size_t deep) {
+		*m_out << "FuncCallNode ->\n";
+		deep += 3;
+		*m_out << Spaces{ deep };
+		show(node->func_name, deep);
+		*m_out << "\n" << Spaces{ deep } << "Args ->" << (node->args.empty() ? " null" : "");
+		deep += 3;
+		for (AST* arg : node->args) {
+			if (!arg) continue;
+			*m_out << "\n" << Spaces{ deep };
+			show(arg, deep);
+		}
+	}
+
+	// Print return statement node
+	void visit(ReturnStmtNode* node, size_t deep) {
+		*m_out << "ReturnNode ->";
+		deep += 3;
+		if (node->expr) {
+			*m_out << "\n" << Spaces{ deep };
+			show(node->expr, deep);
+			*m_out << "\n";
+		}
+		else *m_out << " null\n";
+	}
+
+	// Writes a flat node, the text is the same as the pointer node's
+	void write(const FlatAST& ast, NodeId node, size_t deep);
+
 public:
-	void print(AST* ast) { 
-		if (ast) std::cout << ast->handler(this, 0).str() << std::endl;
+	// Every root followed by a newline, null roots skipped
+	void print(const std::vector<AST*>& ast, std::ostream& out = std::cout) {
+		OutputBuffer buffer(out);
+		m_out = &buffer;
+		for (AST* root : ast) {
+			if (!root) continue;
+			show(root, 0);
+			buffer.put('\n');
+		}
+		buffer.flush();
+	}
+	void print(AST* ast, std::ostream& out = std::cout) { print(std::vector<AST*>{ ast }, out); }
+	void print(const FlatAST& ast, std::ostream& out = std::cout) {
+		OutputBuffer buffer(out);
+		m_out = &buffer;
+		for (NodeId root : ast.roots()) {
+			if (root == NO_NODE) continue;
+			write(ast, root, 0);
+			buffer.put('\n');
+		}
+		buffer.flush();
 	}
 };
-#endif // !AST_PRINTER_H
\ No newline at end of file
+#endif // !AST_PRINTER_H
@@ -0,0 +1,418 @@
+#include <bit>
+#include <cstring>
+#include "ast_serializer.h"
+
+// Fields of an ImageNode by tag, NO_INDEX stands for a null child or token:
+//  INT, FLOAT     low and high half of the value bits, line, column, token type
+//  STR            string offset, size, line, column, token type
+//  ARRAY          list of tokens, count
+//  ID             token, symbol
+//  UN_OP          operation, right
+//  BIN_OP         left, operation, right
+//  EMPTY_VAR_DECL key word, identifier, variable type
+//  FULL_VAR_DECL  declaration, assign, expression
+//  REASIGN_VAR    identifier, assign, expression
+//  BLOCK_OF_CODE  list of nodes, count
+//  IF, WHILE      condition, block
+//  FUNC           name, params, return type, block
+//  FUNC_PARAM     list of declarations, count
+//  INC_DEC        identifier, operation
+//  FUNC_CALL      name, list of arguments, count
+//  RETURN_STMT    key word, expression
+
+std::string ASTWriter::write(const std::vector<AST*>& ast, const SymbolTable& symbols) {
+	m_tokens.clear();
+	m_nodes.clear();
+	m_lists.clear();
+	m_strings.clear();
+
+	std::vector<ImageSymbol> image_symbols;
+	for (SymbolId symbol = 0; symbol < symbols.size(); ++symbol) {
+		std::string_view name = symbols.name(symbol);
+		image_symbols.push_back({ addString(name), static_cast<uint32_t>(name.size()) });
+	}
+	std::vector<uint32_t> roots;
+	for (AST* root : ast) roots.push_back(addNode(root));
+	if (m_strings.size() >= UINT32_MAX || m_lists.size() >= UINT32_MAX || m_nodes.size() >= UINT32_MAX || m_tokens.size() >= UINT32_MAX) return {};
+	m_strings.resize((m_strings.size() + 3) & ~size_t(3)); // Keep the image a multiple of 4 bytes
+
+	ImageHeader header;
+	std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+	header.version = AST_FORMAT_VERSION;
+	header.symbols = static_cast<uint32_t>(image_symbols.size());
+	header.tokens = static_cast<uint32_t>(m_tokens.size());
+	header.nodes = static_cast<uint32_t>(m_nodes.size());
+	header.lists = static_cast<uint32_t>(m_lists.size());
+	header.roots = static_cast<uint32_t>(roots.size());
+	header.strings = static_cast<uint32_t>(m_strings.size());
+
+	std::string image;
+	image.reserve(sizeof(header) + image_symbols.size() * sizeof(ImageSymbol) + m_tokens.size() * sizeof(ImageToken)
+		+ m_nodes.size() * sizeof(ImageNode) + (m_lists.size() + roots.size()) * sizeof(uint32_t) + m_strings.size());
+	auto append = [&image](const void* data, size_t size) { image.append(static_cast<const char*>(data), size); };
+	append(&header, sizeof(header));
+	append(image_symbols.data(), image_symbols.size() * sizeof(ImageSymbol));
+	append(m_tokens.data(), m_tokens.size() * sizeof(ImageToken));
+	append(m_nodes.data(), m_nodes.size() * sizeof(ImageNode));
+	append(m_lists.data(), m_lists.size() * sizeof(uint32_t));
+	append(roots.data(), roots.size() * sizeof(uint32_t));
+	image += m_strings;
+	return image;
+}
+
+uint32_t ASTWriter::addString(std::string_view str) {
+	uint32_t offset = static_cast<uint32_t>(m_strings.size());
+	m_strings += str;
+	return offset;
+}
+
+// A token or node referred to twice is written twice, the parser builds trees and shares almost nothing
+uint32_t ASTWriter::addToken(const Token* token) {
+	if (!token) return NO_INDEX;
+	m_tokens.push_back({ static_cast<uint32_t>(token->type), token->symbol, addString(token->value),
+		static_cast<uint32_t>(token->value.size()), static_cast<uint32_t>(token->line), static_cast<uint32_t>(token->column) });
+	return static_cast<uint32_t>(m_tokens.size() - 1);
+}
+
+uint32_t ASTWriter::addNode(AST* ast) {
+	if (!ast) return NO_INDEX;
+	dispatch(ast, [this](auto* node) { visit(node); });
+	return m_result;
+}
+
+// Children are written before the list itself, their own lists must not end up inside it
+template<typename T>
+uint32_t ASTWriter::addList(std::span<T*> nodes) {
+	std::vector<uint32_t> indices;
+	for (T* node : nodes) indices.push_back(addNode(node));
+	uint32_t offset = static_cast<uint32_t>(m_lists.size());
+	m_lists.insert(m_lists.end(), indices.begin(), indices.end());
+	return offset;
+}
+
+void ASTWriter::emit(NodeKind tag, uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e) {
+	m_result = static_cast<uint32_t>(m_nodes.size());
+	m_nodes.push_back({ static_cast<uint32_t>(tag), { a, b, c, d, e } });
+}
+
+void ASTWriter::visit(IntNode* node) {
+	uint64_t bits = static_cast<uint64_t>(node->value);
+	emit(NodeKind::INT, static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32), static_cast<uint32_t>(node->line), static_cast<uint32_t>(node->column), node->type);
+}
+
+void ASTWriter::visit(FloatNode* node) {
+	uint64_t bits = std::bit_cast<uint64_t>(node->value);
+	emit(NodeKind::FLOAT, static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32), static_cast<uint32_t>(node->line), static_cast<uint32_t>(node->column), node->type);
+}
+
+void ASTWriter::visit(StrNode* node) {
+	uint32_t offset = addString(node->value);
+	emit(NodeKind::STR, offset, static_cast<uint32_t>(node->value.size()), static_cast<uint32_t>(node->line), static_cast<uint32_t>(node->column), node->type);
+}
+
+void ASTWriter::visit(ArrayNode* node) {
+	uint32_t offset = static_cast<uint32_t>(m_lists.size());
+	for (const Token* token : node->elements) m_lists.push_back(addToken(token));
+	emit(NodeKind::ARRAY, offset, static_cast<uint32_t>(node->elements.size()));
+}
+
+void ASTWriter::visit(IdNode* node) { emit(NodeKind::ID, addToken(node->identifier), node->symbol); }
+
+void ASTWriter::visit(UnOpNode* node) {
+	uint32_t right = addNode(node->right);
+	emit(NodeKind::UN_OP, addToken(node->operation), right);
+}
+
+void ASTWriter::visit(BinOpNode* node) {
+	uint32_t left = addNode(node->left);
+	uint32_t right = addNode(node->right);
+	emit(NodeKind::BIN_OP, left, addToken(node->operation), right);
+}
+
+void ASTWriter::visit(EmptyVarDeclNode* node) {
+	uint32_t identifier = addNode(node->identifier);
+	emit(NodeKind::EMPTY_VAR_DECL, addToken(node->key_word), identifier, addToken(node->var_type));
+}
+
+void ASTWriter::visit(FullVarDeclNode* node) {
+	uint32_t declaration = addNode(node->declaration);
+	uint32_t expr = addNode(node->expr);
+	emit(NodeKind::FULL_VAR_DECL, declaration, addToken(node->assign), expr);
+}
+
+void ASTWriter::visit(ReasignVarNode* node) {
+	uint32_t identifier = addNode(node->identifier);
+	uint32_t expr = addNode(node->expr);
+	emit(NodeKind::REASIGN_VAR, identifier, addToken(node->assign), expr);
+}
+
+void ASTWriter::visit(BlockOfCodeNode* node) {
+	uint32_t list = addList(node->list);
+	emit(NodeKind::BLOCK_OF_CODE, list, static_cast<uint32_t>(node->list.size()));
+}
+
+void ASTWriter::visit(IfStmtNode* node) {
+	uint32_t condition = addNode(node->condition);
+	uint32_t code = addNode(node->code_to_execute);
+	emit(NodeKind::IF_STMT, condition, code);
+}
+
+void ASTWriter::visit(WhileStmtNode* node) {
+	uint32_t condition = addNode(node->condition);
+	uint32_t code = addNode(node->code_to_execute);
+	emit(NodeKind::WHILE_STMT, condition, code);
+}
+
+void ASTWriter::visit(FuncNode* node) {
+	uint32_t name = addNode(node->func_name);
+	uint32_t params = addNode(node->params);
+	uint32_t code = addNode(node->code_to_execute);
+	emit(NodeKind::FUNC, name, params, addToken(node->func_return_type), code);
+}
+
+void ASTWriter::visit(FuncParamNode* node) {
+	uint32_t list = addList(node->params);
+	emit(NodeKind::FUNC_PARAM, list, static_cast<uint32_t>(node->params.size()));
+}
+
+void ASTWriter::visit(IncDecNode* node) {
+	uint32_t identifier = addNode(node->identifier);
+	emit(NodeKind::INC_DEC, identifier, addToken(node->operation));
+}
+
+void ASTWriter::visit(FuncCallNode* node) {
+	uint32_t name = addNode(node->func_name);
+	uint32_t list = addList(node->args);
+	emit(NodeKind::FUNC_CALL, name, list, static_cast<uint32_t>(node->args.size()));
+}
+
+void ASTWriter::visit(ReturnStmtNode* node) {
+	uint32_t expr = addNode(node->expr);
+	emit(NodeKind::RETURN_STMT, addToken(node->key_word), expr);
+}
+
+// Records of an image after its header, checked to lie inside it
+struct ImageSections {
+	const ImageSymbol* symbols;
+	const ImageToken* tokens;
+	const ImageNode* nodes;
+	const uint32_t* lists;
+	const uint32_t* roots;
+	const char* strings;
+};
+
+bool ASTReader::read(std::string_view image, std::vector<AST*>& ast) {
+	ImageHeader header;
+	if (image.size() < sizeof(header) || reinterpret_cast<uintptr_t>(image.data()) % alignof(ImageToken)) return false;
+	std::memcpy(&header, image.data(), sizeof(header));
+	if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) || header.version != AST_FORMAT_VERSION) return false;
+	uint64_t size = sizeof(header) + uint64_t(header.symbols) * sizeof(ImageSymbol) + uint64_t(header.tokens) * sizeof(ImageToken)
+		+ uint64_t(header.nodes) * sizeof(ImageNode) + (uint64_t(header.lists) + header.roots) * sizeof(uint32_t) + header.strings;
+	if (size != image.size()) return false;
+
+	ImageSections image_data;
+	const char* position = image.data() + sizeof(header);
+	auto section = [&position](auto*& records, uint32_t count) {
+		records = reinterpret_cast<std::remove_reference_t<decltype(records)>>(position);
+		position += count * sizeof(*records);
+	};
+	section(image_data.symbols, header.symbols);
+	section(image_data.tokens, header.tokens);
+	section(image_data.nodes, header.nodes);
+	section(image_data.lists, header.lists);
+	section(image_data.roots, header.roots);
+	image_data.strings = position;
+	auto text = [&](uint32_t offset, uint32_t count, std::string_view& str) {
+		if (offset > header.strings || count > header.strings - offset) return false;
+		str = { image_data.strings + offset, count };
+		return true;
+	};
+	auto list = [&](uint32_t offset, uint32_t count) {
+		return offset <= header.lists && count <= header.lists - offset;
+	};
+
+	// Symbols keep their ids: the table interns them in the same order it did when the image was written
+	for (uint32_t i = 0; i < header.symbols; ++i) {
+		std::string_view name;
+		if (!text(image_data.symbols[i].offset, image_data.symbols[i].size, name) || m_symbols.intern(name) != i) return false;
+	}
+
+	Token* tokens = static_cast<Token*>(m_arena.allocate(sizeof(Token) * header.tokens, alignof(Token)));
+	for (uint32_t i = 0; i < header.tokens; ++i) {
+		const ImageToken& record = image_data.tokens[i];
+		std::string_view value;
+		if (record.type >= TokenType::TOKEN_TYPE_COUNT || (record.symbol != NO_SYMBOL && record.symbol >= header.symbols)
+			|| !text(record.offset, record.size, value)) return false;
+		new (&tokens[i]) Token(record.line, record.column, static_cast<TokenType>(record.type), value, record.symbol);
+	}
+	auto token = [&](uint32_t index, Token*& result) {
+		if (index == NO_INDEX) { result = nullptr; return true; }
+		if (index >= header.tokens) return false;
+		result = &tokens[index];
+		return true;
+	};
+
+	// A child must come before its parent and have the tag the field expects
+	std::vector<AST*> nodes(header.nodes);
+	auto child = [&](uint32_t parent, uint32_t index, AST*& result) {
+		if (index == NO_INDEX) { result = nullptr; return true; }
+		if (index >= parent) return false;
+		result = nodes[index];
+		return true;
+	};
+	auto typed = [&]<typename T>(uint32_t parent, uint32_t index, NodeKind tag, T*& result) {
+		if (index == NO_INDEX) { result = nullptr; return true; }
+		if (index >= parent || image_data.nodes[index].tag != static_cast<uint32_t>(tag)) return false;
+		result = static_cast<T*>(nodes[index]);
+		return true;
+	};
+
+	for (uint32_t i = 0; i < header.nodes; ++i) {
+		const ImageNode& record = image_data.nodes[i];
+		const uint32_t* field = record.field;
+		if (record.tag >= static_cast<uint32_t>(NodeKind::COUNT)) return false;
+		switch (static_cast<NodeKind>(record.tag)) {
+			case NodeKind::INT:
+				if (field[4] >= TokenType::TOKEN_TYPE_COUNT) return false;
+				nodes[i] = m_arena.make<IntNode>(static_cast<int64_t>(field[0] | uint64_t(field[1]) << 32), field[2], field[3]);
+				static_cast<IntNode*>(nodes[i])->type = static_cast<TokenType>(field[4]);
+				break;
+			case NodeKind::FLOAT:
+				if (field[4] >= TokenType::TOKEN_TYPE_COUNT) return false;
+				nodes[i] = m_arena.make<FloatNode>(std::bit_cast<double>(field[0] | uint64_t(field[1]) << 32), field[2], field[3]);
+				static_cast<FloatNode*>(nodes[i])->type = static_cast<TokenType>(field[4]);
+				break;
+			case NodeKind::STR: {
+				std::string_view value;
+				if (!text(field[0], field[1], value) || field[4] >= TokenType::TOKEN_TYPE_COUNT) return false;
+				Token token(field[2], field[3], static_cast<TokenType>(field[4]), value);
+				nodes[i] = m_arena.make<StrNode>(&token);
+				break;
+			}
+			case NodeKind::ARRAY: {
+				// The parser checks the element types, the same check may not throw here
+				if (!list(field[0], field[1]) || !field[1]) return false;
+				std::vector<Token*> elements(field[1]);
+				for (uint32_t j = 0; j < field[1]; ++j)
+					if (!token(image_data.lists[field[0] + j], elements[j]) || !elements[j] || elements[j]->type != elements[0]->type) return false;
+				nodes[i] = m_arena.make<ArrayNode>(m_arena.copy(elements));
+				break;
+			}
+			case NodeKind::ID: {
+				Token* identifier;
+				if (!token(field[0], identifier) || !identifier || (field[1] != NO_SYMBOL && field[1] >= header.symbols)) return false;
+				IdNode* node = m_arena.make<IdNode>(identifier);
+				node->symbol = field[1];
+				nodes[i] = node;
+				break;
+			}
+			case NodeKind::UN_OP: {
+				Token* operation;
+				AST* right;
+				if (!token(field[0], operation) || !child(i, field[1], right)) return false;
+				nodes[i] = m_arena.make<UnOpNode>(operation, right);
+				break;
+			}
+			case NodeKind::BIN_OP: {
+				AST* left;
+				AST* right;
+				Token* operation;
+				if (!child(i, field[0], left) || !token(field[1], operation) || !child(i, field[2], right)) return false;
+				nodes[i] = m_arena.make<BinOpNode>(left, operation, right);
+				break;
+			}
+			case NodeKind::EMPTY_VAR_DECL: {
+				Token* key_word;
+				IdNode* identifier;
+				Token* var_type;
+				if (!token(field[0], key_word) || !typed(i, field[1], NodeKind::ID, identifier) || !token(field[2], var_type)) return false;
+				nodes[i] = m_arena.make<EmptyVarDeclNode>(key_word, identifier, var_type);
+				break;
+			}
+			case NodeKind::FULL_VAR_DECL: {
+				EmptyVarDeclNode* declaration;
+				Token* assign;
+				AST* expr;
+				if (!typed(i, field[0], NodeKind::EMPTY_VAR_DECL, declaration) || !token(field[1], assign) || !child(i, field[2], expr)) return false;
+				nodes[i] = m_arena.make<FullVarDeclNode>(declaration, assign, expr);
+				break;
+			}
+			case NodeKind::REASIGN_VAR: {
+				IdNode* identifier;
+				Token* assign;
+				AST* expr;
+				if (!typed(i, field[0], NodeKind::ID, identifier) || !token(field[1], assign) || !child(i, field[2], expr)) return false;
+				nodes[i] = m_arena.make<ReasignVarNode>(identifier, assign, expr);
+				break;
+			}
+			case NodeKind::BLOCK_OF_CODE: {
+				if (!list(field[0], field[1])) return false;
+				std::vector<AST*> statements(field[1]);
+				for (uint32_t j = 0; j < field[1]; ++j)
+					if (!child(i, image_data.lists[field[0] + j], statements[j])) return false;
+				nodes[i] = m_arena.make<BlockOfCodeNode>(m_arena.copy(statements));
+				break;
+			}
+			case NodeKind::IF_STMT:
+			case NodeKind::WHILE_STMT: {
+				AST* condition;
+				BlockOfCodeNode* code;
+				if (!child(i, field[0], condition) || !typed(i, field[1], NodeKind::BLOCK_OF_CODE, code)) return false;
+				if (record.tag == static_cast<uint32_t>(NodeKind::IF_STMT)) nodes[i] = m_arena.make<IfStmtNode>(condition, code);
+				else nodes[i] = m_arena.make<WhileStmtNode>(condition, code);
+				break;
+			}
+			case NodeKind::FUNC: {
+				IdNode* name;
+				FuncParamNode* params;
+				Token* return_type;
+				BlockOfCodeNode* code;
+				if (!typed(i, field[0], NodeKind::ID, name) || !typed(i, field[1], NodeKind::FUNC_PARAM, params)
+					|| !token(field[2], return_type) || !typed(i, field[3], NodeKind::BLOCK_OF_CODE, code)) return false;
+				nodes[i] = m_arena.make<FuncNode>(name, params, return_type, code);
+				break;
+			}
+			case NodeKind::FUNC_PARAM: {
+				if (!list(field[0], field[1])) return false;
+				std::vector<EmptyVarDeclNode*> params(field[1]);
+				for (uint32_t j = 0; j < field[1]; ++j)
+					if (!typed(i, image_data.lists[field[0] + j], NodeKind::EMPTY_VAR_DECL, params[j])) return false;
+				nodes[i] = m_arena.make<FuncParamNode>(m_arena.copy(params));
+				break;
+			}
+			case NodeKind::INC_DEC: {
+				IdNode* identifier;
+				Token* operation;
+				if (!typed(i, field[0], NodeKind::ID, identifier) || !token(field[1], operation)) return false;
+				nodes[i] = m_arena.make<IncDecNode>(identifier, operation);
+				break;
+			}
+			case NodeKind::FUNC_CALL: {
+				IdNode* name;
+				if (!typed(i, field[0], NodeKind::ID, name) || !list(field[1], field[2])) return false;
+				std::vector<AST*> args(field[2]);
+				for (uint32_t j = 0; j < field[2]; ++j)
+					if (!child(i, image_data.lists[field[1] + j], args[j])) return false;
+				nodes[i] = m_arena.make<FuncCallNode>(name, m_arena.copy(args));
+				break;
+			}
+			case NodeKind::RETURN_STMT: {
+				Token* key_word;
+				AST* expr;
+				if (!token(field[0], key_word) || !child(i, field[1], expr)) return false;
+				nodes[i] = m_arena.make<ReturnStmtNode>(key_word, expr);
+				break;
+			}
+			default:
+				return false;
+		}
+	}
+
+	ast.clear();
+	for (uint32_t i = 0; i < header.roots; ++i) {
+		uint32_t root = image_data.roots[i];
+		if (root != NO_INDEX && root >= header.nodes) return false;
+		ast.push_back(root == NO_INDEX ? nullptr : nodes[root]);
+	}
+	return true;
+}
@@ -0,0 +1,83 @@
+#ifndef AST_SERIALIZER_H
+#define AST_SERIALIZER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast.h"
+#include "../../Memory/arena.h"
+
+// Bump when a node, a token or the parser output changes, images of other versions are not read
+constexpr uint32_t AST_FORMAT_VERSION = 2;
+
+// Flat binary image of a parsed script: header, symbols, tokens, nodes, child lists, roots and one string blob.
+// Every reference is a 32-bit index or offset into the image, not a pointer, so an image written by one run can
+// be read by another. ASTReader turns the records back into nodes, only names and strings are used in place.
+// Nodes are written after their children, a node only refers to records before it.
+constexpr uint32_t NO_INDEX = UINT32_MAX; // Null child or token
+constexpr char IMAGE_MAGIC[4] = { 'D', 'L', 'A', 'T' };
+
+struct ImageHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t symbols, tokens, nodes, lists, roots, strings; // Record counts, strings in bytes
+};
+struct ImageSymbol { uint32_t offset, size; }; // Name in the string blob
+struct ImageToken { uint32_t type, symbol, offset, size, line, column; };
+struct ImageNode { uint32_t tag; uint32_t field[5]; }; // tag is a NodeKind, the meaning of the fields depends on it, see ASTWriter
+
+// Writes a tree and the symbols it uses as an image
+class ASTWriter {
+private:
+	std::vector<ImageToken> m_tokens;
+	std::vector<ImageNode> m_nodes;
+	std::vector<uint32_t> m_lists;
+	std::string m_strings;
+	uint32_t m_result = NO_INDEX; // Index of the visited node
+
+private:
+	uint32_t addString(std::string_view str); // Offset in the string blob
+	uint32_t addToken(const Token* token);
+	uint32_t addNode(AST* ast);
+	template<typename T>
+	uint32_t addList(std::span<T*> nodes); // Offset in m_lists, the count is stored by the caller
+	void emit(NodeKind tag, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0, uint32_t d = 0, uint32_t e = 0);
+
+	void visit(IntNode* node);
+	void visit(FloatNode* node);
+	void visit(StrNode* node);
+	void visit(ArrayNode* node);
+	void visit(IdNode* node);
+	void visit(UnOpNode* node);
+	void visit(BinOpNode* node);
+	void visit(EmptyVarDeclNode* node);
+	void visit(FullVarDeclNode* node);
+	void visit(ReasignVarNode* node);
+	void visit(BlockOfCodeNode* node);
+	void visit(IfStmtNode* node);
+	void visit(WhileStmtNode* node);
+	void visit(FuncNode* node);
+	void visit(FuncParamNode* node);
+	void visit(IncDecNode* node);
+	void visit(FuncCallNode* node);
+	void visit(ReturnStmtNode* node);
+
+public:
+	// Image of ast, empty if it doesn't fit 32-bit offsets
+	std::string write(const std::vector<AST*>& ast, const SymbolTable& symbols);
+};
+
+// Rebuilds a tree from an image. Nodes and tokens are made in the arena, names and string
+// literals stay views into the image, so it must outlive the tree (map it with SourceFile).
+// A damaged or foreign image is rejected as a whole, read() never trusts an index it didn't check.
+class ASTReader {
+private:
+	Arena& m_arena;
+	SymbolTable& m_symbols;
+
+public:
+	ASTReader(Arena& arena, SymbolTable& symbols): m_arena(arena), m_symbols(symbols) {}
+	bool read(std::string_view image, std::vector<AST*>& ast); // false if the image is invalid, symbols must be fresh
+};
+#endif // !AST_SERIALIZER_H
@@ -0,0 +1,95 @@
+#include <array>
+#include <bit>
+#include "flat_ast.h"
+
+// Keywords but the types, which share VARIABLE_TYPE, and every operator
+static constexpr std::array<std::string_view, TOKEN_TYPE_COUNT> SPELLINGS = [] {
+	std::array<std::string_view, TOKEN_TYPE_COUNT> spellings{};
+	for (const Keyword& keyword : KEYWORDS)
+		if (keyword.type != TokenType::VARIABLE_TYPE) spellings[keyword.type] = keyword.word;
+	constexpr std::pair<TokenType, std::string_view> OPERATORS[] = {
+		{ SEMICOLON, ";" }, { COLON, ":" }, { EQUAL, "=" }, { DOT, "." }, { QUOTE, "\"" }, { COMMA, "," }, { SLASH, "/" },
+		{ LESS, "<" }, { GREATER, ">" }, { NOT, "!" }, { GREATER_EQUAL, ">=" }, { LESS_EQUAL, "<=" }, { EQUAL_EQUAL, "==" },
+		{ NOT_EQUAL, "!=" }, { PLUS, "+" }, { MINUS, "-" }, { DIVIDE, "/" }, { MULTIPLY, "*" }, { PLUS_EQUAL, "+=" },
+		{ MINUS_EQUAL, "-=" }, { DIVIDE_EQUAL, "/=" }, { MULTIPLY_EQUAL, "*=" }, { LRPAREN, "(" }, { RRPAREN, ")" },
+		{ LFPAREN, "{" }, { RFPAREN, "}" }, { LSPAREN, "[" }, { RSPAREN, "]" }, { LOGIC_AND, "&&" }, { LOGIC_OR, "||" },
+		{ UNARY_LOGIC_OR, "|" }, { UNARY_LOGIC_AND, "&" }, { INCREMENT, "++" }, { DECREMENT, "--" }, { ANNOTATION, "->" }
+	};
+	for (const auto& [type, text] : OPERATORS) spellings[type] = text;
+	return spellings;
+}();
+
+std::string_view tokenSpelling(TokenType type) {
+	return SPELLINGS[type];
+}
+
+NodeId FlatAST::add(NodeKind kind, TokenType op, SourceSpan span, uint32_t lhs, uint32_t rhs, uint32_t extra) {
+	m_kinds.push_back(kind);
+	m_ops.push_back(static_cast<uint8_t>(op));
+	m_lhs.push_back(lhs);
+	m_rhs.push_back(rhs);
+	m_extra.push_back(extra);
+	m_spans.push_back(span);
+	return static_cast<NodeId>(m_kinds.size() - 1);
+}
+
+uint32_t FlatAST::addLiteral(const Token* token) {
+	m_literals.push_back({ token->value.data(), static_cast<uint32_t>(token->value.size()), token->type });
+	return static_cast<uint32_t>(m_literals.size() - 1);
+}
+
+uint32_t FlatAST::addList(std::span<const NodeId> items) {
+	uint32_t first = static_cast<uint32_t>(m_lists.size());
+	m_lists.insert(m_lists.end(), items.begin(), items.end());
+	return first;
+}
+
+// Keyword and assign tokens are nearly always spelled by their type, anything else the grammar accepts keeps its text
+uint32_t FlatAST::tokenOperand(const Token* token) {
+	return SPELLINGS[token->type].empty() ? addLiteral(token) : NO_INDEX;
+}
+
+void FlatAST::reserve(size_t nodes) {
+	m_kinds.reserve(nodes);
+	m_ops.reserve(nodes);
+	m_lhs.reserve(nodes);
+	m_rhs.reserve(nodes);
+	m_extra.reserve(nodes);
+	m_spans.reserve(nodes);
+}
+
+void FlatAST::clear() {
+	m_kinds.clear();
+	m_ops.clear();
+	for (auto* column : { &m_lhs, &m_rhs, &m_extra, &m_lists, &m_roots }) column->clear();
+	m_spans.clear();
+	m_literals.clear();
+}
+
+double FlatAST::floatValue(NodeId node) const {
+	return std::bit_cast<double>(m_lhs[node] | uint64_t(m_rhs[node]) << 32);
+}
+
+std::span<const NodeId> FlatAST::list(NodeId node) const {
+	if (kind(node) == NodeKind::FUNC_CALL) return { m_lists.data() + m_rhs[node], m_extra[node] };
+	return { m_lists.data() + m_lhs[node], m_rhs[node] };
+}
+
+std::string_view FlatAST::tokenText(NodeId node) const {
+	if (kind(node) == NodeKind::EMPTY_VAR_DECL || kind(node) == NodeKind::REASIGN_VAR) {
+		if (m_extra[node] != NO_INDEX) return m_literals[m_extra[node]].text();
+	}
+	return SPELLINGS[m_ops[node]];
+}
+
+size_t FlatAST::bytesUsed() const {
+	return (m_kinds.size() + m_ops.size()) * sizeof(uint8_t)
+		+ (m_lhs.size() + m_rhs.size() + m_extra.size() + m_lists.size() + m_roots.size()) * sizeof(uint32_t)
+		+ m_spans.size() * sizeof(SourceSpan) + m_literals.size() * sizeof(FlatLiteral);
+}
+
+size_t FlatAST::bytesReserved() const {
+	return (m_kinds.capacity() + m_ops.capacity()) * sizeof(uint8_t)
+		+ (m_lhs.capacity() + m_rhs.capacity() + m_extra.capacity() + m_lists.capacity() + m_roots.capacity()) * sizeof(uint32_t)
+		+ m_spans.capacity() * sizeof(SourceSpan) + m_literals.capacity() * sizeof(FlatLiteral);
+}
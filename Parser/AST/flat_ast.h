@@ -0,0 +1,123 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "ast_serializer.h"
+
+// Index of a node in a FlatAST
+using NodeId = uint32_t;
+constexpr NodeId NO_NODE = UINT32_MAX;
+
+// Token text a flat tree keeps: string literals, array elements and the odd token the grammar lets through
+struct FlatLiteral {
+	const char* data;
+	uint32_t size; // A view would make the record 24 bytes, arrays add one per element
+	TokenType type;
+
+	std::string_view text() const { return { data, size }; }
+};
+
+// Position of the token a node was made from
+struct SourceSpan {
+	uint32_t line, column;
+};
+
+// AST stored as a structure of arrays: node i is kinds[i], ops[i], lhs[i], rhs[i], extra[i] and spans[i],
+// each column one contiguous vector. Children are 32 bit NodeIds, child lists are ranges of one shared list array,
+// text lives in side tables. Children are added before their parents, so a child id is always below its parent's.
+//
+// Operands per kind, op is the TokenType of the node's token:
+//   INT              lhs, rhs = low and high half     FLOAT       lhs, rhs = low and high half of the bits
+//   STR              lhs = literal                    ARRAY       lhs, rhs = first literal and count of the elements
+//   ID               lhs = symbol
+//   UN_OP            lhs = operand                    BIN_OP      lhs, rhs = operands
+//   EMPTY_VAR_DECL   lhs = id, rhs = type symbol, op and extra = keyword token (see tokenText)
+//   FULL_VAR_DECL    lhs = declaration, rhs = expression
+//   REASIGN_VAR      lhs = id, rhs = expression, op and extra = assign token
+//   BLOCK_OF_CODE    lhs, rhs = first list item and count of the statements
+//   IF_STMT          lhs = condition, rhs = block     WHILE_STMT  same as IF_STMT
+//   FUNC             lhs = id, rhs = parameters, extra = block
+//   FUNC_PARAM       lhs, rhs = first list item and count of the EMPTY_VAR_DECLs, extra = return type symbol
+//   INC_DEC          lhs = id
+//   FUNC_CALL        lhs = id, rhs, extra = first list item and count of the arguments
+//   RETURN_STMT      lhs = expression
+// A missing child is NO_NODE. Names are symbols of the table the tree was made with.
+class FlatAST {
+private:
+	const SymbolTable* m_symbols;
+	std::vector<NodeKind> m_kinds;
+	std::vector<uint8_t> m_ops; // TokenType
+	std::vector<uint32_t> m_lhs, m_rhs, m_extra;
+	std::vector<SourceSpan> m_spans;
+	std::vector<NodeId> m_lists; // Child lists, each one contiguous
+	std::vector<FlatLiteral> m_literals;
+	std::vector<NodeId> m_roots; // Top level statements in source order
+
+public:
+	static_assert(TOKEN_TYPE_COUNT <= UINT8_MAX);
+
+	FlatAST(const SymbolTable& symbols): m_symbols(&symbols) {}
+
+	// Building, used by FlatParser
+	NodeId add(NodeKind kind, TokenType op, SourceSpan span, uint32_t lhs = NO_NODE, uint32_t rhs = NO_NODE, uint32_t extra = NO_NODE);
+	uint32_t addLiteral(const Token* token);
+	uint32_t addList(std::span<const NodeId> items); // Index of the first item
+	uint32_t tokenOperand(const Token* token); // extra of a keyword or assign token, NO_INDEX if its type spells it
+	void addRoot(NodeId node) { m_roots.push_back(node); }
+	void reserve(size_t nodes);
+	void clear();
+
+	// Reading
+	size_t size() const { return m_kinds.size(); }
+	const std::vector<NodeId>& roots() const { return m_roots; }
+	NodeKind kind(NodeId node) const { return m_kinds[node]; }
+	TokenType op(NodeId node) const { return static_cast<TokenType>(m_ops[node]); }
+	uint32_t lhs(NodeId node) const { return m_lhs[node]; }
+	uint32_t rhs(NodeId node) const { return m_rhs[node]; }
+	uint32_t extra(NodeId node) const { return m_extra[node]; }
+	SourceSpan span(NodeId node) const { return m_spans[node]; }
+	std::span<const NodeKind> kinds() const { return m_kinds; } // Whole kind column, for passes that scan every node
+
+	int64_t intValue(NodeId node) const { return static_cast<int64_t>(m_lhs[node] | uint64_t(m_rhs[node]) << 32); }
+	double floatValue(NodeId node) const;
+	std::string_view strValue(NodeId node) const { return m_literals[m_lhs[node]].text(); }
+	std::span<const FlatLiteral> elements(NodeId node) const { return { m_literals.data() + m_lhs[node], m_rhs[node] }; } // ARRAY
+	std::span<const NodeId> list(NodeId node) const; // Items of BLOCK_OF_CODE, FUNC_PARAM and FUNC_CALL
+	std::string_view name(SymbolId symbol) const { return m_symbols->name(symbol); }
+	std::string_view tokenText(NodeId node) const; // Source text of the op token of a node
+
+	// Calls visit(child) for every child in source order, missing ones skipped
+	template<typename Visit>
+	void forEachChild(NodeId node, Visit&& visit) const {
+		auto child = [&](uint32_t id) { if (id != NO_NODE) visit(id); };
+		switch (kind(node)) {
+			case NodeKind::UN_OP: case NodeKind::EMPTY_VAR_DECL: case NodeKind::INC_DEC: case NodeKind::RETURN_STMT:
+				child(m_lhs[node]);
+				break;
+			case NodeKind::BIN_OP: case NodeKind::FULL_VAR_DECL: case NodeKind::REASIGN_VAR: case NodeKind::IF_STMT: case NodeKind::WHILE_STMT:
+				child(m_lhs[node]); child(m_rhs[node]);
+				break;
+			case NodeKind::FUNC:
+				child(m_lhs[node]); child(m_rhs[node]); child(m_extra[node]);
+				break;
+			case NodeKind::FUNC_CALL:
+				child(m_lhs[node]);
+				[[fallthrough]];
+			case NodeKind::BLOCK_OF_CODE: case NodeKind::FUNC_PARAM:
+				for (NodeId item : list(node)) child(item);
+				break;
+			default:
+				break;
+		}
+	}
+
+	size_t bytesUsed() const; // Bytes in the columns and side tables, literal text excluded
+	size_t bytesReserved() const; // Same with the spare capacity of the vectors
+};
+
+// Spelling of a token type that always has the same text, empty for names, literals and types
+std::string_view tokenSpelling(TokenType type);
+#endif // !FLAT_AST_H
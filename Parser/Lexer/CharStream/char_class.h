@@ -0,0 +1,27 @@
+#ifndef CHAR_CLASS_H
+#define CHAR_CLASS_H
+
+#include <array>
+#include <cstdint>
+
+// Class of every byte, replaces the locale dependent std::isspace/isalpha/isdigit
+enum class CharClass : uint8_t { OTHER, SPACE, ALPHA, DIGIT, DOT, QUOTE, SYMBOL, END };
+
+constexpr std::array<CharClass, 256> buildCharClassTable() {
+	std::array<CharClass, 256> table{};
+	for (int c = 'a'; c <= 'z'; ++c) table[c] = CharClass::ALPHA;
+	for (int c = 'A'; c <= 'Z'; ++c) table[c] = CharClass::ALPHA;
+	for (int c = '0'; c <= '9'; ++c) table[c] = CharClass::DIGIT;
+	for (char c : { ' ', '\t', '\n', '\v', '\f', '\r' }) table[static_cast<unsigned char>(c)] = CharClass::SPACE;
+	for (char c : { ';', ':', '=', ',', '<', '>', '+', '-', '*', '/', '!', '(', ')', '{', '}', '[', ']', '|', '&' })
+		table[static_cast<unsigned char>(c)] = CharClass::SYMBOL;
+	table['.'] = CharClass::DOT;
+	table['"'] = CharClass::QUOTE;
+	table[0] = CharClass::END;
+	return table;
+}
+
+inline constexpr std::array<CharClass, 256> CHAR_CLASS = buildCharClassTable();
+
+constexpr CharClass charClass(char c) { return CHAR_CLASS[static_cast<unsigned char>(c)]; }
+#endif // !CHAR_CLASS_H
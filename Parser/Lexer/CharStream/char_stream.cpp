@@ -1,10 +1,31 @@
+#include <algorithm>
 #include "char_stream.h"
 #include "../../Tokens/tokens.h"
+#include "char_class.h"
+
+// Most runs are a few bytes long, they are checked inline before paying for a call into the Scanner
+constexpr size_t SHORT_RUN = 16;
+
+template <typename InRun>
+static size_t scanRun(std::string_view code, size_t pos, InRun in_run, size_t (*scan)(const char*, size_t, size_t)) {
+	size_t end = code.length(), short_end = std::min(end, pos + SHORT_RUN);
+	while (pos < short_end && in_run(code[pos])) ++pos;
+	return (pos == short_end && pos < end) ? scan(code.data(), pos, end) : pos;
+}
 
 // Initialize the char stream
-void CharStream::initStream(const std::string& str) {
+void CharStream::initStream(std::string_view str) {
 	this->code = str;
-	advance(); 
+	line_ = 1;
+	line_start_ = 0;
+	moveTo(0);
+}
+
+void CharStream::initStream(std::string_view str, size_t start, int line, size_t line_start) {
+	this->code = str;
+	line_ = line;
+	line_start_ = static_cast<int>(line_start);
+	moveTo(start);
 }
 
 // Get next char
@@ -22,8 +43,9 @@ bool CharStream::currentCharEqual(int code) {
 }
 
 // check if current char in list of chars
-bool CharStream::currcharInList(std::vector<int> list) {
-	return std::find_if(list.begin(), list.end(), [=](char element) { return currentCharEqual(element); }) != list.end();
+bool CharStream::currcharInList(std::initializer_list<int> list) {
+	for (int element : list) if (currentCharEqual(element)) return true;
+	return false;
 }
 
 // Is next char equal ascii code of symbol
@@ -38,17 +60,17 @@ bool CharStream::hasNext() {
 
 // Is current char is space
 bool CharStream::isSpace() { 
-	return std::isspace(current_char);
+	return charClass(current_char) == CharClass::SPACE;
 }
 
 // Is current char is digit
 bool CharStream::isDigit() {
-	return std::isdigit(current_char);
+	return charClass(current_char) == CharClass::DIGIT;
 }
 
 // Is current char is alpha
 bool CharStream::isAlpha() {
-	return std::isalpha(current_char);
+	return charClass(current_char) == CharClass::ALPHA;
 }
 
 bool CharStream::isEndOfString() {
@@ -57,21 +79,58 @@ bool CharStream::isEndOfString() {
 
 // Next char
 void CharStream::advance(int step) {
-	column += step; 
-	current_char_pos_ += step;
-	current_char = (current_char_pos_ < code.length()) ? code[current_char_pos_] : '\0';
-	if (current_char == '\n') {
-		++line;
-		column = -1;
+	for (; step > 0 && current_char_pos_ < static_cast<int>(code.length()); --step) {
+		if (current_char == '\n') newLine(current_char_pos_);
+		moveTo(current_char_pos_ + 1);
 	}
+	if (step > 0) moveTo(current_char_pos_ + step);
+}
+
+void CharStream::moveTo(size_t pos) {
+	current_char_pos_ = static_cast<int>(pos);
+	current_char = (pos < code.length()) ? code[pos] : '\0';
+}
+
+// Count the newlines in code[begin, end) with the Scanner
+void CharStream::countLines(size_t begin, size_t end) {
+	size_t last_newline = 0;
+	size_t newlines = scanner_->countNewlines(code.data(), begin, end, &last_newline);
+	if (!newlines) return;
+	line_ += static_cast<int>(newlines);
+	line_start_ = static_cast<int>(last_newline) + 1;
 }
 
-// Skip the comments
+// Skip the comments, stops on the newline so no lines are passed
 void CharStream::skipComments() { 
-	while (hasNext() && current_char != '\n') advance();
+	moveTo(scanner_->findByte(code.data(), current_char_pos_, code.length(), '\n'));
 }
 
-// Skip space
+// Skip space, short runs are counted inline and long ones (indentation, blank lines) with the Scanner
 void CharStream::skipSpace() { 
-	while (isSpace()) advance();
-}
\ No newline at end of file
+	size_t pos = current_char_pos_, end = code.length(), short_end = std::min(end, pos + SHORT_RUN);
+	for (; pos < short_end && charClass(code[pos]) == CharClass::SPACE; ++pos)
+		if (code[pos] == '\n') newLine(pos);
+	if (pos == short_end && pos < end) {
+		size_t run_end = scanner_->skipSpace(code.data(), pos, end);
+		countLines(pos, run_end);
+		pos = run_end;
+	}
+	moveTo(pos);
+}
+
+// Skip letters
+void CharStream::skipAlpha() {
+	moveTo(scanRun(code, current_char_pos_, [](char c) { return charClass(c) == CharClass::ALPHA; }, scanner_->skipAlpha));
+}
+
+// Skip digits and dots
+void CharStream::skipNumber() {
+	moveTo(scanRun(code, current_char_pos_, [](char c) { return charClass(c) == CharClass::DIGIT || c == '.'; }, scanner_->skipNumber));
+}
+
+// Skip to next c, strings may span lines
+void CharStream::skipTo(char c) {
+	size_t pos = scanner_->findByte(code.data(), current_char_pos_, code.length(), c);
+	countLines(current_char_pos_, pos);
+	moveTo(pos);
+}
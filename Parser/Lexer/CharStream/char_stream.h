@@ -2,24 +2,42 @@
 #define CHAR_STREAM_H
 
 #include <string>
+#include <string_view>
 #include <cctype>
-#include <vector>
+#include <initializer_list>
+#include "scanner.h"
 
+// Reads the source through a view, the caller keeps the buffer alive while the stream is used.
+// Runs of spaces, comments, names, numbers and strings are skipped with the vectorized Scanner,
+// newlines inside a skipped run are counted in bulk instead of checking every char.
 class CharStream {
 private:
 	int current_char_pos_;
+	const Scanner* scanner_;
+	int line_;
+	int line_start_; // Offset of the first char of line_
+	void newLine(size_t pos) { ++line_; line_start_ = static_cast<int>(pos) + 1; } // Passed the newline at pos
+	void countLines(size_t begin, size_t end); // Pass all newlines in code[begin, end)
+	void moveTo(size_t pos); // Jump to offset pos, lines are not updated
 public:
-	int line;
-	int column;
-	std::string code;
-	char current_char;	
+	std::string_view code;
+	char current_char;
 
 public:
-	CharStream(): line(1), current_char_pos_(-1), column(-1) {}
-	void initStream(const std::string& str); // Init stream
+	CharStream(): current_char_pos_(-1), scanner_(&defaultScanner()), line_(1), line_start_(0) {}
+	void initStream(std::string_view str); // Init stream
+	void initStream(std::string_view str, size_t start, int line, size_t line_start); // Start at offset start of the given line, line_start is the offset of its first char
+	void setScanner(const Scanner& scanner) { scanner_ = &scanner; } // Force scalar, sse2 or avx2 scanning
+	int position() const { return current_char_pos_; } // Offset of current char in code
+	std::string_view slice(int start) const { return code.substr(start, current_char_pos_ - start); } // Text from start to current char
+	int line() const { return line_; } // Line of current char, from 1
+	int column() const { return current_char_pos_ - line_start_; } // Column of current char, from 0
 	void advance(int step = 1); // Move to next char
-	void skipComments(); // Skip the comments
+	void skipComments(); // Skip to the end of line
 	void skipSpace(); // Skip space
+	void skipAlpha(); // Skip letters
+	void skipNumber(); // Skip digits and dots
+	void skipTo(char c); // Skip to next c or to the end of code
 	char peekNextChar(); // Get next char
 	char peekPrevChar(); // Get prev char
 
@@ -30,6 +48,6 @@ public:
 	bool isDigit(); // Is current char is digit
 	bool isAlpha(); // Is current char is alpha
 	bool isEndOfString(); // Is current char is \0
-	bool currcharInList(std::vector<int> list); // check if current char in list of char
+	bool currcharInList(std::initializer_list<int> list); // check if current char in list of char
 };
-#endif // !CHAR_STREAM_H
\ No newline at end of file
+#endif // !CHAR_STREAM_H
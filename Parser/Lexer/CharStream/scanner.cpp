@@ -0,0 +1,240 @@
+#include <cstdlib>
+#include <cstring>
+#include "scanner.h"
+#include "char_class.h"
+
+// SSE2 is only part of the x86-64 baseline, 32-bit x86 builds use the scalar scanner
+#if defined(__x86_64__) || defined(_M_X64)
+#define DLANG_SCANNER_X86
+#include <immintrin.h>
+#endif
+#if defined(DLANG_SCANNER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define DLANG_SCANNER_AVX2
+#define DLANG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of lowest and highest set bit, mask != 0
+static inline unsigned lowestBit(unsigned mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned highestBit(unsigned mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+static inline unsigned popCount(unsigned mask) {
+#ifdef _MSC_VER
+	return __popcnt(mask);
+#else
+	return __builtin_popcount(mask);
+#endif
+}
+
+// Scalar versions, also used for the tails of the vector loops
+static size_t skipSpaceScalar(const char* data, size_t pos, size_t end) {
+	while (pos < end && charClass(data[pos]) == CharClass::SPACE) ++pos;
+	return pos;
+}
+
+static size_t skipAlphaScalar(const char* data, size_t pos, size_t end) {
+	while (pos < end && charClass(data[pos]) == CharClass::ALPHA) ++pos;
+	return pos;
+}
+
+static size_t skipNumberScalar(const char* data, size_t pos, size_t end) {
+	while (pos < end && (charClass(data[pos]) == CharClass::DIGIT || data[pos] == '.')) ++pos;
+	return pos;
+}
+
+static size_t findByteScalar(const char* data, size_t pos, size_t end, char c) {
+	const void* found = (pos < end) ? std::memchr(data + pos, c, end - pos) : nullptr;
+	return found ? static_cast<const char*>(found) - data : end;
+}
+
+static size_t countNewlinesScalar(const char* data, size_t pos, size_t end, size_t* last_newline) {
+	size_t count = 0;
+	for (; pos < end; ++pos) {
+		if (data[pos] != '\n') continue;
+		++count;
+		*last_newline = pos;
+	}
+	return count;
+}
+
+#ifdef DLANG_SCANNER_X86
+// SSE2: 16 bytes per step. Unsigned range checks use (c - low) <= (high - low) via min_epu8.
+static inline __m128i inRange128(__m128i chunk, char low, char high) {
+	__m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8(low));
+	__m128i width = _mm_set1_epi8(static_cast<char>(high - low));
+	return _mm_cmpeq_epi8(_mm_min_epu8(shifted, width), shifted);
+}
+
+static inline __m128i load128(const char* data, size_t pos) {
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+}
+
+static size_t skipSpaceSSE2(const char* data, size_t pos, size_t end) {
+	for (; pos + 16 <= end; pos += 16) {
+		__m128i chunk = load128(data, pos);
+		__m128i space = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), inRange128(chunk, '\t', '\r'));
+		unsigned stop = ~_mm_movemask_epi8(space) & 0xFFFF;
+		if (stop) return pos + lowestBit(stop);
+	}
+	return skipSpaceScalar(data, pos, end);
+}
+
+static size_t skipAlphaSSE2(const char* data, size_t pos, size_t end) {
+	for (; pos + 16 <= end; pos += 16) {
+		__m128i lower = _mm_or_si128(load128(data, pos), _mm_set1_epi8(0x20));
+		unsigned stop = ~_mm_movemask_epi8(inRange128(lower, 'a', 'z')) & 0xFFFF;
+		if (stop) return pos + lowestBit(stop);
+	}
+	return skipAlphaScalar(data, pos, end);
+}
+
+static size_t skipNumberSSE2(const char* data, size_t pos, size_t end) {
+	for (; pos + 16 <= end; pos += 16) {
+		__m128i chunk = load128(data, pos);
+		__m128i number = _mm_or_si128(inRange128(chunk, '0', '9'), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.')));
+		unsigned stop = ~_mm_movemask_epi8(number) & 0xFFFF;
+		if (stop) return pos + lowestBit(stop);
+	}
+	return skipNumberScalar(data, pos, end);
+}
+
+static size_t findByteSSE2(const char* data, size_t pos, size_t end, char c) {
+	__m128i needle = _mm_set1_epi8(c);
+	for (; pos + 16 <= end; pos += 16) {
+		unsigned found = _mm_movemask_epi8(_mm_cmpeq_epi8(load128(data, pos), needle));
+		if (found) return pos + lowestBit(found);
+	}
+	return findByteScalar(data, pos, end, c);
+}
+
+static size_t countNewlinesSSE2(const char* data, size_t pos, size_t end, size_t* last_newline) {
+	size_t count = 0;
+	__m128i newline = _mm_set1_epi8('\n');
+	for (; pos + 16 <= end; pos += 16) {
+		unsigned found = _mm_movemask_epi8(_mm_cmpeq_epi8(load128(data, pos), newline));
+		if (!found) continue;
+		count += popCount(found);
+		*last_newline = pos + highestBit(found);
+	}
+	return count + countNewlinesScalar(data, pos, end, last_newline);
+}
+#endif
+
+#ifdef DLANG_SCANNER_AVX2
+// AVX2: 32 bytes per step, compiled for AVX2 only in these functions
+DLANG_TARGET_AVX2 static inline __m256i inRange256(__m256i chunk, char low, char high) {
+	__m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8(low));
+	__m256i width = _mm256_set1_epi8(static_cast<char>(high - low));
+	return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, width), shifted);
+}
+
+DLANG_TARGET_AVX2 static inline __m256i load256(const char* data, size_t pos) {
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+}
+
+DLANG_TARGET_AVX2 static size_t skipSpaceAVX2(const char* data, size_t pos, size_t end) {
+	for (; pos + 32 <= end; pos += 32) {
+		__m256i chunk = load256(data, pos);
+		__m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), inRange256(chunk, '\t', '\r'));
+		unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(space));
+		if (stop) return pos + lowestBit(stop);
+	}
+	return skipSpaceSSE2(data, pos, end);
+}
+
+DLANG_TARGET_AVX2 static size_t skipAlphaAVX2(const char* data, size_t pos, size_t end) {
+	for (; pos + 32 <= end; pos += 32) {
+		__m256i lower = _mm256_or_si256(load256(data, pos), _mm256_set1_epi8(0x20));
+		unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(inRange256(lower, 'a', 'z')));
+		if (stop) return pos + lowestBit(stop);
+	}
+	return skipAlphaSSE2(data, pos, end);
+}
+
+DLANG_TARGET_AVX2 static size_t skipNumberAVX2(const char* data, size_t pos, size_t end) {
+	for (; pos + 32 <= end; pos += 32) {
+		__m256i chunk = load256(data, pos);
+		__m256i number = _mm256_or_si256(inRange256(chunk, '0', '9'), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('.')));
+		unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(number));
+		if (stop) return pos + lowestBit(stop);
+	}
+	return skipNumberSSE2(data, pos, end);
+}
+
+DLANG_TARGET_AVX2 static size_t findByteAVX2(const char* data, size_t pos, size_t end, char c) {
+	__m256i needle = _mm256_set1_epi8(c);
+	for (; pos + 32 <= end; pos += 32) {
+		unsigned found = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load256(data, pos), needle)));
+		if (found) return pos + lowestBit(found);
+	}
+	return findByteSSE2(data, pos, end, c);
+}
+
+DLANG_TARGET_AVX2 static size_t countNewlinesAVX2(const char* data, size_t pos, size_t end, size_t* last_newline) {
+	size_t count = 0;
+	__m256i newline = _mm256_set1_epi8('\n');
+	for (; pos + 32 <= end; pos += 32) {
+		unsigned found = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load256(data, pos), newline)));
+		if (!found) continue;
+		count += popCount(found);
+		*last_newline = pos + highestBit(found);
+	}
+	return count + countNewlinesSSE2(data, pos, end, last_newline);
+}
+#endif
+
+static const Scanner SCALAR_SCANNER = { "scalar", skipSpaceScalar, skipAlphaScalar, skipNumberScalar, findByteScalar, countNewlinesScalar };
+#ifdef DLANG_SCANNER_X86
+static const Scanner SSE2_SCANNER = { "sse2", skipSpaceSSE2, skipAlphaSSE2, skipNumberSSE2, findByteSSE2, countNewlinesSSE2 };
+#endif
+#ifdef DLANG_SCANNER_AVX2
+static const Scanner AVX2_SCANNER = { "avx2", skipSpaceAVX2, skipAlphaAVX2, skipNumberAVX2, findByteAVX2, countNewlinesAVX2 };
+#endif
+
+const Scanner* scannerByName(const char* name) {
+	if (!std::strcmp(name, "scalar")) return &SCALAR_SCANNER;
+#ifdef DLANG_SCANNER_X86
+	if (!std::strcmp(name, "sse2")) return &SSE2_SCANNER;
+#endif
+#ifdef DLANG_SCANNER_AVX2
+	if (!std::strcmp(name, "avx2") && __builtin_cpu_supports("avx2")) return &AVX2_SCANNER;
+#endif
+	return nullptr;
+}
+
+static const Scanner& selectScanner() {
+	if (const char* forced = std::getenv("DLANG_SCANNER"))
+		if (const Scanner* scanner = scannerByName(forced)) return *scanner;
+#ifdef DLANG_SCANNER_AVX2
+	if (__builtin_cpu_supports("avx2")) return AVX2_SCANNER;
+#endif
+#ifdef DLANG_SCANNER_X86
+	return SSE2_SCANNER;
+#else
+	return SCALAR_SCANNER;
+#endif
+}
+
+const Scanner& defaultScanner() {
+	static const Scanner& scanner = selectScanner();
+	return scanner;
+}
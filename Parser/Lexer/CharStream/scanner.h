@@ -0,0 +1,22 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <cstddef>
+
+// Byte scanners used by CharStream to jump over runs instead of advancing one char at a time.
+// Every function looks at data[pos, end) and returns the offset of the first byte that stops the run (or end).
+// The implementation (AVX2, SSE2 or scalar) is picked once at startup from what the CPU supports.
+struct Scanner {
+	const char* name;
+	size_t (*skipSpace)(const char* data, size_t pos, size_t end); // first byte that is not whitespace
+	size_t (*skipAlpha)(const char* data, size_t pos, size_t end); // first byte that is not a-z or A-Z
+	size_t (*skipNumber)(const char* data, size_t pos, size_t end); // first byte that is not a digit or '.'
+	size_t (*findByte)(const char* data, size_t pos, size_t end, char c); // first byte equal to c
+	// Number of '\n' in the range. last_newline is set to the offset of the last one found
+	size_t (*countNewlines)(const char* data, size_t pos, size_t end, size_t* last_newline);
+};
+
+// Best scanner for this CPU. The DLANG_SCANNER environment variable (scalar, sse2, avx2) overrides the choice.
+const Scanner& defaultScanner();
+const Scanner* scannerByName(const char* name); // nullptr if the name is unknown or the CPU lacks support
+#endif // !SCANNER_H
@@ -1,123 +1,87 @@
 #include "Lexer.h"
 #include "../../Error/error.h"
-
-// Key in resreved words?
-bool Lexer::isReservedKey(const std::string& key) {
-	return std::find(reserved_words.begin(), reserved_words.end(), key) != reserved_words.end();
-}
-
-// Is symbol in resereved symbols?
-bool Lexer::isReservedSymbol(char symbol) { 
-	return reserved_symbols.find(stream.current_char) != reserved_symbols.end(); 
-}
+#include "CharStream/char_class.h"
 
 // Lex variable name or command
-Token* Lexer::getId() {
-	std::string temp;
-	while (stream.isAlpha() && stream.hasNext()) { temp += stream.current_char; stream.advance(); }
-	if (isReservedKey(temp)) { return new Token(stream.line, stream.column - temp.length(), reserved_word_types.at(temp), temp); }
-	return new Token(stream.line, stream.column - temp.length(), TokenType::ID, temp);
+Token Lexer::getId() {
+	int start = stream.position();
+	size_t line = stream.line(), column = stream.column();
+	stream.skipAlpha();
+	std::string_view temp = stream.slice(start);
+	SymbolId symbol = keywordSymbol(temp);
+	if (symbol != NO_SYMBOL) return Token(line, column, KEYWORDS[symbol].type, temp, symbol);
+	return Token(line, column, TokenType::ID, temp, m_symbols.intern(temp));
 }
 
 // Lex nums
-Token* Lexer::getNum() {
-	std::string temp;
-	int dot_count = 0;
-	while ((stream.isDigit() || stream.currentCharEqual(TokenCode::DOT_CODE)) && stream.hasNext()) {
-		// lex float value
-		if (stream.currentCharEqual(TokenCode::DOT_CODE) && dot_count == 0) {
-			while (std::isdigit(stream.current_char && stream.hasNext())) {
-				temp += stream.current_char;
-				stream.advance();
-			}
-			dot_count++; 
-		} else { // lex int value
-			temp += stream.current_char;
-			stream.advance();
-		}
-	}
-	return new Token(stream.line, stream.column - temp.length(), ((dot_count > 0) ? TokenType::FLOAT : TokenType::INT), temp);
+Token Lexer::getNum() {
+	int start = stream.position();
+	size_t line = stream.line(), column = stream.column();
+	stream.skipNumber();
+	std::string_view temp = stream.slice(start);
+	bool is_float = temp.find('.') != std::string_view::npos; // lex float value
+	return Token(line, column, (is_float ? TokenType::FLOAT : TokenType::INT), temp);
 }
 
 // Lex string
-Token* Lexer::getString() { 
-	std::string temp;
-	while (stream.hasNext()) {
-		temp += stream.current_char;
-		stream.advance();
-		if (stream.currentCharEqual(TokenCode::QUOTE_CODE)) { temp += stream.current_char; stream.advance(); break; }
-	}
-	return new Token(stream.line, stream.column - temp.length(), TokenType::STRING, temp);
+Token Lexer::getString() { 
+	int start = stream.position();
+	size_t line = stream.line(), column = stream.column();
+	stream.advance(); // opening quote
+	stream.skipTo(TokenCode::QUOTE_CODE);
+	if (stream.currentCharEqual(TokenCode::QUOTE_CODE)) stream.advance(); // closing quote
+	return Token(line, column, TokenType::STRING, stream.slice(start));
 }
 
-// Lex symbols
-Token* Lexer::getSymbol() {
-	Token* token;
-	// <= >= == != += -= /= *= 
-	if (stream.currcharInList({ 
-		TokenCode::LESS_CODE, TokenCode::GREATER_CODE, TokenCode::EQUAL_CODE, 
-		TokenCode::NOT_CODE, TokenCode::PLUS_CODE, TokenCode::MINUS_CODE,
-		TokenCode::SLASH_CODE, TokenCode::MULTIPLY_CODE
-		}) && stream.nextCharEqual(TokenCode::EQUAL_CODE)){
-		std::string symbol = std::string(1, stream.current_char) + stream.peekNextChar();
-		token = new Token(stream.line, stream.column - 1, resreved_binary_operation_.at(symbol), symbol);
-		stream.advance(2);
-	}
-	// && ||
-	else if ((stream.currentCharEqual(TokenCode::LOGIC_AND_CODE) && stream.nextCharEqual(TokenCode::LOGIC_AND_CODE) ||
-		(stream.currentCharEqual(TokenCode::LOGIC_OR_CODE) && stream.nextCharEqual(TokenCode::LOGIC_OR_CODE)))) {
-		std::string symbol = std::string(1, stream.current_char) + stream.peekNextChar();
-		token = new Token(stream.line, stream.column - 1, resreved_binary_operation_.at(symbol), symbol);
-		stream.advance(2);
-	}
-	// ++ --
-	else if ((stream.currentCharEqual(TokenCode::PLUS_CODE) && stream.nextCharEqual(TokenCode::PLUS_CODE) ||
-		(stream.currentCharEqual(TokenCode::MINUS_CODE) && stream.nextCharEqual(TokenCode::MINUS_CODE)))) {
-		std::string symbol = std::string(1, stream.current_char) + stream.peekNextChar();
-		token = new Token(stream.line, stream.column - 1, resreved_binary_operation_.at(symbol), symbol);
+// Lex symbols: one lookup in the operator table, then at most three compares for two char operators
+Token Lexer::getSymbol() {
+	int start = stream.position();
+	size_t line = stream.line(), column = stream.column();
+	const OperatorState& state = OPERATOR_TABLE[static_cast<unsigned char>(stream.current_char)];
+	char next = stream.peekNextChar();
+	for (int i = 0; i < 3 && state.next[i]; ++i) {
+		if (state.next[i] != next) continue;
 		stream.advance(2);
+		return Token(line, column, state.pair[i], stream.slice(start));
 	}
-	// ->
-	else if (stream.currentCharEqual(TokenCode::MINUS_CODE) && stream.nextCharEqual(TokenCode::GREATER_CODE)) {
-		std::string symbol = std::string(1, stream.current_char) + stream.peekNextChar();
-		token = new Token(stream.line, stream.column - 1, resreved_binary_operation_.at(symbol), symbol);
-		stream.advance(2);
-	}
-	else {
-		token = new Token(stream.line, stream.column - 1, reserved_symbols.at(stream.current_char), std::string(1, stream.current_char));
-		stream.advance();
-	}
-	return token;
+	stream.advance();
+	return Token(line, column, state.single, stream.slice(start));
 }
 
-Token* Lexer::getToken() {
-	while (stream.hasNext()) {
-		while (stream.hasNext()) {
-			if (stream.isSpace()) { stream.skipSpace(); }
-			if (stream.currentCharEqual(TokenCode::SLASH_CODE) && stream.nextCharEqual(TokenCode::SLASH_CODE)) { stream.skipComments(); break; }
-			if (std::isalpha(stream.current_char)) { return getId(); }
-			if (std::isdigit(stream.current_char) || stream.currentCharEqual(TokenCode::DOT_CODE)) { return getNum(); }
-			if (stream.currentCharEqual(TokenCode::QUOTE_CODE)) { return getString(); }
-			if (isReservedSymbol(stream.current_char)) { return getSymbol(); }
-			if (stream.isEndOfString()) stream.advance();
-			else { raiseError(std::format("LEXICAL ERROR: Unknown token {} in {}:{}\n", stream.current_char, stream.line, stream.column)); }
-			stream.advance();
+Token Lexer::next() {
+	while (stream.hasNext() && static_cast<size_t>(stream.position()) < m_stop) {
+		switch (charClass(stream.current_char)) {
+			case CharClass::SPACE: stream.skipSpace(); break;
+			case CharClass::ALPHA: return getId();
+			case CharClass::DIGIT:
+			case CharClass::DOT: return getNum();
+			case CharClass::QUOTE: return getString();
+			case CharClass::SYMBOL:
+				if (stream.currentCharEqual(TokenCode::SLASH_CODE) && stream.nextCharEqual(TokenCode::SLASH_CODE)) { stream.skipComments(); break; }
+				return getSymbol();
+			default: raiseError(std::format("LEXICAL ERROR: Unknown token {} in {}:{}\n", stream.current_char, stream.line(), stream.column()));
 		}
 	}
-	return new Token(stream.line, stream.column, TokenType::END_OF_FILE, "EOF");
+	return Token(stream.line(), stream.column(), TokenType::END_OF_FILE, "EOF");
 }
 
-// Main function
-std::vector<Token*> Lexer::lex(const std::string& code, const char* file) {
+// Start lexing code, tokens are then pulled with next()
+void Lexer::begin(std::string_view code, const char* file) {
 	this->stream.initStream(code);
 	this->file_name = file;
-	m_tokens.clear();
-	Token* token = getToken();
-	while (token) {
-		m_tokens.push_back(token);
-		if (token->type == TokenType::END_OF_FILE) 
-			break;
-		token = getToken();
-	}
-	return m_tokens;
-} 
\ No newline at end of file
+	m_stop = SIZE_MAX;
+}
+
+void Lexer::beginRange(std::string_view code, size_t start, size_t stop, int line, size_t line_start) {
+	this->stream.initStream(code, start, line, line_start);
+	m_stop = stop;
+}
+
+// Main function
+std::vector<Token*> Lexer::lex(std::string_view code, const char* file) {
+	std::vector<Token*> tokens;
+	begin(code, file);
+	do tokens.push_back(m_arena.make<Token>(next()));
+	while (tokens.back()->type != TokenType::END_OF_FILE);
+	return tokens;
+}
@@ -1,19 +1,25 @@
 #ifndef LEXER_H
 #define LEXER_H
 
-#include <cctype>
-#include <map>
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 #include "CharStream/char_stream.h"
 #include "../Tokens/tokens.h"
+#include "lexer_tables.h"
+#include "../../Memory/arena.h"
 
+// Tokens from Lexer::lex live in the arena of the lexer that made them, Lexer::next returns them by value.
+// value is a view into the source buffer passed to the lexer, so the buffer must outlive the tokens.
 struct Token {
-	TokenType type;
-	std::string value;
-	size_t line, column;
-	Token(size_t line, size_t column, TokenType type, const std::string& value) 
-		: line(line), column(column), type(type), value(value) {}
+	TokenType type = TokenType::NONE;
+	SymbolId symbol = NO_SYMBOL; // Interned name of ID and keyword tokens
+	std::string_view value;
+	size_t line = 0, column = 0;
+	Token() = default;
+	Token(size_t line, size_t column, TokenType type, std::string_view value, SymbolId symbol = NO_SYMBOL) 
+		: line(line), column(column), type(type), symbol(symbol), value(value) {}
 };
 
 class Lexer{
@@ -21,40 +27,23 @@ public:
 	CharStream stream;
 	std::string file_name;
 
-	std::vector<std::string> reserved_words = { "var", "const", "int", "string", "char", "bool", "float", "void", "while", "for", "if", "else", "func" };
-	std::map<std::string, TokenType> reserved_word_types = {
-		{"var", TokenType::VAR_KEYWORD}, {"const", TokenType::CONST_KEYWORD}, {"while", TokenType::WHILE_KEYWORD}, {"for", TokenType::FOR_KEYWORD}, 
-		{"foreach", TokenType::FOREACH_KEYWORD}, {"if", TokenType::IF_KEYWORD}, {"else", TokenType::ELSE_KEYWORD}, {"func", TokenType::FUNC_KEYWORD}, 
-		{"int", TokenType::VARIABLE_TYPE}, {"float", TokenType::VARIABLE_TYPE}, {"char", TokenType::VARIABLE_TYPE}, {"bool", TokenType::VARIABLE_TYPE},
-		{"string", TokenType::VARIABLE_TYPE}, {"array", TokenType::VARIABLE_TYPE}, {"void", TokenType::VARIABLE_TYPE}
-	};
-	std::map<char, TokenType> reserved_symbols = {
-		{';', TokenType::SEMICOLON}, {':', TokenType::COLON}, {'=', TokenType::EQUAL}, {'.', TokenType::DOT}, {'"', TokenType::QUOTE}, {',', TokenType::COMMA},
-		{'<', TokenType::LESS}, {'>', TokenType::GREATER}, {'+', TokenType::PLUS}, {'-', TokenType::MINUS}, {'*', TokenType::MULTIPLY}, {'/', TokenType::DIVIDE},
-		{'!', TokenType::NOT}, {'(', TokenType::LRPAREN}, {')', TokenType::RRPAREN}, {'{', TokenType::LFPAREN}, {'}', TokenType::RFPAREN},
-		{'[', TokenType::LSPAREN}, {']', TokenType::RSPAREN}, {'|', TokenType::UNARY_LOGIC_OR}, {'&', TokenType::UNARY_LOGIC_AND}
-	};
-	std::map<std::string, TokenType> resreved_binary_operation_ = {
-		{">=", TokenType::GREATER_EQUAL}, {"<=", TokenType::LESS_EQUAL}, {"==", TokenType::EQUAL_EQUAL}, {"!=", TokenType::NOT_EQUAL},
-		{"||", TokenType::LOGIC_OR}, {"&&", TokenType::LOGIC_AND}, {"+=", TokenType::PLUS_EQUAL}, {"-=", TokenType::MINUS_EQUAL}, 
-		{"*=", TokenType::MULTIPLY_EQUAL}, {"/=", TokenType::DIVIDE_EQUAL}, {"++", TokenType::INCREMENT}, {"--", TokenType::DECREMENT},
-		{"->", TokenType::ANNOTATION}
-	};
-
 private:
-	std::vector<Token*> m_tokens;
+	Arena& m_arena;
+	SymbolTable& m_symbols;
+	size_t m_stop = SIZE_MAX; // Tokens starting at or after this offset are not lexed
 
 private:
-	Token* getId(); // Lex variable name or command
-	Token* getNum(); // Lex nums
-	Token* getString(); // Lex string
-	Token* getSymbol(); // Lex symbols
-	bool isReservedKey(const std::string& key); // Is key in resreved words?
-	bool isReservedSymbol(char symbol); // Is symbol in resreved symbols
-	Token* getToken();
+	Token getId(); // Lex variable name or command
+	Token getNum(); // Lex nums
+	Token getString(); // Lex string
+	Token getSymbol(); // Lex symbols
 
 public:
-	Lexer() = default;
-	std::vector<Token*> lex(const std::string& code, const char* file = "<stdin>"); // get list of tokens
+	Lexer(Arena& arena, SymbolTable& symbols): m_arena(arena), m_symbols(symbols) {}
+	void begin(std::string_view code, const char* file = "<stdin>"); // Start lexing code token by token
+	// Lex only the tokens that start in code[start, stop), the last one may run past stop. Used by ParallelLexer
+	void beginRange(std::string_view code, size_t start, size_t stop, int line, size_t line_start);
+	Token next(); // Next token, END_OF_FILE at the end (or at the stop of a range) and after it
+	std::vector<Token*> lex(std::string_view code, const char* file = "<stdin>"); // get list of tokens
 };
 #endif // !LEXER_H
\ No newline at end of file
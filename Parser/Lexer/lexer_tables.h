@@ -0,0 +1,109 @@
+#ifndef LEXER_TABLES_H
+#define LEXER_TABLES_H
+
+#include <array>
+#include <string_view>
+#include "../Tokens/tokens.h"
+#include "symbol_table.h"
+
+// Keyword and operator tables built at compile time, so constructing a Lexer costs nothing
+// and classifying a word or a symbol takes a fixed number of table lookups.
+
+struct Keyword {
+	std::string_view word;
+	TokenType type;
+};
+
+inline constexpr Keyword KEYWORDS[] = {
+	{ "var", TokenType::VAR_KEYWORD }, { "const", TokenType::CONST_KEYWORD }, { "while", TokenType::WHILE_KEYWORD },
+	{ "for", TokenType::FOR_KEYWORD }, { "if", TokenType::IF_KEYWORD }, { "else", TokenType::ELSE_KEYWORD },
+	{ "func", TokenType::FUNC_KEYWORD }, { "return", TokenType::RETURN_KEYWORD },
+	{ "int", TokenType::VARIABLE_TYPE }, { "float", TokenType::VARIABLE_TYPE }, { "char", TokenType::VARIABLE_TYPE },
+	{ "bool", TokenType::VARIABLE_TYPE }, { "string", TokenType::VARIABLE_TYPE }, { "array", TokenType::VARIABLE_TYPE },
+	{ "void", TokenType::VARIABLE_TYPE }
+};
+
+// Perfect hash over KEYWORDS: first char, last char and length pick a unique slot
+constexpr size_t KEYWORD_TABLE_SIZE = 32;
+
+constexpr size_t keywordHash(std::string_view word) {
+	return (static_cast<unsigned char>(word.front()) + static_cast<unsigned char>(word.back()) * 20 + word.size()) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+struct KeywordTable {
+	std::array<Keyword, KEYWORD_TABLE_SIZE> slots{};
+	std::array<SymbolId, KEYWORD_TABLE_SIZE> symbols{};
+	bool collision = false;
+};
+
+constexpr KeywordTable buildKeywordTable() {
+	KeywordTable table;
+	for (SymbolId i = 0; i < std::size(KEYWORDS); ++i) {
+		size_t hash = keywordHash(KEYWORDS[i].word);
+		if (!table.slots[hash].word.empty()) table.collision = true;
+		table.slots[hash] = KEYWORDS[i];
+		table.symbols[hash] = i;
+	}
+	return table;
+}
+
+inline constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(!KEYWORD_TABLE.collision, "keywordHash is not perfect for KEYWORDS, pick new multipliers");
+
+// Returns the keyword type or ID
+constexpr TokenType keywordType(std::string_view word) {
+	const Keyword& slot = KEYWORD_TABLE.slots[keywordHash(word)];
+	return (slot.word == word) ? slot.type : TokenType::ID;
+}
+
+// Symbol of a keyword, SymbolTable interns KEYWORDS first. NO_SYMBOL for other words
+constexpr SymbolId keywordSymbol(std::string_view word) {
+	size_t hash = keywordHash(word);
+	return (KEYWORD_TABLE.slots[hash].word == word) ? KEYWORD_TABLE.symbols[hash] : NO_SYMBOL;
+}
+
+// Operator DFA: state per first char holds its one char token and up to three second char transitions
+struct OperatorState {
+	TokenType single = TokenType::NONE;
+	char next[3] = {};
+	TokenType pair[3] = { TokenType::NONE, TokenType::NONE, TokenType::NONE };
+};
+
+constexpr void addOperator(std::array<OperatorState, 256>& table, char first, char second, TokenType type) {
+	OperatorState& state = table[static_cast<unsigned char>(first)];
+	for (int i = 0; i < 3; ++i) {
+		if (state.next[i]) continue;
+		state.next[i] = second;
+		state.pair[i] = type;
+		return;
+	}
+}
+
+constexpr std::array<OperatorState, 256> buildOperatorTable() {
+	std::array<OperatorState, 256> table{};
+	constexpr std::pair<char, TokenType> singles[] = {
+		{ ';', TokenType::SEMICOLON }, { ':', TokenType::COLON }, { '=', TokenType::EQUAL }, { '.', TokenType::DOT }, { '"', TokenType::QUOTE },
+		{ ',', TokenType::COMMA }, { '<', TokenType::LESS }, { '>', TokenType::GREATER }, { '+', TokenType::PLUS }, { '-', TokenType::MINUS },
+		{ '*', TokenType::MULTIPLY }, { '/', TokenType::DIVIDE }, { '!', TokenType::NOT }, { '(', TokenType::LRPAREN }, { ')', TokenType::RRPAREN },
+		{ '{', TokenType::LFPAREN }, { '}', TokenType::RFPAREN }, { '[', TokenType::LSPAREN }, { ']', TokenType::RSPAREN },
+		{ '|', TokenType::UNARY_LOGIC_OR }, { '&', TokenType::UNARY_LOGIC_AND }
+	};
+	for (const auto& [c, type] : singles) table[static_cast<unsigned char>(c)].single = type;
+	addOperator(table, '>', '=', TokenType::GREATER_EQUAL);
+	addOperator(table, '<', '=', TokenType::LESS_EQUAL);
+	addOperator(table, '=', '=', TokenType::EQUAL_EQUAL);
+	addOperator(table, '!', '=', TokenType::NOT_EQUAL);
+	addOperator(table, '+', '=', TokenType::PLUS_EQUAL);
+	addOperator(table, '-', '=', TokenType::MINUS_EQUAL);
+	addOperator(table, '*', '=', TokenType::MULTIPLY_EQUAL);
+	addOperator(table, '/', '=', TokenType::DIVIDE_EQUAL);
+	addOperator(table, '|', '|', TokenType::LOGIC_OR);
+	addOperator(table, '&', '&', TokenType::LOGIC_AND);
+	addOperator(table, '+', '+', TokenType::INCREMENT);
+	addOperator(table, '-', '-', TokenType::DECREMENT);
+	addOperator(table, '-', '>', TokenType::ANNOTATION);
+	return table;
+}
+
+inline constexpr std::array<OperatorState, 256> OPERATOR_TABLE = buildOperatorTable();
+#endif // !LEXER_TABLES_H
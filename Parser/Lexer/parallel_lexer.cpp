@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <stdexcept>
+#include "parallel_lexer.h"
+
+struct ParallelLexer::Chunk {
+	size_t begin = 0, end = 0; // begin is the first char of a line, end the char after a newline
+	size_t newlines = 0; // Newlines in [begin, end)
+	size_t base_line = 1; // Line of begin in the whole buffer
+	SymbolTable symbols;
+	std::vector<Token> tokens; // Lines counted from begin, symbols from the chunk table
+	std::vector<SymbolId> remap; // Chunk symbol to shared symbol
+	size_t first_token = 0; // Index of the first token in the result
+	size_t stop = 0; // Offset the lexer stopped at
+	int stop_line = 0, stop_column = 0;
+	bool kept = true; // False if the last token of an earlier chunk covers the whole chunk
+	bool failed = false;
+};
+
+// Offset of the char after the token
+static size_t tokenEnd(const Token& token, std::string_view code) {
+	return static_cast<size_t>(token.value.data() - code.data()) + token.value.size();
+}
+
+void ParallelLexer::lexChunk(Chunk& chunk, std::string_view code, size_t start) {
+	chunk.symbols = SymbolTable();
+	chunk.tokens.clear();
+	chunk.failed = false;
+	// When lexed again the start is the end of a string, maybe in the middle of a line
+	size_t last_newline = 0;
+	size_t newlines = start > chunk.begin ? defaultScanner().countNewlines(code.data(), chunk.begin, start, &last_newline) : 0;
+	Arena arena; // Lexer::next doesn't allocate
+	Lexer lexer(arena, chunk.symbols);
+	lexer.beginRange(code, start, chunk.end, 1 + static_cast<int>(newlines), newlines ? last_newline + 1 : chunk.begin);
+	try {
+		for (Token token = lexer.next(); token.type != TokenType::END_OF_FILE; token = lexer.next())
+			chunk.tokens.push_back(token);
+	}
+	catch (const std::runtime_error&) { chunk.failed = true; }
+	chunk.stop = lexer.stream.position();
+	chunk.stop_line = lexer.stream.line();
+	chunk.stop_column = lexer.stream.column();
+}
+
+// Main function
+std::vector<Token*> ParallelLexer::lex(std::string_view code, const char* file) {
+	Lexer serial(m_arena, m_symbols);
+	size_t chunk_count = std::min(code.size() / MIN_CHUNK_SIZE, m_pool.size() * 4);
+	m_stats = { 1, 0 };
+	if (chunk_count < 2) return serial.lex(code, file);
+
+	// Cut after newlines and lex every chunk as if it started between tokens
+	std::vector<Chunk> chunks(chunk_count);
+	size_t begin = 0, used = 0;
+	for (size_t i = 0; i < chunk_count && begin < code.size(); ++i, ++used) {
+		size_t end = code.size();
+		if (i + 1 < chunk_count) end = std::min(code.size(), defaultScanner().findByte(code.data(), std::max(begin, code.size() * (i + 1) / chunk_count), code.size(), '\n') + 1);
+		chunks[i].begin = begin;
+		chunks[i].end = end;
+		begin = end;
+	}
+	chunks.resize(used);
+	for (Chunk& chunk : chunks) {
+		m_pool.submit([this, &chunk, code] {
+			size_t last_newline = 0;
+			chunk.newlines = defaultScanner().countNewlines(code.data(), chunk.begin, chunk.end, &last_newline);
+			lexChunk(chunk, code, chunk.begin);
+		});
+	}
+	m_pool.wait();
+
+	// Fix up in order: a string crossing a cut means the next chunk was lexed from the wrong state
+	m_stats = { chunks.size(), 0 };
+	size_t covered = 0, base_line = 1, total = 0; // covered is the end of the last token kept so far
+	const Chunk* last = nullptr; // Last chunk kept, the end of file is where its lexer stopped
+	for (Chunk& chunk : chunks) {
+		chunk.base_line = base_line;
+		base_line += chunk.newlines;
+		// A chunk swallowed by a token, or after a chunk that stopped early at a NUL as the serial lexer does
+		if (covered >= chunk.end || (last && last->stop < last->end)) {
+			chunk.kept = false;
+			continue;
+		}
+		if (covered > chunk.begin) {
+			lexChunk(chunk, code, covered);
+			++m_stats.relexed;
+		}
+		if (chunk.failed) return serial.lex(code, file); // Throws the same error as the serial lexer
+		if (!chunk.tokens.empty()) covered = tokenEnd(chunk.tokens.back(), code);
+		chunk.first_token = total;
+		total += chunk.tokens.size();
+		last = &chunk;
+	}
+	Token end_of_file(last->base_line + last->stop_line - 1, last->stop_column, TokenType::END_OF_FILE, "EOF");
+
+	// Merge the chunk tables in order, names get the ids the serial lexer would give them
+	for (Chunk& chunk : chunks) {
+		if (!chunk.kept) continue;
+		chunk.remap.resize(chunk.symbols.size());
+		for (SymbolId symbol = 0; symbol < chunk.symbols.size(); ++symbol)
+			chunk.remap[symbol] = m_symbols.intern(chunk.symbols.name(symbol));
+	}
+
+	// Copy into one arena array with lines and symbols of the whole buffer
+	Token* array = static_cast<Token*>(m_arena.allocate(sizeof(Token) * (total + 1), alignof(Token)));
+	std::vector<Token*> tokens(total + 1);
+	for (Chunk& chunk : chunks) {
+		if (!chunk.kept) continue;
+		m_pool.submit([&chunk, array, &tokens] {
+			size_t shift = chunk.base_line - 1;
+			for (size_t i = 0; i < chunk.tokens.size(); ++i) {
+				Token* token = new (&array[chunk.first_token + i]) Token(chunk.tokens[i]);
+				token->line += shift;
+				if (token->symbol != NO_SYMBOL) token->symbol = chunk.remap[token->symbol];
+				tokens[chunk.first_token + i] = token;
+			}
+		});
+	}
+	m_pool.wait();
+	tokens[total] = new (&array[total]) Token(end_of_file);
+	return tokens;
+}
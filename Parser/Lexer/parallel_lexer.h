@@ -0,0 +1,49 @@
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include <string_view>
+#include <vector>
+#include "lexer.h"
+#include "../../Thread/thread_pool.h"
+
+// Lexes one big buffer on several threads, the result is the same as Lexer::lex token for token.
+//
+// The buffer is cut into chunks right after a newline. A chunk can't start inside a // comment
+// (comments end at the newline), but it can start inside a string that spans lines, and that
+// is only known once the chunks before it are lexed. So:
+//  1. every chunk is lexed in parallel as if it started between two tokens (speculation),
+//     with its own symbol table and lines counted from the chunk start;
+//  2. a serial pass walks the chunks in order: a chunk whose first bytes belong to the last
+//     token of the previous one (a string crossing the cut) is lexed again from the end of
+//     that token, a chunk swallowed whole by it is dropped. A NUL ends the buffer as in Lexer::lex,
+//     the chunks after the one that stopped at it are dropped too;
+//  3. tokens are copied into one arena array in parallel, with their line shifted by the
+//     newlines before the chunk and their symbol mapped into the shared table.
+//     Chunk tables are merged in chunk order, so symbols are numbered in order of first use as in Lexer::lex.
+// Any lexical error falls back to Lexer::lex so the message and its position are the serial ones.
+// lex() waits on the pool, so it must not run inside a task of that same pool.
+class ParallelLexer {
+public:
+	static constexpr size_t MIN_CHUNK_SIZE = 1 << 20; // Smaller files are lexed serially
+	struct Stats {
+		size_t chunks = 0;
+		size_t relexed = 0; // Chunks whose speculation failed
+	};
+
+private:
+	struct Chunk;
+
+	Arena& m_arena;
+	SymbolTable& m_symbols;
+	ThreadPool& m_pool;
+	Stats m_stats;
+
+private:
+	void lexChunk(Chunk& chunk, std::string_view code, size_t start); // Lex the tokens starting in [start, chunk end)
+
+public:
+	ParallelLexer(Arena& arena, SymbolTable& symbols, ThreadPool& pool): m_arena(arena), m_symbols(symbols), m_pool(pool) {}
+	std::vector<Token*> lex(std::string_view code, const char* file = "<stdin>"); // Same tokens as Lexer::lex
+	const Stats& stats() const { return m_stats; }
+};
+#endif // !PARALLEL_LEXER_H
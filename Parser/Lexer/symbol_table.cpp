@@ -0,0 +1,50 @@
+#include "symbol_table.h"
+#include "lexer_tables.h"
+
+// FNV-1a, names are short
+static uint32_t hashName(std::string_view name) {
+	uint32_t hash = 2166136261u;
+	for (char c : name) hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+	return hash;
+}
+
+SymbolTable::SymbolTable() {
+	m_slots.assign(256, NO_SYMBOL);
+	for (const Keyword& keyword : KEYWORDS) intern(keyword.word);
+}
+
+// Double the slots once they are half full
+void SymbolTable::grow() {
+	m_slots.assign(m_slots.size() * 2, NO_SYMBOL);
+	size_t mask = m_slots.size() - 1;
+	for (SymbolId symbol = 0; symbol < m_entries.size(); ++symbol) {
+		size_t slot = m_entries[symbol].hash & mask;
+		while (m_slots[slot] != NO_SYMBOL) slot = (slot + 1) & mask;
+		m_slots[slot] = symbol;
+	}
+}
+
+SymbolId SymbolTable::intern(std::string_view name) {
+	uint32_t hash = hashName(name);
+	size_t mask = m_slots.size() - 1;
+	size_t slot = hash & mask;
+	for (; m_slots[slot] != NO_SYMBOL; slot = (slot + 1) & mask) {
+		const Entry& entry = m_entries[m_slots[slot]];
+		if (entry.hash == hash && entry.name == name) return m_slots[slot];
+	}
+	SymbolId symbol = static_cast<SymbolId>(m_entries.size());
+	m_entries.push_back({ m_names ? m_names->copy(name) : name, hash });
+	m_slots[slot] = symbol;
+	if (m_entries.size() * 2 > m_slots.size()) grow();
+	return symbol;
+}
+
+SymbolId SymbolTable::find(std::string_view name) const {
+	uint32_t hash = hashName(name);
+	size_t mask = m_slots.size() - 1;
+	for (size_t slot = hash & mask; m_slots[slot] != NO_SYMBOL; slot = (slot + 1) & mask) {
+		const Entry& entry = m_entries[m_slots[slot]];
+		if (entry.hash == hash && entry.name == name) return m_slots[slot];
+	}
+	return NO_SYMBOL;
+}
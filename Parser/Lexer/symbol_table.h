@@ -0,0 +1,37 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../../Memory/arena.h"
+
+// Interned name, later stages compare and hash these instead of strings
+using SymbolId = uint32_t;
+constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+// Every identifier and keyword of a compilation is interned here once.
+// Keywords are interned first, so the symbol of KEYWORDS[i] is i (see keywordSymbol).
+// Names are views into the source buffer, the table lives as long as the tokens that refer to it.
+// A source that changes while the table lives (IncrementalParser) sets a name arena to copy new names into.
+class SymbolTable {
+private:
+	struct Entry {
+		std::string_view name;
+		uint32_t hash;
+	};
+	std::vector<Entry> m_entries; // Indexed by SymbolId
+	std::vector<SymbolId> m_slots; // Open addressing over m_entries, NO_SYMBOL is empty
+	Arena* m_names = nullptr;
+
+	void grow();
+
+public:
+	SymbolTable();
+	void setNameArena(Arena* arena) { m_names = arena; } // Copy names interned from now on into arena
+	SymbolId intern(std::string_view name); // Symbol of name, added if new
+	SymbolId find(std::string_view name) const; // NO_SYMBOL if name was never interned
+	std::string_view name(SymbolId symbol) const { return m_entries[symbol].name; }
+	size_t size() const { return m_entries.size(); }
+};
+#endif // !SYMBOL_TABLE_H
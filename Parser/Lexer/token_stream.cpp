@@ -0,0 +1,27 @@
+#include "token_stream.h"
+
+// Stream from a lexer that has begun
+void TokenStream::reset(Lexer& lexer) {
+	m_lexer = &lexer;
+	m_list = nullptr;
+	m_pos = m_pulled = 0;
+}
+
+// Walk a token list
+void TokenStream::reset(const std::vector<Token*>& tokens) {
+	m_lexer = nullptr;
+	m_list = &tokens;
+	m_pos = m_pulled = 0;
+}
+
+// Token by index, past the end of a list the END_OF_FILE token is repeated like the lexer does
+Token* TokenStream::at(size_t index) {
+	if (m_list) return (*m_list)[(index < m_list->size()) ? index : m_list->size() - 1];
+	for (; m_pulled <= index; ++m_pulled) m_ring[m_pulled % WINDOW] = m_lexer->next();
+	return &m_ring[index % WINDOW];
+}
+
+// List tokens already live in the arena, streamed ones are copied out of the ring
+Token* TokenStream::keep(Token* token, Arena& arena) {
+	return m_list ? token : arena.make<Token>(*token);
+}
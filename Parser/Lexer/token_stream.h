@@ -0,0 +1,34 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <array>
+#include <vector>
+#include "lexer.h"
+
+// Lookahead window the parser reads tokens through.
+// Streaming from a Lexer, tokens are pulled on demand into a small ring buffer, so the full token list never exists:
+// a token pointer stays valid only while it is inside the window, tokens that AST nodes hold must go through keep().
+// Over a token list from Lexer::lex it just walks the list.
+class TokenStream {
+public:
+	static constexpr size_t WINDOW = 4; // Previous token, current token and two tokens of lookahead
+
+private:
+	Lexer* m_lexer = nullptr;
+	const std::vector<Token*>* m_list = nullptr;
+	std::array<Token, WINDOW> m_ring;
+	size_t m_pos = 0; // Index of the current token
+	size_t m_pulled = 0; // Tokens pulled from the lexer so far
+
+	Token* at(size_t index); // Token by index, pulls from the lexer up to it
+
+public:
+	void reset(Lexer& lexer); // Stream from a lexer that has begun
+	void reset(const std::vector<Token*>& tokens); // Walk a token list ending with END_OF_FILE
+	Token* current() { return at(m_pos); }
+	Token* peek(size_t distance = 1) { return at(m_pos + distance); } // distance up to WINDOW - 2
+	Token* prev() { return at(m_pos ? m_pos - 1 : 0); }
+	void advance() { ++m_pos; }
+	Token* keep(Token* token, Arena& arena); // Token that outlives the window, copied into the arena when streaming
+};
+#endif // !TOKEN_STREAM_H
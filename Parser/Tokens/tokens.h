@@ -17,6 +17,7 @@ enum TokenType {
 	IF_KEYWORD, 
 	ELSE_KEYWORD, 
 	FUNC_KEYWORD, 
+	RETURN_KEYWORD,
 	VARIABLE_TYPE, 
 	BLOCK,
 	ID, 
@@ -51,7 +52,8 @@ enum TokenType {
 	UNARY_LOGIC_AND, 
 	INCREMENT, 
 	DECREMENT,
-	ANNOTATION
+	ANNOTATION,
+	TOKEN_TYPE_COUNT // Number of token types, keep last
 };
 
 enum TokenCode {
@@ -0,0 +1,348 @@
+#include "flat_parser.h"
+#include "parser_tables.h"
+#include "../Error/error.h"
+
+void FlatParser::parse(const std::vector<Token*>& token_list) {
+	m_tokens.reset(token_list);
+	m_current_token = m_tokens.current(); // Set first token
+	parseStatements(false);
+}
+
+void FlatParser::parse(Lexer& lexer) {
+	m_tokens.reset(lexer);
+	m_current_token = m_tokens.current(); // Set first token
+	parseStatements(false);
+}
+
+// Apply current token
+void FlatParser::consume(TokenType type) {
+	if (isEndOfFile() || !match(type)) {
+		raiseError(std::format("SYNTAX ERROR: Unexpected Token {} in {}:{}\n", m_current_token->value, m_current_token->line, m_current_token->column));
+	}
+	m_current_token = advance();
+}
+
+Token* FlatParser::advance() {
+	m_tokens.advance();
+	return m_tokens.current();
+}
+
+FlatParser::ListRange FlatParser::endList(size_t first) {
+	ListRange range{ m_ast.addList(std::span<const NodeId>(m_items).subspan(first)), static_cast<uint32_t>(m_items.size() - first) };
+	m_items.resize(first);
+	return range;
+}
+
+// Same dispatch table as Parser::parseOneStatement
+NodeId FlatParser::parseOneStatement() {
+	using StatementRule = NodeId (*)(FlatParser&);
+	static constexpr std::array<StatementRule, TOKEN_TYPE_COUNT> STATEMENT_RULES = [] {
+		std::array<StatementRule, TOKEN_TYPE_COUNT> rules{};
+		rules[TokenType::ID] = [](FlatParser& parser) { return parser.parseIdStatement(); };
+		rules[TokenType::VAR_KEYWORD] = rules[TokenType::CONST_KEYWORD] = [](FlatParser& parser) { return parser.parseVarDeclaration(); };
+		rules[TokenType::IF_KEYWORD] = [](FlatParser& parser) { return parser.parseIf(); };
+		rules[TokenType::WHILE_KEYWORD] = [](FlatParser& parser) { return parser.parseWhile(); };
+		rules[TokenType::FUNC_KEYWORD] = [](FlatParser& parser) { return parser.parseFunc(); };
+		rules[TokenType::RETURN_KEYWORD] = [](FlatParser& parser) { return parser.parseReturn(); };
+		return rules;
+	}();
+
+	StatementRule rule = STATEMENT_RULES[m_current_token->type];
+	if (!rule) raiseError(std::format("SYNTAX ERROR: Unexpected Token near {} in {}:{}\n", m_tokens.prev()->value, m_tokens.prev()->line, m_tokens.prev()->column));
+	return rule(*this);
+}
+
+// Top level statements become roots, the statements of a block go on m_items
+void FlatParser::parseStatements(bool block) {
+	while (m_current_token->type != TokenType::END_OF_FILE) {
+		if (block && m_current_token->type == RFPAREN) break;
+		NodeId statement = parseOneStatement();
+		if (block) m_items.push_back(statement);
+		else m_ast.addRoot(statement);
+	}
+}
+
+NodeId FlatParser::parseIdStatement() {
+	if (matchNext(TokenType::INCREMENT) || matchNext(TokenType::DECREMENT)) return parseIncDec();
+	if (matchNext(TokenType::LRPAREN)) {
+		NodeId call = parseFuncCall();
+		consume(TokenType::SEMICOLON);
+		return call;
+	}
+	return parseVarReasign();
+}
+
+template<typename T>
+T FlatParser::literal(const Token* token) {
+	T value = 0;
+	if (!parseLiteral(token->value, value)) raiseError(std::format("SYNTAX ERROR: Literal {} is out of range in {}:{}\n", token->value, token->line, token->column));
+	return value;
+}
+
+// Tokens are read before they are consumed, a streamed token leaves the window soon after
+NodeId FlatParser::factor() {
+	Token* token = m_current_token;
+	switch (token->type) {
+		case TokenType::INT: {
+			uint64_t bits = static_cast<uint64_t>(literal<int64_t>(token));
+			NodeId node = m_ast.add(NodeKind::INT, token->type, spanOf(token), static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32));
+			consume(TokenType::INT);
+			return node;
+		}
+		case TokenType::FLOAT: {
+			uint64_t bits = std::bit_cast<uint64_t>(literal<double>(token));
+			NodeId node = m_ast.add(NodeKind::FLOAT, token->type, spanOf(token), static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32));
+			consume(TokenType::FLOAT);
+			return node;
+		}
+		case TokenType::STRING: {
+			NodeId node = m_ast.add(NodeKind::STR, token->type, spanOf(token), m_ast.addLiteral(token));
+			consume(TokenType::STRING);
+			return node;
+		}
+		case TokenType::LRPAREN: {
+			consume(TokenType::LRPAREN);
+			NodeId node = expr();
+			consume(TokenType::RRPAREN);
+			return node;
+		}
+		case TokenType::LSPAREN:
+			return parseArray();
+		case TokenType::ID: {
+			if (matchNext(TokenType::LRPAREN)) return parseFuncCall();
+			NodeId id = parseId();
+			if (match(TokenType::INCREMENT) || match(TokenType::DECREMENT)) {
+				TokenType operation = m_current_token->type;
+				SourceSpan span = spanOf(m_current_token);
+				consume(operation);
+				return m_ast.add(NodeKind::UN_OP, operation, span, id);
+			}
+			return id;
+		}
+		case TokenType::MINUS:
+		case TokenType::PLUS:
+		case TokenType::NOT: {
+			TokenType operation = token->type;
+			SourceSpan span = spanOf(token);
+			consume(operation);
+			return m_ast.add(NodeKind::UN_OP, operation, span, factor());
+		}
+		default: // Missing operand, like Parser::factor
+			raiseError(std::format("SYNTAX ERROR: Unexpected Token {} in {}:{}\n", m_current_token->value, m_current_token->line, m_current_token->column));
+			return NO_NODE;
+	}
+}
+
+NodeId FlatParser::parseExpression(int min_precedence) {
+	NodeId node = factor();
+	for (;;) {
+		const BinaryOperator& op = BINARY_OPERATORS[m_current_token->type];
+		if (op.precedence <= min_precedence) break;
+		TokenType operation = m_current_token->type;
+		SourceSpan span = spanOf(m_current_token);
+		consume(operation);
+		NodeId right = parseExpression(op.right_assoc ? op.precedence - 1 : op.precedence);
+		node = m_ast.add(NodeKind::BIN_OP, operation, span, node, right);
+	}
+	return node;
+}
+
+NodeId FlatParser::expr() {
+	return parseExpression(0);
+}
+
+NodeId FlatParser::parseId() {
+	if (!match(TokenType::ID)) return NO_NODE;
+	NodeId node = m_ast.add(NodeKind::ID, TokenType::ID, spanOf(m_current_token), m_current_token->symbol);
+	consume(TokenType::ID);
+	return node;
+}
+
+NodeId FlatParser::parseVarDeclaration() {
+	TokenType key_word = m_current_token->type;
+	SourceSpan span = spanOf(m_current_token);
+	uint32_t key_text = m_ast.tokenOperand(m_current_token);
+	switch (key_word) {
+		case TokenType::VAR_KEYWORD:
+		case TokenType::CONST_KEYWORD:
+			consume(key_word);
+			break;
+		default:
+			break;
+	}
+
+	NodeId id = parseId();
+	consume(TokenType::COLON);
+
+	SymbolId var_type = m_current_token->symbol;
+	if (var_type == keywordSymbol("void"))
+		raiseError(std::format("SYNTAX ERROR: variable type can't be void {}:{}", m_current_token->line, m_current_token->column));
+	consume(TokenType::VARIABLE_TYPE);
+	NodeId declaration = m_ast.add(NodeKind::EMPTY_VAR_DECL, key_word, span, id, var_type, key_text);
+
+	if (match(TokenType::SEMICOLON)) {
+		consume(TokenType::SEMICOLON);
+		return declaration;
+	}
+	SourceSpan assign = spanOf(m_current_token);
+	consume(TokenType::EQUAL);
+	NodeId node = m_ast.add(NodeKind::FULL_VAR_DECL, TokenType::EQUAL, assign, declaration, expr());
+	consume(TokenType::SEMICOLON);
+	return node;
+}
+
+NodeId FlatParser::parseVarReasign() {
+	NodeId id = parseId();
+	TokenType assign = m_current_token->type;
+	SourceSpan span = spanOf(m_current_token);
+	uint32_t assign_text = m_ast.tokenOperand(m_current_token);
+	switch (assign) {
+		case TokenType::EQUAL:
+		case TokenType::PLUS_EQUAL:
+		case TokenType::MINUS_EQUAL:
+		case TokenType::MULTIPLY_EQUAL:
+		case TokenType::DIVIDE_EQUAL:
+			consume(assign);
+			break;
+		default:
+			break;
+	}
+	NodeId expression = expr();
+	consume(TokenType::SEMICOLON);
+	return m_ast.add(NodeKind::REASIGN_VAR, assign, span, id, expression, assign_text);
+}
+
+NodeId FlatParser::parseListOfCode() {
+	SourceSpan span = spanOf(m_current_token);
+	consume(TokenType::LFPAREN);
+	size_t first = m_items.size();
+	parseStatements(true);
+	consume(TokenType::RFPAREN);
+	ListRange list = endList(first);
+	return m_ast.add(NodeKind::BLOCK_OF_CODE, TokenType::LFPAREN, span, list.first, list.count);
+}
+
+// Elements are any tokens between commas, like Parser::parseArray, and must all have one type like it checks
+NodeId FlatParser::parseArray() {
+	SourceSpan span = spanOf(m_current_token);
+	consume(TokenType::LSPAREN);
+	uint32_t first = NO_INDEX, count = 0;
+	TokenType type = TokenType::NONE;
+	size_t line = 0;
+	bool one_type = true;
+	while (m_current_token) {
+		uint32_t element = m_ast.addLiteral(m_current_token);
+		if (!count++) {
+			first = element;
+			type = m_current_token->type;
+			line = m_current_token->line;
+		}
+		one_type &= m_current_token->type == type;
+		if (m_current_token->type == TokenType::INT) literal<int64_t>(m_current_token);
+		else if (m_current_token->type == TokenType::FLOAT) literal<double>(m_current_token);
+		m_current_token = advance();
+		if (match(TokenType::RSPAREN)) {
+			consume(TokenType::RSPAREN);
+			break;
+		}
+		consume(TokenType::COMMA);
+	}
+	if (!one_type) raiseError(std::format("SYNTAX ERROR: All array elements must have one type! Error in line {}\n", line));
+	return m_ast.add(NodeKind::ARRAY, TokenType::LSPAREN, span, first, count);
+}
+
+// The return type comes after the parameters, so the FUNC_PARAM node is made here once it is read
+NodeId FlatParser::parseFunc() {
+	SourceSpan span = spanOf(m_current_token);
+	consume(TokenType::FUNC_KEYWORD);
+	NodeId func_name = parseId();
+	SourceSpan params_span = spanOf(m_current_token);
+	ListRange params = parseParameters();
+	consume(TokenType::ANNOTATION);
+	SymbolId return_type = m_current_token->symbol;
+	consume(TokenType::VARIABLE_TYPE);
+	NodeId signature = m_ast.add(NodeKind::FUNC_PARAM, TokenType::LRPAREN, params_span, params.first, params.count, return_type);
+	NodeId block = parseListOfCode();
+	return m_ast.add(NodeKind::FUNC, TokenType::FUNC_KEYWORD, span, func_name, signature, block);
+}
+
+FlatParser::ListRange FlatParser::parseParameters() {
+	consume(TokenType::LRPAREN);
+	size_t first = m_items.size();
+	while (m_current_token && !match(TokenType::RRPAREN)) {
+		TokenType key_word = m_current_token->type;
+		SourceSpan span = spanOf(m_current_token);
+		uint32_t key_text = m_ast.tokenOperand(m_current_token);
+		switch (key_word) {
+			case TokenType::VAR_KEYWORD:
+			case TokenType::CONST_KEYWORD:
+				consume(key_word);
+				break;
+			default:
+				break;
+		}
+		NodeId param_name = parseId();
+		consume(TokenType::COLON);
+		SymbolId var_type = m_current_token->symbol;
+		if (var_type == keywordSymbol("void"))
+			raiseError(std::format("SYNTAX ERROR: function parametr type can't be void {}:{}", m_current_token->line, m_current_token->column));
+		consume(TokenType::VARIABLE_TYPE);
+		m_items.push_back(m_ast.add(NodeKind::EMPTY_VAR_DECL, key_word, span, param_name, var_type, key_text));
+		if (match(TokenType::RRPAREN)) break;
+		consume(TokenType::COMMA);
+	}
+	consume(TokenType::RRPAREN);
+	return endList(first);
+}
+
+NodeId FlatParser::parseIncDec() {
+	NodeId id = parseId();
+	TokenType operation = m_current_token->type;
+	SourceSpan span = spanOf(m_current_token);
+	if (match(TokenType::INCREMENT) || match(TokenType::DECREMENT))
+		consume(operation);
+	consume(TokenType::SEMICOLON);
+	return m_ast.add(NodeKind::INC_DEC, operation, span, id);
+}
+
+NodeId FlatParser::parseIf() {
+	SourceSpan span = spanOf(m_current_token);
+	consume(TokenType::IF_KEYWORD);
+	consume(TokenType::LRPAREN);
+	NodeId condition = expr();
+	consume(TokenType::RRPAREN);
+	return m_ast.add(NodeKind::IF_STMT, TokenType::IF_KEYWORD, span, condition, parseListOfCode());
+}
+
+NodeId FlatParser::parseWhile() {
+	SourceSpan span = spanOf(m_current_token);
+	consume(TokenType::WHILE_KEYWORD);
+	consume(TokenType::LRPAREN);
+	NodeId condition = expr();
+	consume(TokenType::RRPAREN);
+	return m_ast.add(NodeKind::WHILE_STMT, TokenType::WHILE_KEYWORD, span, condition, parseListOfCode());
+}
+
+NodeId FlatParser::parseFuncCall() {
+	SourceSpan span = spanOf(m_current_token);
+	NodeId func_name = parseId();
+	consume(TokenType::LRPAREN);
+	size_t first = m_items.size();
+	while (!match(TokenType::RRPAREN)) {
+		NodeId arg = expr();
+		m_items.push_back(arg);
+		if (match(TokenType::RRPAREN)) break;
+		consume(TokenType::COMMA);
+	}
+	consume(TokenType::RRPAREN);
+	ListRange args = endList(first);
+	return m_ast.add(NodeKind::FUNC_CALL, TokenType::ID, span, func_name, args.first, args.count);
+}
+
+NodeId FlatParser::parseReturn() {
+	SourceSpan span = spanOf(m_current_token);
+	consume(TokenType::RETURN_KEYWORD);
+	NodeId expression = match(TokenType::SEMICOLON) ? NO_NODE : expr();
+	consume(TokenType::SEMICOLON);
+	return m_ast.add(NodeKind::RETURN_STMT, TokenType::RETURN_KEYWORD, span, expression);
+}
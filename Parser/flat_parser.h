@@ -0,0 +1,55 @@
+#ifndef FLAT_PARSER_H
+#define FLAT_PARSER_H
+
+#include "AST/flat_ast.h"
+#include "Lexer/token_stream.h"
+
+// Same grammar and errors as Parser, but emits a FlatAST directly: no node objects, no kept tokens.
+// Literal text in the tree points into the source, which must outlive it.
+class FlatParser {
+private:
+	FlatAST& m_ast;
+	TokenStream m_tokens;
+	Token* m_current_token = nullptr;
+	std::vector<NodeId> m_items; // Items of the lists being parsed, a nested list stacks on top of its parent's
+
+	struct ListRange { uint32_t first, count; };
+
+private:
+	bool match(TokenType type) { return m_current_token->type == type; }
+	bool matchNext(TokenType type) { return m_tokens.peek()->type == type; }
+	bool isEndOfFile() { return m_current_token->type == TokenType::END_OF_FILE; }
+	void consume(TokenType type); // Apply current token
+	Token* advance(); // Get token
+	static SourceSpan spanOf(const Token* token) { return { static_cast<uint32_t>(token->line), static_cast<uint32_t>(token->column) }; }
+	ListRange endList(size_t first); // Move m_items from first on into the tree
+
+	template<typename T>
+	T literal(const Token* token); // Value of an int or float literal, out of range is a syntax error
+
+	NodeId factor(); // Prefix part: literal, name, call, group or unary operator
+	NodeId parseExpression(int min_precedence); // Binary operators stronger than min_precedence
+	NodeId expr();
+
+	NodeId parseId();
+	NodeId parseVarDeclaration();
+	NodeId parseVarReasign();
+	NodeId parseIf();
+	NodeId parseWhile();
+	NodeId parseListOfCode();
+	NodeId parseArray();
+	NodeId parseFunc();
+	ListRange parseParameters(); // The FUNC_PARAM node waits for the return type, see parseFunc
+	NodeId parseIncDec();
+	NodeId parseFuncCall();
+	NodeId parseReturn();
+	NodeId parseIdStatement();
+	NodeId parseOneStatement(); // Dispatch on the first token
+	void parseStatements(bool block);
+
+public:
+	FlatParser(FlatAST& ast): m_ast(ast) {}
+	void parse(const std::vector<Token*>& token_list); // Append the statements of a token list to the roots of the tree
+	void parse(Lexer& lexer); // Pull tokens from a lexer that has begun
+};
+#endif // !FLAT_PARSER_H
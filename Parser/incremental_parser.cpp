@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include "incremental_parser.h"
+
+size_t IncrementalParser::lineStart(size_t offset) const {
+	size_t newline = offset ? m_text.rfind('\n', offset - 1) : std::string::npos;
+	return newline == std::string::npos ? 0 : newline + 1;
+}
+
+void IncrementalParser::open(std::string text) {
+	m_statements.clear();
+	m_failures = 0;
+	m_dead_bytes = 0;
+	m_symbols = SymbolTable();
+	m_arena.release();
+	m_symbols.setNameArena(&m_arena);
+	m_text = std::move(text);
+	m_stats = {};
+	reparse(0, 0, 0, 0, 0, 0);
+	updateError();
+}
+
+void IncrementalParser::edit(size_t offset, size_t removed, std::string_view inserted) {
+	offset = std::min(offset, m_text.size());
+	removed = std::min(removed, m_text.size() - offset);
+	ptrdiff_t line_delta = std::count(inserted.begin(), inserted.end(), '\n')
+		- std::count(m_text.begin() + offset, m_text.begin() + offset + removed, '\n');
+	size_t line_begin = lineStart(offset);
+	m_text.replace(offset, removed, inserted);
+
+	// Start one statement before the edited line: its last token is the "near" token of an error message.
+	// Failed ranges are never reused, so a range the edit reaches is parsed again and the others keep their error.
+	size_t first = std::partition_point(m_statements.begin(), m_statements.end(), [&](const Statement& statement) {
+		return statement.start <= line_begin;
+	}) - m_statements.begin();
+	first = first > 1 ? first - 2 : 0;
+	while (first && !m_statements[first].ast) --first; // A failed range can't supply the previous token
+	size_t start = first ? m_statements[first].start : 0;
+
+	// Statements on the edited lines change columns, so they are never reused
+	size_t newline = m_text.find('\n', offset + inserted.size());
+	size_t resync = newline == std::string::npos ? m_text.size() : newline + 1;
+	m_stats = {};
+	reparse(first, start, offset + removed, static_cast<ptrdiff_t>(inserted.size()) - static_cast<ptrdiff_t>(removed), line_delta, resync);
+	updateError();
+	compact();
+}
+
+void IncrementalParser::compact() {
+	size_t live = m_arena.bytesUsed() - m_dead_bytes;
+	if (m_dead_bytes < Arena::DEFAULT_BLOCK_SIZE || m_dead_bytes < live) return;
+	Stats stats = m_stats; // Of the edit, not of the full parse
+	open(std::move(m_text));
+	m_stats = stats;
+}
+
+void IncrementalParser::updateError() {
+	if (!m_failures) {
+		m_error.clear();
+		return;
+	}
+	auto failed = std::find_if(m_statements.begin(), m_statements.end(), [](const Statement& statement) { return !statement.ast; });
+	if (failed != m_statements.end() && failed->line != failed->lexed_line) {
+		// The message holds the old line, parse the range again where it is now
+		size_t index = failed - m_statements.begin();
+		size_t first = index ? index - 1 : 0;
+		while (first && !m_statements[first].ast) --first;
+		reparse(first, first ? m_statements[first].start : 0, failed->start + 1, 0, 0, 0);
+		failed = std::find_if(m_statements.begin(), m_statements.end(), [](const Statement& statement) { return !statement.ast; });
+	}
+	m_error = failed == m_statements.end() ? "" : std::string(failed->error);
+}
+
+void IncrementalParser::reparse(size_t first, size_t start, size_t old_end, ptrdiff_t delta, ptrdiff_t line_delta, size_t resync) {
+	std::vector<Statement> fresh;
+	size_t old = first, sync = m_statements.size();
+	size_t line = start ? m_statements[first].line : 1;
+	size_t statement_start = start, statement_line = line;
+	auto offsetOf = [this](const Token* token) {
+		return token->type == TokenType::END_OF_FILE ? m_text.size() : static_cast<size_t>(token->value.data() - m_text.data());
+	};
+	// Next old statement that can be reused once the new ones reach pos
+	auto reusable = [&](size_t pos) {
+		while (old < m_statements.size() && (m_statements[old].start < old_end || m_statements[old].start + delta < pos || !m_statements[old].ast)) ++old;
+		return old;
+	};
+
+	size_t used = m_arena.bytesUsed();
+	auto taken = [&] { // Arena bytes since the previous statement
+		size_t bytes = m_arena.bytesUsed() - used;
+		used = m_arena.bytesUsed();
+		return bytes;
+	};
+
+	Lexer lexer(m_arena, m_symbols);
+	Parser parser(m_arena);
+	lexer.beginRange(m_text, start, SIZE_MAX, static_cast<int>(line), lineStart(start));
+	try {
+		parser.begin(lexer, &m_lines);
+		while (true) {
+			Token* token = parser.currentToken();
+			statement_start = offsetOf(token);
+			statement_line = token->line;
+			if (statement_start >= resync && reusable(statement_start) < m_statements.size() && m_statements[old].start + delta == statement_start) {
+				sync = old;
+				break;
+			}
+			if (token->type == TokenType::END_OF_FILE) break;
+			m_lines.clear();
+			AST* ast = parser.parseNext();
+			std::span<size_t*> lines = m_arena.copy(m_lines);
+			fresh.push_back({ ast, statement_start, statement_line, statement_line, lines, {}, taken() });
+		}
+	}
+	catch (const std::runtime_error& err) {
+		// The failed range runs to the next old statement past everything the lexer has read
+		std::string_view error = m_arena.copy(std::string_view(err.what()));
+		fresh.push_back({ nullptr, statement_start, statement_line, statement_line, {}, error, taken() });
+		size_t read = std::max(static_cast<size_t>(lexer.stream.position()), resync);
+		sync = reusable(read + 1);
+	}
+	m_stats.parsed += fresh.size();
+	m_stats.reused = m_statements.size() - sync;
+	m_stats.lexed_bytes += static_cast<size_t>(lexer.stream.position()) - start;
+
+	for (size_t i = sync; i < m_statements.size(); ++i) {
+		m_statements[i].start += delta;
+		m_statements[i].line += line_delta;
+	}
+	m_failures -= std::count_if(m_statements.begin() + first, m_statements.begin() + sync, [](const Statement& statement) { return !statement.ast; });
+	m_failures += !fresh.empty() && !fresh.back().ast;
+	m_dead_bytes += taken(); // Lookahead tokens of the statement the parse synced on
+	for (size_t i = first; i < sync; ++i) m_dead_bytes += m_statements[i].bytes;
+	m_statements.erase(m_statements.begin() + first, m_statements.begin() + sync);
+	m_statements.insert(m_statements.begin() + first, fresh.begin(), fresh.end());
+}
+
+std::vector<AST*> IncrementalParser::ast() {
+	std::vector<AST*> list;
+	if (!m_error.empty()) return list;
+	list.reserve(m_statements.size());
+	for (Statement& statement : m_statements) {
+		if (statement.line != statement.lexed_line) {
+			for (size_t* line : statement.lines) *line += statement.line - statement.lexed_line;
+			statement.lexed_line = statement.line;
+		}
+		list.push_back(statement.ast);
+	}
+	return list;
+}
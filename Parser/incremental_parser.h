@@ -0,0 +1,74 @@
+#ifndef INCREMENTAL_PARSER_H
+#define INCREMENTAL_PARSER_H
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parser.h"
+
+// Keeps a script parsed while it is edited, for editor and REPL loops.
+//
+// The script is held as a list of top level statements, each one with the offset and line of its first token.
+// An edit re-lexes and re-parses from the statement before the edited line and stops as soon as a new statement
+// starts exactly where an old one (after the edited lines) now starts: the rest of the list is reused as is,
+// only its offsets and lines are moved. The work per edit depends on the statements it touches, not on the file.
+//
+// Nodes never point into the text: kept tokens and interned names are copied into the arena, so the text can be
+// edited in place. Lines of reused statements are fixed lazily in ast(). Replaced nodes stay in the arena until
+// they outweigh the live ones (and one arena block), then the script is parsed again into a fresh arena: memory
+// stays within about twice that of a full parse, and the full parse costs no more than the edits that caused it.
+// A syntax or lexical error is reported exactly as a full parse would report it. The failed range is kept as a
+// statement without a tree and parsed again by the edits that reach it, edits after it leave it alone.
+class IncrementalParser {
+public:
+	struct Stats {
+		size_t parsed = 0; // Statements (and failed ranges) parsed by the last open or edit
+		size_t reused = 0; // Statements kept from before the last edit
+		size_t lexed_bytes = 0; // Bytes of text lexed by the last open or edit
+	};
+
+private:
+	struct Statement {
+		AST* ast; // nullptr marks a range that failed to parse
+		size_t start; // Offset of the first token
+		size_t line; // Line of the first token
+		size_t lexed_line; // Line the statement was lexed at, ast() moves its line fields to line
+		std::span<size_t*> lines; // Line fields of its tokens and literal nodes
+		std::string_view error; // Message of a failed range, for its lexed_line
+		size_t bytes; // Arena bytes taken by its parse
+	};
+
+	Arena m_arena;
+	SymbolTable m_symbols;
+	std::string m_text;
+	std::vector<Statement> m_statements;
+	size_t m_failures = 0; // Statements without a tree
+	size_t m_dead_bytes = 0; // Arena bytes of replaced statements and of tokens lexed past a sync
+	std::vector<size_t*> m_lines;
+	std::string m_error;
+	Stats m_stats;
+
+private:
+	size_t lineStart(size_t offset) const; // Offset of the first char of the line holding offset
+	// Parse from statement first of the list (text offset start) until a new statement starts where an old one,
+	// from old_end in the old text, now starts. Sync happens at or after offset resync.
+	// The reused statements are moved by delta bytes and line_delta lines.
+	void reparse(size_t first, size_t start, size_t old_end, ptrdiff_t delta, ptrdiff_t line_delta, size_t resync);
+	void updateError(); // Error of the first failed range, parsed again if lines above it moved
+	void compact(); // Parse the whole text into a fresh arena once the dead bytes outweigh the live ones
+
+public:
+	IncrementalParser() { m_symbols.setNameArena(&m_arena); }
+	IncrementalParser(const IncrementalParser&) = delete;
+	IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+	void open(std::string text); // Parse a whole script, frees the nodes of the previous one
+	void edit(size_t offset, size_t removed, std::string_view inserted); // Replace removed bytes at offset
+	std::vector<AST*> ast(); // Top level statements, valid until the next open or edit, empty on error
+	const std::string& text() const { return m_text; }
+	const std::string& error() const { return m_error; } // Error of a full parse of text(), empty if it parses
+	const Stats& stats() const { return m_stats; }
+	size_t bytesReserved() const { return m_arena.bytesReserved(); } // Memory held by the trees and names
+};
+#endif // !INCREMENTAL_PARSER_H
@@ -1,31 +1,74 @@
 #include "parser.h"
+#include "parser_tables.h"
 #include "../Error/error.h"
 
 // Main function
-std::vector<AST*> Parser::parse(std::vector<Token*> token_list) {
-	tokens_ = std::move(token_list);
-	current_token_pos_ = 0; // Set current pos of token in tokens list
-	m_current_token = tokens_[current_token_pos_]; // Set first token
+std::vector<AST*> Parser::parse(const std::vector<Token*>& token_list) {
+	m_tokens.reset(token_list);
+	m_current_token = m_tokens.current(); // Set first token
+	m_lines = nullptr;
 	return parseStatement();
 }
 
+// Streaming parse, only the tokens kept by nodes are allocated
+std::vector<AST*> Parser::parse(Lexer& lexer) {
+	m_tokens.reset(lexer);
+	m_current_token = m_tokens.current(); // Set first token
+	m_lines = nullptr;
+	return parseStatement();
+}
+
+// Streaming parse one statement at a time, see parseNext
+void Parser::begin(Lexer& lexer, std::vector<size_t*>* lines) {
+	m_tokens.reset(lexer);
+	m_current_token = m_tokens.current(); // Set first token
+	m_lines = lines;
+}
+
+// Next top level statement, nullptr at the end of the tokens
+AST* Parser::parseNext() {
+	return isEndOfFile() ? nullptr : parseOneStatement();
+}
+
+// Statements are dispatched on the type of their first token through one table
+AST* Parser::parseOneStatement() {
+	using StatementRule = AST* (*)(Parser&);
+	static constexpr std::array<StatementRule, TOKEN_TYPE_COUNT> STATEMENT_RULES = [] {
+		std::array<StatementRule, TOKEN_TYPE_COUNT> rules{};
+		rules[TokenType::ID] = [](Parser& parser) -> AST* { return parser.parseIdStatement(); };
+		rules[TokenType::VAR_KEYWORD] = rules[TokenType::CONST_KEYWORD] = [](Parser& parser) -> AST* { return parser.parseVarDeclaration(); };
+		rules[TokenType::IF_KEYWORD] = [](Parser& parser) -> AST* { return parser.parseIf(); };
+		rules[TokenType::WHILE_KEYWORD] = [](Parser& parser) -> AST* { return parser.parseWhile(); };
+		rules[TokenType::FUNC_KEYWORD] = [](Parser& parser) -> AST* { return parser.parseFunc(); };
+		rules[TokenType::RETURN_KEYWORD] = [](Parser& parser) -> AST* { return parser.parseReturn(); };
+		return rules;
+	}();
+
+	StatementRule rule = STATEMENT_RULES[m_current_token->type];
+	if (!rule) raiseError(std::format("SYNTAX ERROR: Unexpected Token near {} in {}:{}\n", getPrevToken()->value, getPrevToken()->line, getPrevToken()->column));
+	return rule(*this);
+}
+
 std::vector<AST*> Parser::parseStatement(bool if_block) {
 	std::vector<AST*> ast;
 	while (m_current_token->type != TokenType::END_OF_FILE) {
 		if (if_block && m_current_token->type == RFPAREN) break;
-		else if (match(TokenType::ID)) { 
-			if(matchNext(TokenType::INCREMENT) || matchNext(TokenType::DECREMENT)) ast.push_back(parseIncDec());
-			else ast.push_back(parseVarReasign()); 
-		}
-		else if (m_current_token->value == "var" || m_current_token->value == "const") { ast.push_back(parseVarDeclaration()); }
-		else if (m_current_token->value == "if") { ast.push_back(parseIf()); }
-		else if (m_current_token->value == "while") { ast.push_back(parseWhile()); }
-		else if (m_current_token->value == "func") { ast.push_back(parseFunc()); }
-		else raiseError(std::format("SYNTAX ERROR: Unexpected Token near {} in {}:{}\n", getPrevToken()->value, getPrevToken()->line, getPrevToken()->column));
+		ast.push_back(parseOneStatement());
 	}
 	return ast;
 }
 
+// Statement starting with a name: increment, decrement, call or assignment
+AST* Parser::parseIdStatement() {
+	if (matchNext(TokenType::INCREMENT) || matchNext(TokenType::DECREMENT)) return parseIncDec();
+	if (matchNext(TokenType::LRPAREN)) {
+		AST* call = parseFuncCall();
+		consume(TokenType::SEMICOLON);
+		return call;
+	}
+	return parseVarReasign();
+}
+
 // Check current token
 bool Parser::match(TokenType type) {
 	if (m_current_token->type != type) { return false; }
@@ -52,112 +95,98 @@ void Parser::consume(TokenType type) {
 
 // Get next token
 Token* Parser::advance() {
-	return (current_token_pos_ < tokens_.size()) ? tokens_[++current_token_pos_] : nullptr;
+	m_tokens.advance();
+	return m_tokens.current();
 }
 
 Token* Parser::getNextToken() {
-	return tokens_[((current_token_pos_ + 1) < tokens_.size() ? current_token_pos_ + 1 : tokens_.size())];
+	return m_tokens.peek();
 }
 
 Token* Parser::getPrevToken() {
-	return tokens_[((current_token_pos_ - 1) > 0 ? current_token_pos_ - 1 : 0)];
+	return m_tokens.prev();
+}
+
+// Token stored in a node
+Token* Parser::keep(Token* token) {
+	Token* kept = m_tokens.keep(token, m_arena);
+	if (m_lines) {
+		kept->value = m_arena.copy(kept->value);
+		m_lines->push_back(&kept->line);
+	}
+	return kept;
 }
 
-// For math
+template<typename T>
+T Parser::literal(const Token* token) {
+	T value = 0;
+	if (!parseLiteral(token->value, value)) raiseError(std::format("SYNTAX ERROR: Literal {} is out of range in {}:{}\n", token->value, token->line, token->column));
+	return value;
+}
+
+// Prefix part of an expression: literal, name, call, group or unary operator
 AST* Parser::factor() {
 	AST* ast = nullptr;
-	if (match(TokenType::INT)) { 
-		ast = new IntNode(m_current_token); consume(TokenType::INT);
-		return ast; 
-	}
-	if (match(TokenType::STRING)) { 
-		ast = new StrNode(m_current_token); consume(TokenType::STRING);
-		return ast; 
-	}
-	if (match(TokenType::FLOAT)) { 
-		ast = new FloatNode(m_current_token); consume(TokenType::FLOAT);
-		return ast; 
-	}
-	if (match(TokenType::LRPAREN)) { 
-		consume(TokenType::LRPAREN); ast = expr(); consume(TokenType::RRPAREN); 
-		return ast; 
-	}
-	if (match(TokenType::LSPAREN)) return parseArray();
-	if (match(TokenType::ID)) {
-		AST* id = parseId();
-		if (match(TokenType::INCREMENT)) {
-			Token* operation = m_current_token;
-			consume(TokenType::INCREMENT); 
-			return new UnOpNode(operation, id);
-			
+	switch (m_current_token->type) {
+		case TokenType::INT:
+			ast = logLine(m_arena.make<IntNode>(keep(m_current_token), literal<int64_t>(m_current_token))); consume(TokenType::INT);
+			return ast;
+		case TokenType::STRING:
+			ast = logLine(m_arena.make<StrNode>(keep(m_current_token))); consume(TokenType::STRING);
+			return ast;
+		case TokenType::FLOAT:
+			ast = logLine(m_arena.make<FloatNode>(keep(m_current_token), literal<double>(m_current_token))); consume(TokenType::FLOAT);
+			return ast;
+		case TokenType::LRPAREN:
+			consume(TokenType::LRPAREN); ast = expr(); consume(TokenType::RRPAREN);
+			return ast;
+		case TokenType::LSPAREN:
+			return parseArray();
+		case TokenType::ID: {
+			if (matchNext(TokenType::LRPAREN)) return parseFuncCall();
+			AST* id = parseId();
+			if (match(TokenType::INCREMENT) || match(TokenType::DECREMENT)) {
+				Token* operation = keep(m_current_token);
+				consume(operation->type);
+				return m_arena.make<UnOpNode>(operation, id);
+			}
+			return id;
 		}
-		if (match(TokenType::DECREMENT)) {
-			Token* operation = m_current_token;
-			consume(TokenType::DECREMENT); 
-			return new UnOpNode(operation, id);
+		case TokenType::MINUS:
+		case TokenType::PLUS:
+		case TokenType::NOT: {
+			Token* token = keep(m_current_token);
+			consume(token->type);
+			return m_arena.make<UnOpNode>(token, factor());
 		}
-		return id;
-	}
-	if (match(TokenType::MINUS)) {  
-		Token* token = m_current_token; 
-		consume(TokenType::MINUS); ast = new UnOpNode(token, factor());
-		return ast; 
-	}
-	if (match(TokenType::PLUS)) { 
-		Token* token = m_current_token; 
-		consume(TokenType::PLUS); ast = new UnOpNode(token, factor());
-		return ast;
-	}
-	if (match(TokenType::NOT)) {
-		Token* token = m_current_token;
-		consume(TokenType::NOT); 
-		return new UnOpNode(token, factor());
+		default: // Missing operand, no pass ever sees a null expression
+			raiseError(std::format("SYNTAX ERROR: Unexpected Token {} in {}:{}\n", m_current_token->value, m_current_token->line, m_current_token->column));
+			return ast;
 	}
-	return ast;
 }
 
-AST* Parser::term() {
+// Pratt loop: one BINARY_OPERATORS lookup per operator, operands bind while their operator is stronger than min_precedence
+AST* Parser::parseExpression(int min_precedence) {
 	AST* ast = factor();
-	while (match(TokenType::MULTIPLY) || match(TokenType::DIVIDE) ||
-		match(TokenType::GREATER_EQUAL) || match(TokenType::LESS_EQUAL) ||
-		match(TokenType::EQUAL_EQUAL) || match(TokenType::NOT_EQUAL) ||
-		match(TokenType::LESS) || match(TokenType::GREATER)) {
-		Token* token = m_current_token;
-		if (match(TokenType::MULTIPLY)) { consume(TokenType::MULTIPLY); }
-		if (match(TokenType::DIVIDE)) { consume(TokenType::DIVIDE); }
-
-		if (match(TokenType::LESS)) { consume(TokenType::LESS); }
-		if (match(TokenType::GREATER)) { consume(TokenType::GREATER); }
-
-		if (match(TokenType::GREATER_EQUAL)) { consume(TokenType::GREATER_EQUAL); }
-		if (match(TokenType::LESS_EQUAL)) { consume(TokenType::LESS_EQUAL); }
-		if (match(TokenType::NOT_EQUAL)) { consume(TokenType::NOT_EQUAL); }
-		if (match(TokenType::EQUAL_EQUAL)) { consume(TokenType::EQUAL_EQUAL); }
-		ast = new BinOpNode(ast, token, factor());
+	for (;;) {
+		const BinaryOperator& op = BINARY_OPERATORS[m_current_token->type];
+		if (op.precedence <= min_precedence) break;
+		Token* token = keep(m_current_token);
+		consume(token->type);
+		ast = m_arena.make<BinOpNode>(ast, token, parseExpression(op.right_assoc ? op.precedence - 1 : op.precedence));
 	}
 	return ast;
 }
 
 AST* Parser::expr() {
-	AST* ast = term();
-	while (match(TokenType::PLUS) || match(TokenType::MINUS) ||
-		match(TokenType::LOGIC_AND) || match(TokenType::LOGIC_OR)) {
-		Token* token = m_current_token;
-		if (match(TokenType::PLUS)) { consume(TokenType::PLUS); }
-		if (match(TokenType::MINUS)) { consume(TokenType::MINUS); }
-
-		if (match(TokenType::LOGIC_AND)) { consume(TokenType::LOGIC_AND); }
-		if (match(TokenType::LOGIC_OR)) { consume(TokenType::LOGIC_OR); }
-		ast = new BinOpNode(ast, token, term());
-	}
-	return ast;
+	return parseExpression(0);
 }
 
 // Parse variable names
 IdNode* Parser::parseId() {
 	IdNode* ast = nullptr;
 	if (match(TokenType::ID)) {
-		ast = new IdNode(m_current_token);
+		ast = m_arena.make<IdNode>(keep(m_current_token));
 		consume(TokenType::ID);
 	}
 	return ast;
@@ -168,7 +197,7 @@ AST* Parser::parseVarDeclaration() {
 	AST* ast = nullptr;
 	
 	// Get var or const keyword
-	Token* key_word = m_current_token;
+	Token* key_word = keep(m_current_token);
 	switch (key_word->type) {
 		case TokenType::VAR_KEYWORD:
 		case TokenType::CONST_KEYWORD:
@@ -180,21 +209,21 @@ AST* Parser::parseVarDeclaration() {
 	consume(TokenType::COLON);
 	
 	// Get variable type
-	Token* var_type = m_current_token;
-	if (var_type->value == "void") 
+	Token* var_type = keep(m_current_token);
+	if (var_type->symbol == keywordSymbol("void")) 
 		raiseError(std::format("SYNTAX ERROR: variable type can't be void {}:{}", m_current_token->line, m_current_token->column));
 	consume(TokenType::VARIABLE_TYPE);
 	
 	// If current token is SEMICOLON create empty variable declaration node
 	if (match(TokenType::SEMICOLON)) { 
-		ast = new EmptyVarDeclNode(key_word, id, var_type);
+		ast = m_arena.make<EmptyVarDeclNode>(key_word, id, var_type);
 		consume(TokenType::SEMICOLON);
 		return ast;
 	}
 	// Else create full variable declaration node
-	Token* assign = m_current_token;
+	Token* assign = keep(m_current_token);
 	consume(TokenType::EQUAL);
-	ast = new FullVarDeclNode(new EmptyVarDeclNode(key_word, id, var_type), assign, expr());
+	ast = m_arena.make<FullVarDeclNode>(m_arena.make<EmptyVarDeclNode>(key_word, id, var_type), assign, expr());
 	consume(TokenType::SEMICOLON);
 	return ast;
 }
@@ -203,7 +232,7 @@ AST* Parser::parseVarDeclaration() {
 ReasignVarNode* Parser::parseVarReasign() {
 	IdNode* id = parseId(); // Get variable name
 	// Get expression assign operator
-	Token* assign = m_current_token;
+	Token* assign = keep(m_current_token);
 	switch (assign->type) {
 		case TokenType::EQUAL:
 		case TokenType::PLUS_EQUAL:
@@ -214,7 +243,7 @@ ReasignVarNode* Parser::parseVarReasign() {
 	}
 	AST* expression = expr();
 	consume(TokenType::SEMICOLON);
-	return new ReasignVarNode(id, assign, expression);
+	return m_arena.make<ReasignVarNode>(id, assign, expression);
 }
 
 // Parse list of code
@@ -222,7 +251,7 @@ BlockOfCodeNode* Parser::parseListOfCode() {
 	consume(TokenType::LFPAREN);
 	std::vector<AST*> list = parseStatement(true);
 	consume(TokenType::RFPAREN);
-	return new BlockOfCodeNode(list);
+	return m_arena.make<BlockOfCodeNode>(m_arena.copy(list));
 }
 
 // Parse array
@@ -230,7 +259,7 @@ ArrayNode* Parser::parseArray() {
 	consume(TokenType::LSPAREN);
 	std::vector<Token*> temp;
 	while (m_current_token) {
-		temp.push_back(m_current_token);
+		temp.push_back(keep(m_current_token));
 		m_current_token = advance();
 		if (match(TokenType::RSPAREN)) {
 			consume(TokenType::RSPAREN);
@@ -238,7 +267,12 @@ ArrayNode* Parser::parseArray() {
 		}
 		consume(TokenType::COMMA);
 	}
-	return new ArrayNode(temp);
+	for (Token* token : temp) {
+		if (token->type != temp[0]->type) raiseError(std::format("SYNTAX ERROR: All array elements must have one type! Error in line {}\n", temp[0]->line));
+		if (token->type == TokenType::INT) literal<int64_t>(token);
+		else if (token->type == TokenType::FLOAT) literal<double>(token);
+	}
+	return m_arena.make<ArrayNode>(m_arena.copy(temp));
 }
 
 // Parse function
@@ -247,17 +281,17 @@ FuncNode* Parser::parseFunc() {
 	IdNode* func_name = parseId();
 	FuncParamNode* params = parseParameters();
 	consume(TokenType::ANNOTATION);
-	Token* func_retyrn_type = m_current_token;
+	Token* func_retyrn_type = keep(m_current_token);
 	consume(TokenType::VARIABLE_TYPE);
-	return new FuncNode(func_name, params, func_retyrn_type, parseListOfCode());
+	return m_arena.make<FuncNode>(func_name, params, func_retyrn_type, parseListOfCode());
 }
 
 // Parse function parametrs
 FuncParamNode* Parser::parseParameters() {
 	consume(TokenType::LRPAREN);
 	std::vector<EmptyVarDeclNode*> params;
-	while (m_current_token) {
-		Token* key_word = m_current_token;
+	while (m_current_token && !match(TokenType::RRPAREN)) {
+		Token* key_word = keep(m_current_token);
 		switch (key_word->type) {
 			case TokenType::VAR_KEYWORD:
 			case TokenType::CONST_KEYWORD:
@@ -265,26 +299,26 @@ FuncParamNode* Parser::parseParameters() {
 		}
 		IdNode* param_name = parseId();
 		consume(TokenType::COLON);
-		Token* var_type = m_current_token;
-		if (var_type->value == "void") 
+		Token* var_type = keep(m_current_token);
+		if (var_type->symbol == keywordSymbol("void")) 
 			raiseError(std::format("SYNTAX ERROR: function parametr type can't be void {}:{}", m_current_token->line, m_current_token->column));
 		consume(TokenType::VARIABLE_TYPE);
-		params.push_back(new EmptyVarDeclNode(key_word, param_name, var_type));
+		params.push_back(m_arena.make<EmptyVarDeclNode>(key_word, param_name, var_type));
 		if (match(TokenType::RRPAREN)) break;
 		consume(TokenType::COMMA);
 	}
 	// Parse params
 	consume(TokenType::RRPAREN);
-	return new FuncParamNode(params);
+	return m_arena.make<FuncParamNode>(m_arena.copy(params));
 }
 
 IncDecNode* Parser::parseIncDec() {
 	IdNode* id = parseId();
-	Token* operation = m_current_token;
+	Token* operation = keep(m_current_token);
 	if (match(TokenType::INCREMENT) || match(TokenType::DECREMENT))
 		consume(operation->type);
 	consume(TokenType::SEMICOLON);
-	return new IncDecNode(id, operation);
+	return m_arena.make<IncDecNode>(id, operation);
 }
 
 // Parse if statement
@@ -293,7 +327,7 @@ IfStmtNode* Parser::parseIf() {
 	consume(TokenType::LRPAREN);
 	AST* condition = expr();
 	consume(TokenType::RRPAREN);
-	return new IfStmtNode(condition, parseListOfCode());
+	return m_arena.make<IfStmtNode>(condition, parseListOfCode());
 }
 
 // Parse while statement
@@ -302,5 +336,28 @@ WhileStmtNode* Parser::parseWhile() {
 	consume(TokenType::LRPAREN);
 	AST* condition = expr();
 	consume(TokenType::RRPAREN);
-	return new WhileStmtNode(condition, parseListOfCode());
+	return m_arena.make<WhileStmtNode>(condition, parseListOfCode());
+}
+
+// Parse function call
+FuncCallNode* Parser::parseFuncCall() {
+	IdNode* func_name = parseId();
+	consume(TokenType::LRPAREN);
+	std::vector<AST*> args;
+	while (!match(TokenType::RRPAREN)) {
+		args.push_back(expr());
+		if (match(TokenType::RRPAREN)) break;
+		consume(TokenType::COMMA);
+	}
+	consume(TokenType::RRPAREN);
+	return m_arena.make<FuncCallNode>(func_name, m_arena.copy(args));
+}
+
+// Parse return statement
+ReturnStmtNode* Parser::parseReturn() {
+	Token* key_word = keep(m_current_token);
+	consume(TokenType::RETURN_KEYWORD);
+	AST* expression = (match(TokenType::SEMICOLON)) ? nullptr : expr();
+	consume(TokenType::SEMICOLON);
+	return m_arena.make<ReturnStmtNode>(key_word, expression);
 }
\ No newline at end of file
@@ -2,13 +2,16 @@
 #define PARSER_H
 
 #include "AST/ast.h"
+#include "Lexer/token_stream.h"
 
+// Nodes are allocated from the arena passed to the constructor and live as long as it
 class Parser {
 private:
-	int current_token_pos_ = 0;
+	Arena& m_arena;
 	bool error_occured_ = false;
-	std::vector<Token*> tokens_;
+	TokenStream m_tokens;
 	Token* m_current_token;
+	std::vector<size_t*>* m_lines = nullptr; // Line fields of kept tokens and literal nodes, see begin
 
 private:
 	bool match(TokenType type); // Match current token
@@ -18,10 +21,16 @@ private:
 	Token* advance(); // Get token
 	Token* getNextToken(); // Get next token
 	Token* getPrevToken(); // Get previous token
+	Token* keep(Token* token); // Token stored in a node, must outlive the lookahead window
+	template<typename Node>
+	Node* logLine(Node* literal) { if (m_lines) m_lines->push_back(&literal->line); return literal; } // Literals copy the line of their token
 	
+	template<typename T>
+	T literal(const Token* token); // Value of an int or float literal, out of range is a syntax error
+
 	// Functions for parsing expressions
-	AST* factor();
-	AST* term();
+	AST* factor(); // Prefix part: literal, name, call, group or unary operator
+	AST* parseExpression(int min_precedence); // Binary operators stronger than min_precedence
 	AST* expr();
 
 	IdNode* parseId(); // Parse variable names
@@ -34,10 +43,22 @@ private:
 	FuncNode* parseFunc(); // Parse function
 	FuncParamNode* parseParameters(); // Parse function parameters
 	IncDecNode* parseIncDec(); // Parse increment decrement
+	FuncCallNode* parseFuncCall(); // Parse function call
+	ReturnStmtNode* parseReturn(); // Parse return statement
+	AST* parseIdStatement(); // Parse statement that starts with a name
+	AST* parseOneStatement(); // Dispatch on the first token
 	std::vector<AST*> parseStatement(bool if_block = false); // Main function
 
 public:
-	Parser() = default;
-	std::vector<AST*> parse(std::vector<Token*> token_list);
+	Parser(Arena& arena): m_arena(arena) {}
+	std::vector<AST*> parse(const std::vector<Token*>& token_list); // Parse a token list from Lexer::lex
+	std::vector<AST*> parse(Lexer& lexer); // Pull tokens from a lexer that has begun, without building the token list
+
+	// Statement by statement streaming, used by IncrementalParser.
+	// With lines, kept tokens get their text copied into the arena so nodes never point into the source,
+	// and lines receives every line field the parsed nodes hold, so they can be moved when lines are inserted above.
+	void begin(Lexer& lexer, std::vector<size_t*>* lines = nullptr);
+	AST* parseNext(); // Next top level statement, nullptr at the end of the tokens
+	Token* currentToken() { return m_current_token; } // First token of the next statement
 };
 #endif // !PARSER_H
\ No newline at end of file
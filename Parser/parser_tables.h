@@ -0,0 +1,27 @@
+#ifndef PARSER_TABLES_H
+#define PARSER_TABLES_H
+
+#include <array>
+#include <cstdint>
+#include "Tokens/tokens.h"
+
+// Binary operator table for the Pratt expression parser, indexed by TokenType.
+// precedence 0 means the token is not a binary operator and ends the expression.
+struct BinaryOperator {
+	uint8_t precedence = 0;
+	bool right_assoc = false;
+};
+
+constexpr std::array<BinaryOperator, TOKEN_TYPE_COUNT> buildBinaryOperatorTable() {
+	std::array<BinaryOperator, TOKEN_TYPE_COUNT> table{};
+	table[TokenType::LOGIC_OR] = { 1 };
+	table[TokenType::LOGIC_AND] = { 2 };
+	table[TokenType::EQUAL_EQUAL] = table[TokenType::NOT_EQUAL] = { 3 };
+	table[TokenType::LESS] = table[TokenType::GREATER] = table[TokenType::LESS_EQUAL] = table[TokenType::GREATER_EQUAL] = { 4 };
+	table[TokenType::PLUS] = table[TokenType::MINUS] = { 5 };
+	table[TokenType::MULTIPLY] = table[TokenType::DIVIDE] = { 6 };
+	return table;
+}
+
+inline constexpr std::array<BinaryOperator, TOKEN_TYPE_COUNT> BINARY_OPERATORS = buildBinaryOperatorTable();
+#endif // !PARSER_TABLES_H
@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <cstring>
+#include "output_buffer.h"
+
+void OutputBuffer::drain() {
+	if (!m_size) return;
+	m_out.write(m_data.get(), m_size);
+	m_flushed += m_size;
+	m_size = 0;
+}
+
+void OutputBuffer::write(const char* data, size_t size) {
+	if (m_size + size > CAPACITY) {
+		drain();
+		if (size > CAPACITY) { // Too big to buffer, goes straight through
+			m_out.write(data, size);
+			m_flushed += size;
+			return;
+		}
+	}
+	std::memcpy(m_data.get() + m_size, data, size);
+	m_size += size;
+}
+
+void OutputBuffer::pad(size_t count) {
+	while (count) {
+		if (m_size == CAPACITY) drain();
+		size_t chunk = std::min(count, CAPACITY - m_size);
+		std::memset(m_data.get() + m_size, ' ', chunk);
+		m_size += chunk;
+		count -= chunk;
+	}
+}
+
+void OutputBuffer::flush() {
+	drain();
+	m_out.flush();
+}
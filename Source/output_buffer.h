@@ -0,0 +1,55 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <charconv>
+#include <concepts>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+// count spaces, written by OutputBuffer without making a string: out << Spaces{ deep }
+struct Spaces {
+	size_t count;
+};
+
+// Fixed size buffer in front of a stream. Writers append small pieces, the stream only sees whole chunks,
+// so output of any length costs CAPACITY bytes of memory and one stream write per chunk.
+class OutputBuffer {
+private:
+	std::ostream& m_out;
+	std::unique_ptr<char[]> m_data;
+	size_t m_size = 0;
+	size_t m_flushed = 0; // Bytes handed to the stream so far
+
+private:
+	void drain(); // Hand the buffered bytes to the stream
+
+public:
+	static constexpr size_t CAPACITY = 64 * 1024;
+
+	OutputBuffer(std::ostream& out): m_out(out), m_data(new char[CAPACITY]) {}
+	OutputBuffer(const OutputBuffer&) = delete;
+	OutputBuffer& operator=(const OutputBuffer&) = delete;
+	~OutputBuffer() { drain(); }
+
+	void write(const char* data, size_t size);
+	void put(char c) {
+		if (m_size == CAPACITY) drain();
+		m_data[m_size++] = c;
+	}
+	void pad(size_t count); // count spaces
+	void flush(); // Drain and flush the stream
+	size_t bytesWritten() const { return m_flushed + m_size; }
+
+	OutputBuffer& operator<<(std::string_view text) { write(text.data(), text.size()); return *this; }
+	OutputBuffer& operator<<(char c) { put(c); return *this; }
+	OutputBuffer& operator<<(Spaces spaces) { pad(spaces.count); return *this; }
+	template<std::integral T>
+	OutputBuffer& operator<<(T value) {
+		char digits[24];
+		auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+		write(digits, end - digits);
+		return *this;
+	}
+};
+#endif // !OUTPUT_BUFFER_H
@@ -0,0 +1,99 @@
+#include "source_file.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceFile::SourceFile(SourceFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+SourceFile& SourceFile::operator=(SourceFile&& other) noexcept {
+	if (this == &other) return *this;
+	close();
+	m_mapped = other.m_mapped;
+	m_size = other.m_size;
+	m_buffer = std::move(other.m_buffer);
+	m_data = m_mapped ? other.m_data : m_buffer.data();
+	other.m_data = nullptr;
+	other.m_size = 0;
+	other.m_mapped = false;
+	return *this;
+}
+
+void SourceFile::close() {
+#ifndef _WIN32
+	if (m_mapped) munmap(const_cast<char*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_buffer.clear();
+}
+
+#ifdef _WIN32
+// No mapping on Windows yet, the file is read in one call
+bool SourceFile::open(const std::string& path) {
+	close();
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) return false;
+	file.seekg(0, std::ios::end);
+	m_buffer.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0, std::ios::beg);
+	file.read(m_buffer.data(), m_buffer.size());
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	return true;
+}
+
+bool SourceFile::readAll(int fd) { return false; }
+#else
+bool SourceFile::open(const std::string& path) {
+	close();
+	if (path == "-") return readAll(STDIN_FILENO);
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat info;
+	if (fstat(fd, &info) != 0) { ::close(fd); return false; }
+
+	if (S_ISREG(info.st_mode) && info.st_size > 0) {
+		void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			madvise(data, info.st_size, MADV_SEQUENTIAL);
+			::close(fd);
+			m_data = static_cast<const char*>(data);
+			m_size = info.st_size;
+			m_mapped = true;
+			return true;
+		}
+	}
+	bool ok = readAll(fd);
+	::close(fd);
+	return ok;
+}
+
+bool SourceFile::readAll(int fd) {
+	struct stat info;
+	size_t capacity = (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) ? info.st_size + 1 : 64 * 1024;
+	m_buffer.resize(capacity);
+	size_t size = 0;
+	for (;;) {
+		if (size == m_buffer.size()) m_buffer.resize(m_buffer.size() * 2);
+		ssize_t count = read(fd, m_buffer.data() + size, m_buffer.size() - size);
+		if (count < 0) { m_buffer.clear(); return false; }
+		if (count == 0) break;
+		size += count;
+	}
+	m_buffer.resize(size);
+	m_data = m_buffer.data();
+	m_size = size;
+	return true;
+}
+#endif
@@ -0,0 +1,33 @@
+#ifndef SOURCE_FILE_H
+#define SOURCE_FILE_H
+
+#include <string>
+#include <string_view>
+
+// Read-only contiguous view of a script.
+// Regular files are memory mapped, so the lexer reads the page cache directly with no copy.
+// Pipes and stdin (path "-") can't be mapped and are read in bulk into one buffer instead.
+class SourceFile {
+private:
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	bool m_mapped = false;
+	std::string m_buffer; // used when the file can't be mapped
+
+private:
+	bool readAll(int fd); // Fallback for pipes and stdin
+	void close();
+
+public:
+	SourceFile() = default;
+	SourceFile(const SourceFile&) = delete;
+	SourceFile& operator=(const SourceFile&) = delete;
+	SourceFile(SourceFile&& other) noexcept;
+	SourceFile& operator=(SourceFile&& other) noexcept;
+	~SourceFile() { close(); }
+
+	bool open(const std::string& path); // Load file, returns false if it can't be read
+	std::string_view view() const { return { m_data, m_size }; }
+	bool isMapped() const { return m_mapped; }
+};
+#endif // !SOURCE_FILE_H
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <format>
+#include "stats.h"
+
+static constexpr const char* PHASE_NAMES[] = { "load", "cache", "lex", "parse", "fold", "resolve", "check", "compile", "emit", "cc", "run", "print" };
+static_assert(std::size(PHASE_NAMES) == static_cast<size_t>(Phase::COUNT));
+
+static constexpr const char* TOKEN_NAMES[] = {
+	"END_OF_FILE", "NONE", "INT", "FLOAT", "STRING", "BOOL", "CHAR", "VAR_KEYWORD", "CONST_KEYWORD", "WHILE_KEYWORD",
+	"FOR_KEYWORD", "FOREACH_KEYWORD", "IF_KEYWORD", "ELSE_KEYWORD", "FUNC_KEYWORD", "RETURN_KEYWORD", "VARIABLE_TYPE",
+	"BLOCK", "ID", "SEMICOLON", "COLON", "EQUAL", "DOT", "QUOTE", "COMMA", "SLASH", "LESS", "GREATER", "NOT",
+	"GREATER_EQUAL", "LESS_EQUAL", "EQUAL_EQUAL", "NOT_EQUAL", "PLUS", "MINUS", "DIVIDE", "MULTIPLY", "PLUS_EQUAL",
+	"MINUS_EQUAL", "DIVIDE_EQUAL", "MULTIPLY_EQUAL", "LRPAREN", "RRPAREN", "LFPAREN", "RFPAREN", "LSPAREN", "RSPAREN",
+	"LOGIC_AND", "LOGIC_OR", "UNARY_LOGIC_OR", "UNARY_LOGIC_AND", "INCREMENT", "DECREMENT", "ANNOTATION"
+};
+static_assert(std::size(TOKEN_NAMES) == TokenType::TOKEN_TYPE_COUNT);
+
+size_t NodeCounter::total() const {
+	size_t sum = 0;
+	for (size_t count : m_counts) sum += count;
+	return sum;
+}
+
+void Stats::addPhase(Phase phase, double millis, size_t bytes) {
+	PhaseStats& stats = m_phases[static_cast<size_t>(phase)];
+	stats.millis += millis;
+	stats.bytes += bytes;
+	++stats.runs;
+}
+
+void Stats::countTokens(const std::vector<Token*>& tokens) {
+	for (const Token* token : tokens) ++m_tokens[token->type];
+}
+
+void Stats::countNodes(const std::vector<AST*>& ast) {
+	m_nodes.countTree(ast);
+}
+
+void Stats::merge(const Stats& other) {
+	for (size_t i = 0; i < m_phases.size(); ++i) {
+		m_phases[i].millis += other.m_phases[i].millis;
+		m_phases[i].runs += other.m_phases[i].runs;
+		m_phases[i].bytes += other.m_phases[i].bytes;
+	}
+	for (size_t i = 0; i < m_tokens.size(); ++i) m_tokens[i] += other.m_tokens[i];
+	m_nodes.merge(other.m_nodes);
+	m_scripts += other.m_scripts;
+}
+
+// Rows of a count table, biggest first, zeros left out
+template<size_t N>
+static void printCounts(std::ostream& out, const char* title, const std::array<size_t, N>& counts, const char* const (&names)[N]) {
+	size_t total = 0;
+	std::vector<size_t> order;
+	for (size_t i = 0; i < N; ++i) {
+		total += counts[i];
+		if (counts[i]) order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return counts[a] > counts[b]; });
+	out << std::format("{} {}\n", total, title);
+	for (size_t i : order)
+		out << std::format("  {:<18} {:>10} {:>6.1f}%\n", names[i], counts[i], 100.0 * counts[i] / total);
+}
+
+void Stats::report(std::ostream& out) const {
+	double total = 0;
+	for (const PhaseStats& phase : m_phases) total += phase.millis;
+	out << std::format("stats for {} script{}\n", m_scripts, m_scripts == 1 ? "" : "s");
+	out << std::format("  {:<8} {:>6} {:>11} {:>7} {:>12}\n", "phase", "runs", "ms", "time", "bytes");
+	for (size_t i = 0; i < m_phases.size(); ++i) {
+		const PhaseStats& phase = m_phases[i];
+		if (!phase.runs) continue;
+		out << std::format("  {:<8} {:>6} {:>11.3f} {:>6.1f}% {:>12}\n", PHASE_NAMES[i], phase.runs, phase.millis,
+			total > 0 ? 100.0 * phase.millis / total : 0.0, phase.bytes);
+	}
+	out << std::format("  {:<8} {:>6} {:>11.3f}\n", "total", "", total);
+	printCounts(out, "tokens", m_tokens, TOKEN_NAMES);
+	std::array<size_t, static_cast<size_t>(NodeKind::COUNT)> nodes;
+	for (size_t i = 0; i < nodes.size(); ++i) nodes[i] = m_nodes.count(static_cast<NodeKind>(i));
+	printCounts(out, "nodes", nodes, NODE_KIND_NAMES);
+}
@@ -0,0 +1,124 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <span>
+#include <vector>
+#include "../Memory/arena.h"
+#include "../Parser/AST/ast_serializer.h"
+
+// Define DLANG_NO_STATS to compile every timer and counter out, enabled() is then always false.
+// Otherwise a disabled Stats costs one branch per phase, nothing per token or node.
+
+// Steps of handling one script, in the order they happen
+enum class Phase { LOAD, CACHE, LEX, PARSE, FOLD, RESOLVE, CHECK, COMPILE, EMIT, CC, RUN, PRINT, COUNT };
+
+// Counts nodes per class
+class NodeCounter {
+private:
+	std::array<size_t, static_cast<size_t>(NodeKind::COUNT)> m_counts{};
+
+private:
+	void walk(AST* ast) {
+		if (!ast) return;
+		++m_counts[static_cast<size_t>(ast->kind)];
+		dispatch(ast, [this](auto* node) { visit(node); });
+	}
+	template<typename T>
+	void walk(std::span<T*> list) { for (T* ast : list) walk(ast); }
+
+	// Children only, walk counts the node
+	void visit(IntNode*) {}
+	void visit(FloatNode*) {}
+	void visit(StrNode*) {}
+	void visit(ArrayNode*) {}
+	void visit(IdNode*) {}
+	void visit(UnOpNode* node) { walk(node->right); }
+	void visit(BinOpNode* node) { walk(node->left); walk(node->right); }
+	void visit(EmptyVarDeclNode* node) { walk(node->identifier); }
+	void visit(FullVarDeclNode* node) { walk(node->declaration); walk(node->expr); }
+	void visit(ReasignVarNode* node) { walk(node->identifier); walk(node->expr); }
+	void visit(BlockOfCodeNode* node) { walk(node->list); }
+	void visit(IfStmtNode* node) { walk(node->condition); walk(node->code_to_execute); }
+	void visit(WhileStmtNode* node) { walk(node->condition); walk(node->code_to_execute); }
+	void visit(FuncNode* node) { walk(node->func_name); walk(node->params); walk(node->code_to_execute); }
+	void visit(FuncParamNode* node) { walk(node->params); }
+	void visit(IncDecNode* node) { walk(node->identifier); }
+	void visit(FuncCallNode* node) { walk(node->func_name); walk(node->args); }
+	void visit(ReturnStmtNode* node) { walk(node->expr); }
+
+public:
+	void countTree(const std::vector<AST*>& ast) { for (AST* root : ast) walk(root); }
+	size_t count(NodeKind tag) const { return m_counts[static_cast<size_t>(tag)]; }
+	size_t total() const;
+	void merge(const NodeCounter& other) { for (size_t i = 0; i < m_counts.size(); ++i) m_counts[i] += other.m_counts[i]; }
+};
+
+// Time, runs and arena bytes per phase, plus tokens per type and nodes per class of one or more scripts.
+// Not thread safe, a batch keeps one per unit and merges them.
+class Stats {
+public:
+	struct PhaseStats {
+		double millis = 0;
+		size_t runs = 0;
+		size_t bytes = 0; // Arena bytes allocated during the phase, source bytes for LOAD
+	};
+
+private:
+	bool m_enabled = false;
+	std::array<PhaseStats, static_cast<size_t>(Phase::COUNT)> m_phases{};
+	std::array<size_t, TokenType::TOKEN_TYPE_COUNT> m_tokens{};
+	NodeCounter m_nodes;
+	size_t m_scripts = 0;
+
+public:
+#ifdef DLANG_NO_STATS
+	void enable() {}
+	constexpr bool enabled() const { return false; }
+#else
+	void enable() { m_enabled = true; }
+	bool enabled() const { return m_enabled; }
+#endif
+
+	void addPhase(Phase phase, double millis, size_t bytes);
+	void countTokens(const std::vector<Token*>& tokens);
+	void countNodes(const std::vector<AST*>& ast);
+	void addScript() { ++m_scripts; }
+	void merge(const Stats& other);
+
+	const PhaseStats& phase(Phase phase) const { return m_phases[static_cast<size_t>(phase)]; }
+	size_t tokens(TokenType type) const { return m_tokens[type]; }
+	size_t nodes(NodeKind tag) const { return m_nodes.count(tag); }
+	void report(std::ostream& out) const; // Table of phases, then the token types and node classes seen
+};
+
+// Adds the time and the arena growth from its construction to its destruction to one phase.
+// Does nothing when stats is nullptr or disabled.
+class ScopedTimer {
+private:
+	using Clock = std::chrono::steady_clock;
+	Stats* m_stats = nullptr; // nullptr when stats are off
+	Phase m_phase;
+	const Arena* m_arena;
+	size_t m_bytes = 0;
+	Clock::time_point m_start;
+
+public:
+	ScopedTimer(Stats* stats, Phase phase, const Arena* arena = nullptr): m_phase(phase), m_arena(arena) {
+		if (!stats || !stats->enabled()) return;
+		m_stats = stats;
+		if (m_arena) m_bytes = m_arena->bytesUsed();
+		m_start = Clock::now();
+	}
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+	~ScopedTimer() {
+		if (!m_stats) return;
+		double millis = std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+		m_stats->addPhase(m_phase, millis, m_arena ? m_arena->bytesUsed() - m_bytes : m_bytes);
+	}
+	void setBytes(size_t bytes) { m_arena = nullptr; m_bytes = bytes; } // Report bytes instead of the arena growth
+};
+#endif // !STATS_H
@@ -0,0 +1,168 @@
+#include <cstdlib>
+#include <string>
+#include "test.h"
+#include "../Interpreter/interpreter.h"
+
+// Scripts every backend must run the same. The work sits in functions called often enough for the
+// tiered JIT to compile them, and covers the opcodes it compiles as well as ones it exits on.
+struct Script {
+	const char* name;
+	bool fails; // Ends with a run time error
+	bool native; // The C backend builds it, it has no array builtins
+	const char* source;
+};
+
+static constexpr Script SCRIPTS[] = {
+	// Int arithmetic in a hot loop
+	{ "intLoop", false, true, R"(func mix(var n: int) -> int {
+	var acc: int = 7;
+	var i: int = 0;
+	while (i < n) {
+		acc = acc * 31 + i - acc / 3;
+		if (acc > 1000000007) { acc -= 1000000007; }
+		if (acc < -1000000007) { acc += 1000000007; }
+		i++;
+	}
+	return acc;
+}
+print(mix(5000), mix(1), mix(0));
+)" },
+	// Overflow wraps, the smallest int / -1 gives itself
+	{ "intWrap", false, true, R"(func wrap(var a: int, var b: int) -> int { return a * b + a - b; }
+func quotient(var a: int, var b: int) -> int { return a / b; }
+var max: int = 9223372036854775807;
+var min: int = -max - 1;
+var i: int = 0;
+var total: int = 0;
+while (i < 2000) {
+	total += wrap(max - i, 3 + i) + quotient(min, -1) + quotient(min + i, -1);
+	i++;
+}
+print(total, quotient(min, -1), wrap(min, -1), -min, min - 1, max + 1, max * max);
+)" },
+	// Float arithmetic and int to float promotion
+	{ "floats", false, true, R"(func poly(var x: float) -> float { return x * x * 0.5 - x / 3.0 + 1.25; }
+func mean(var n: int) -> float {
+	var s: float = 0.0;
+	var i: int = 0;
+	while (i < n) { s += poly(i / 7.0) - i; i++; }
+	return s / n;
+}
+print(mean(3000), poly(2.0), -poly(0.5), 7 / 2, 7.0 / 2, 2 * 1.5, 1 - 0.25);
+)" },
+	// Deep and branching recursion
+	{ "recursion", false, true, R"(func fib(var n: int) -> int {
+	if (n < 2) { return n; }
+	return fib(n - 1) + fib(n - 2);
+}
+func ack(var m: int, var n: int) -> int {
+	if (m == 0) { return n + 1; }
+	if (n == 0) { return ack(m - 1, 1); }
+	return ack(m - 1, ack(m, n - 1));
+}
+print(fib(22), ack(2, 3), ack(3, 3));
+)" },
+	// Comparisons and logic on mixed int and float operands
+	{ "comparisons", false, true, R"(func logic(var a: int, var b: float) -> int {
+	var r: int = 0;
+	if (a < b) { r += 1; }
+	if (a >= b && a != 3) { r += 2; }
+	if (!(a == b) || a > 10) { r += 4; }
+	if (a <= 2.5) { r += 8; }
+	return r;
+}
+var i: int = 0;
+var s: int = 0;
+while (i < 3000) { s += logic(i - 5, i / 3.0); i++; }
+print(s, logic(3, 3.0), 1 < 2, 2.5 >= 2.5, 3 == 3.0, "a" == "a", !0, 1 && 0, 0 || 2, "x" + "y");
+)" },
+	// Arrays built in a hot function and the builtins
+	{ "arrays", false, false, R"(func build(var n: int) -> array {
+	var a: array;
+	var i: int = 0;
+	while (i < n) { push(a, i * i - 3 * i); i++; }
+	return a;
+}
+var a: array = build(2000);
+var f: array = [1.5, 2.5, 3.25];
+print(len(a), sum(a), min(a), max(a), dot(a, a), get(a, 1999));
+print(sum(f), dot(f, f), add(f, f), slice(a, 0, 5), lt(slice(a, 0, 4), fill(4, 0)));
+var s: array = ["a", "b"];
+push(s, "c");
+print(s, len(s));
+)" },
+	// Array literals without builtins, the ones the C backend builds
+	{ "arrayLiterals", false, true, R"(func pick(var n: int) -> array {
+	var a: array = [1.5, 2.5];
+	if (n > 1000) { a = [9223372036854775807, 2, 3]; }
+	return a;
+}
+var i: int = 0;
+var last: array;
+while (i < 1500) { last = pick(i); i++; }
+var words: array = ["to", "be"];
+print(last, pick(0), words, [4294967296]);
+)" },
+	// A hot function failing on its last call
+	{ "divisionByZero", true, true, R"(func div(var a: int, var b: int) -> int { return a / b; }
+var i: int = 1500;
+var s: int = 0;
+while (i >= 0) { s += div(100000, i); i--; }
+print(s);
+)" },
+	// Recursion past MAX_CALL_DEPTH
+	{ "stackOverflow", true, true, R"(func down(var n: int) -> int { return down(n + 1) + 1; }
+print("before");
+print(down(0));
+)" },
+};
+
+// Every runner, on the folded and the unfolded tree, prints what the tree walker prints for the folded one
+TEST(jitMatchesInterpreter) {
+	for (const Script& script : SCRIPTS) {
+		std::string expected = runScript(script.source, Runner::TREE_WALKER);
+		CHECK((expected.find("ERROR: ") != std::string::npos) == script.fails, "{}: the tree walker prints\n{}", script.name, expected);
+		for (bool fold : { true, false })
+			for (Runner runner : RUNNERS) {
+				std::string output = runScript(script.source, runner, fold);
+				CHECK(output == expected, "{}: the {}{} prints\n{}instead of\n{}", script.name, runnerName(runner), fold ? "" : " without folding",
+					output, expected);
+			}
+	}
+}
+
+// Builds source with the system C compiler ($CC) into directory and runs it, returns the exit status
+static int runNative(std::string_view source, const std::filesystem::path& directory, const char* name, std::string& output) {
+	Arena arena;
+	SymbolTable symbols;
+	std::filesystem::path executable = directory / name;
+	Interpreter().buildNative(parseScript(source, arena, symbols), executable.string(), false);
+	std::filesystem::path out = directory / (std::string(name) + ".out");
+	int status = std::system(std::format("\"{}\" > \"{}\" 2>&1", executable.string(), out.string()).c_str());
+	output = readFile(out);
+	return status;
+}
+
+// A native build prints what the VM prints, a run time error is its last line and the exit status 1.
+// Scripts using the array builtins must be rejected before the C compiler runs
+TEST(aotMatchesVM) {
+	TemporaryDirectory directory("dlang_tests_aot");
+	std::string output;
+	try { runNative("print(1);", directory.path(), "probe", output); }
+	catch (const std::runtime_error& err) { throw TestSkipped(std::format("no working C compiler: {}", err.what())); }
+
+	for (const Script& script : SCRIPTS) {
+		if (!script.native) {
+			std::string error;
+			try { runNative(script.source, directory.path(), script.name, output); }
+			catch (const std::runtime_error& err) { error = err.what(); }
+			CHECK(error.find("isn't supported by the C backend") != std::string::npos, "{}: builds with {}", script.name, error);
+			continue;
+		}
+		std::string expected = runScript(script.source, Runner::VM);
+		if (size_t error = expected.find("ERROR: "); error != std::string::npos) expected.erase(error, 7);
+		int status = runNative(script.source, directory.path(), script.name, output);
+		CHECK((status != 0) == script.fails, "{}: native exit status {}", script.name, status);
+		CHECK(output == expected, "{}: the native build prints\n{}instead of\n{}", script.name, output, expected);
+	}
+}
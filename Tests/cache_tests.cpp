@@ -0,0 +1,97 @@
+#include <fstream>
+#include "test.h"
+#include "../Benchmark/source_generator.h"
+#include "../Interpreter/ast_cache.h"
+#include "../Interpreter/batch.h"
+#include "../Parser/AST/ast_serializer.h"
+
+// Literals at the ends of their range and folds into them, the image must keep all 64 bits
+static constexpr const char* LITERALS = R"(var big: int = 9223372036854775807;
+var small: int = -9223372036854775807 - 1;
+var folded: int = 4294967296 * 4294967295 + 3000000000;
+var tiny: float = 0.000000000000000000001;
+var huge: float = 100000000000000000000000000000000000000000.5;
+var a: array = [9223372036854775807, 1, 2147483648];
+print(big, small, folded, tiny, huge, a, big + 1);
+)";
+
+// Writes ast as an image and reads it back into a fresh arena, the trees must dump the same
+static void checkImage(const std::vector<AST*>& ast, const SymbolTable& symbols, const char* what) {
+	std::string image = ASTWriter().write(ast, symbols);
+	CHECK(!image.empty(), "{}: no image", what);
+	Arena arena;
+	SymbolTable read_symbols;
+	std::vector<AST*> read;
+	CHECK(ASTReader(arena, read_symbols).read(image, read), "{}: the image is rejected", what);
+	CHECK(dumpJSON(read) == dumpJSON(ast), "{}: the tree read back differs", what);
+}
+
+TEST(cacheImageRoundTrip) {
+	for (int shape = 0; shape < static_cast<int>(SourceShape::COUNT); ++shape) {
+		GeneratorOptions options;
+		options.shape = static_cast<SourceShape>(shape);
+		options.bytes = 64 << 10;
+		std::string source = generateSource(options);
+		for (bool fold : { false, true }) {
+			Arena arena;
+			SymbolTable symbols;
+			checkImage(parseScript(source, arena, symbols, fold), symbols, shapeName(options.shape));
+		}
+	}
+	Arena arena;
+	SymbolTable symbols;
+	checkImage(parseScript(LITERALS, arena, symbols), symbols, "literals");
+}
+
+// Parse a unit as the shell does, through the cache
+static std::unique_ptr<CompilationUnit> parseCached(const std::filesystem::path& script, const ASTCache& cache, bool fold = true) {
+	auto unit = std::make_unique<CompilationUnit>(script.string());
+	ParseOptions options;
+	options.fold = fold;
+	options.cache = &cache;
+	parseUnit(*unit, options);
+	return unit;
+}
+
+TEST(cacheStoreAndLoad) {
+	TemporaryDirectory directory("dlang_tests_cache");
+	std::filesystem::path cache_path = directory.path() / "cache";
+	ASTCache cache(cache_path);
+	std::filesystem::path script = directory.path() / "script.dl";
+	writeFile(script, LITERALS);
+
+	std::unique_ptr<CompilationUnit> parsed = parseCached(script, cache);
+	CHECK(parsed->error.empty(), "{}", parsed->error);
+	CHECK(parsed->cached.view().empty(), "read from an empty cache");
+	std::unique_ptr<CompilationUnit> loaded = parseCached(script, cache);
+	CHECK(!loaded->cached.view().empty(), "the tree wasn't stored");
+	CHECK(dumpJSON(loaded->ast) == dumpJSON(parsed->ast), "the cached tree differs");
+	CHECK(loaded->fold_stats.folded == parsed->fold_stats.folded, "fold stats {} instead of {}", loaded->fold_stats.folded, parsed->fold_stats.folded);
+
+	// An unfolded tree is another entry
+	std::unique_ptr<CompilationUnit> unfolded = parseCached(script, cache, false);
+	CHECK(unfolded->cached.view().empty(), "an unfolded parse read the folded tree");
+	CHECK(directory.entries(cache_path) == 2, "{} cache entries instead of 2", directory.entries(cache_path));
+}
+
+// Scripts that don't parse are never stored, a damaged entry is a miss
+TEST(cacheSkipsErrorsAndDamage) {
+	TemporaryDirectory directory("dlang_tests_cache_errors");
+	ASTCache cache(directory.path() / "cache");
+	std::filesystem::path script = directory.path() / "script.dl";
+	writeFile(script, "var a: int = 1 +;\nprint(a);\n");
+	std::unique_ptr<CompilationUnit> failed = parseCached(script, cache);
+	CHECK(!failed->error.empty(), "a missing operand parses");
+	CHECK(!std::filesystem::exists(directory.path() / "cache"), "a failed parse was stored");
+
+	writeFile(script, LITERALS);
+	std::unique_ptr<CompilationUnit> parsed = parseCached(script, cache);
+	for (const auto& entry : std::filesystem::directory_iterator(directory.path() / "cache")) {
+		std::fstream file(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(entry.path()) / 2));
+		file.put('\x7F');
+	}
+	std::unique_ptr<CompilationUnit> reparsed = parseCached(script, cache);
+	CHECK(reparsed->error.empty(), "{}", reparsed->error);
+	CHECK(dumpJSON(reparsed->ast) == dumpJSON(parsed->ast), "the tree after a damaged entry differs");
+}
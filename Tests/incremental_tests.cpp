@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include "test.h"
+#include "../Benchmark/source_generator.h"
+#include "../Parser/incremental_parser.h"
+
+// The parser must hold the tree of a full parse of its text, or its error. Returns whether the text parses
+static bool checkMatchesFullParse(IncrementalParser& parser, size_t edit) {
+	Arena arena;
+	SymbolTable symbols;
+	std::string expected, error;
+	try { expected = dumpJSON(parseScript(parser.text(), arena, symbols, false)); }
+	catch (const std::runtime_error& err) { error = err.what(); }
+	CHECK(parser.error() == error, "edit {}: error {}, a full parse gives {}", edit, parser.error(), error);
+	if (error.empty()) CHECK(dumpJSON(parser.ast()) == expected, "edit {}: the tree differs from a full parse of\n{}", edit, parser.text());
+	return error.empty();
+}
+
+// Random edits on statement boundaries and inside tokens. An edit that breaks the script is undone by the next one,
+// so the edits go from valid to broken and back, and the valid ones pile up.
+static void checkEdits(const std::string& source, uint32_t seed, size_t edits) {
+	static constexpr const char* SNIPPETS[] = { "var q: int = 1;\n", "print(q);\n", "\n", ";", "(", ")", "{", "}", "\"", "// c\n", "12", " + 3",
+		"if (1 < 2) { print(\"x\"); }\n", "func g() -> int { return 4; }\n", "$" };
+	std::mt19937 random(seed);
+	IncrementalParser parser;
+	parser.open(source);
+	size_t valid = checkMatchesFullParse(parser, 0);
+	for (size_t edit = 1; edit <= edits; ++edit) {
+		const std::string& text = parser.text();
+		size_t offset = random() % (text.size() + 1);
+		if (random() % 2) offset = text.rfind('\n', offset ? offset - 1 : 0) + 1; // Start of a line, npos + 1 is 0
+		size_t removed = (random() % 3) ? 0 : std::min<size_t>(random() % 24, text.size() - offset);
+		std::string inserted = (random() % 4) ? SNIPPETS[random() % std::size(SNIPPETS)] : "";
+		std::string old = text.substr(offset, removed);
+		parser.edit(offset, removed, inserted);
+		if (checkMatchesFullParse(parser, edit)) ++valid;
+		else {
+			parser.edit(offset, inserted.size(), old);
+			CHECK(checkMatchesFullParse(parser, edit), "edit {}: undoing it leaves an error", edit);
+		}
+	}
+	CHECK(valid > edits / 4, "only {} of {} edits kept the script valid", valid, edits);
+}
+
+TEST(incrementalMatchesFullParse) {
+	GeneratorOptions options;
+	options.bytes = 16 << 10;
+	for (uint32_t seed = 1; seed <= 4; ++seed) {
+		options.seed = seed;
+		checkEdits(generateSource(options), seed, 300);
+	}
+}
+
+// Edits around a failed range: it must be reported until an edit repairs it, wherever the other edits are
+TEST(incrementalErrorsMatchFullParse) {
+	std::string source = "var a: int = 1;\nprint(a);\nfunc f(var x: int) -> int {\n\treturn x * 2;\n}\nprint(f(a));\n";
+	IncrementalParser parser;
+	parser.open(source);
+	checkMatchesFullParse(parser, 0);
+	parser.edit(source.find("1;"), 1, "");
+	checkMatchesFullParse(parser, 1);
+	CHECK(!parser.error().empty(), "a missing operand parses");
+	parser.edit(0, 0, "var b: int = 2;\n");
+	checkMatchesFullParse(parser, 2);
+	parser.edit(parser.text().size(), 0, "print(b);\n");
+	checkMatchesFullParse(parser, 3);
+	parser.edit(parser.text().find("= ;"), 3, "= 5;");
+	checkMatchesFullParse(parser, 4);
+	CHECK(parser.error().empty(), "the repaired script fails: {}", parser.error());
+}
+
+// An edit of one statement parses about one statement, the parity above holds for the reused ones
+TEST(incrementalReusesStatements) {
+	GeneratorOptions options;
+	options.bytes = 16 << 10;
+	IncrementalParser parser;
+	parser.open(generateSource(options));
+	size_t statements = parser.ast().size();
+	size_t middle = parser.text().find("\nvar ", parser.text().size() / 2) + 1;
+	parser.edit(middle, 0, "var inserted: int = 7;\n");
+	checkMatchesFullParse(parser, 1);
+	CHECK(parser.stats().reused + parser.stats().parsed <= statements + 3 && parser.stats().parsed <= 3,
+		"parsed {} and reused {} of {} statements", parser.stats().parsed, parser.stats().reused, statements);
+}
+
+// Replaced statements are reclaimed: an editor session that keeps editing holds about two full parses of memory
+TEST(incrementalMemoryStaysBounded) {
+	GeneratorOptions options;
+	options.bytes = 16 << 10;
+	IncrementalParser parser;
+	parser.open(generateSource(options));
+	size_t bound = 4 * std::max(parser.bytesReserved(), Arena::DEFAULT_BLOCK_SIZE);
+	size_t middle = parser.text().find("\nvar ", parser.text().size() / 2) + 1;
+	std::string inserted = "var edited: int = 7 * (3 + 4);\n";
+	for (size_t edit = 1; edit <= 20000; ++edit) {
+		if (edit % 2) parser.edit(middle, 0, inserted);
+		else parser.edit(middle, inserted.size(), "");
+		CHECK(parser.bytesReserved() <= bound, "edit {}: {} bytes held, more than {}", edit, parser.bytesReserved(), bound);
+		if (edit % 1000 == 0) checkMatchesFullParse(parser, edit);
+	}
+}
@@ -0,0 +1,83 @@
+#include <string>
+#include "test.h"
+#include "../Benchmark/source_generator.h"
+#include "../Parser/Lexer/lexer.h"
+#include "../Parser/Lexer/parallel_lexer.h"
+
+// Lexes source serially and in parallel chunks, the tokens and symbol tables must be the same
+static ParallelLexer::Stats checkParallelLex(const std::string& source, const char* what) {
+	CHECK(source.size() >= 2 * ParallelLexer::MIN_CHUNK_SIZE, "{}: {} bytes is lexed serially", what, source.size());
+	Arena serial_arena, parallel_arena;
+	SymbolTable serial_symbols, parallel_symbols;
+	std::vector<Token*> serial = Lexer(serial_arena, serial_symbols).lex(source);
+	ThreadPool pool(4);
+	ParallelLexer lexer(parallel_arena, parallel_symbols, pool);
+	std::vector<Token*> parallel = lexer.lex(source);
+	CHECK(lexer.stats().chunks > 1, "{}: lexed in one chunk", what);
+
+	CHECK(serial.size() == parallel.size(), "{}: {} tokens serially, {} in parallel", what, serial.size(), parallel.size());
+	for (size_t i = 0; i < serial.size(); ++i) {
+		const Token& a = *serial[i];
+		const Token& b = *parallel[i];
+		CHECK(a.type == b.type && a.value == b.value && a.line == b.line && a.column == b.column && a.symbol == b.symbol,
+			"{}: token {} is {} at {}:{} serially, {} at {}:{} in parallel", what, i, a.value, a.line, a.column, b.value, b.line, b.column);
+	}
+	CHECK(serial_symbols.size() == parallel_symbols.size(), "{}: {} symbols serially, {} in parallel", what, serial_symbols.size(), parallel_symbols.size());
+	for (SymbolId symbol = 0; symbol < serial_symbols.size(); ++symbol)
+		CHECK(serial_symbols.name(symbol) == parallel_symbols.name(symbol), "{}: symbol {} differs", what, symbol);
+	return lexer.stats();
+}
+
+TEST(lexParallelMatchesSerial) {
+	for (int shape = 0; shape < static_cast<int>(SourceShape::COUNT); ++shape) {
+		GeneratorOptions options;
+		options.shape = static_cast<SourceShape>(shape);
+		options.bytes = 3 * ParallelLexer::MIN_CHUNK_SIZE;
+		checkParallelLex(generateSource(options), shapeName(options.shape));
+	}
+}
+
+// Strings spanning lines cross the chunk cuts, with text inside them that looks like comments and tokens
+TEST(lexParallelStringsAcrossChunks) {
+	std::string source;
+	for (size_t i = 0; source.size() < 3 * ParallelLexer::MIN_CHUNK_SIZE; ++i) {
+		source += "var v" + std::to_string(i) + ": string = \"first line\n";
+		for (size_t line = 0; line < 2000 + i % 7; ++line) source += "// not a comment ; var x: int = 1;\n" + std::string(line % 5, ' ');
+		source += "last line\";\n";
+		source += "var n" + std::to_string(i) + ": int = " + std::to_string(i) + "; // comment \"\n";
+	}
+	CHECK(checkParallelLex(source, "strings").relexed > 0, "no chunk started inside a string");
+}
+
+// A lexical error is reported with the serial message and position
+TEST(lexParallelErrorMatchesSerial) {
+	GeneratorOptions options;
+	options.bytes = 3 * ParallelLexer::MIN_CHUNK_SIZE;
+	std::string source = generateSource(options);
+	source.insert(source.find('\n', source.size() / 2) + 1, "var bad: int = 1 $ 2;\n");
+
+	auto errorOf = [&](auto&& lex) {
+		try { lex(); }
+		catch (const std::runtime_error& err) { return std::string(err.what()); }
+		return std::string();
+	};
+	Arena serial_arena, parallel_arena;
+	SymbolTable serial_symbols, parallel_symbols;
+	ThreadPool pool(4);
+	std::string serial = errorOf([&] { Lexer(serial_arena, serial_symbols).lex(source); });
+	std::string parallel = errorOf([&] { ParallelLexer(parallel_arena, parallel_symbols, pool).lex(source); });
+	CHECK(!serial.empty(), "the bad token isn't an error");
+	CHECK(serial == parallel, "serially {}in parallel {}", serial, parallel);
+}
+
+// A NUL ends the buffer for the serial lexer, the chunks after it are dropped and the stream still ends with END_OF_FILE
+TEST(lexParallelStopsAtNul) {
+	GeneratorOptions options;
+	options.bytes = 3 * ParallelLexer::MIN_CHUNK_SIZE;
+	std::string source = generateSource(options);
+	for (size_t at : { source.size() / 2, source.size() / 5 }) {
+		std::string cut = source;
+		cut.insert(cut.find('\n', at) + 1, std::string("var a: int = 1;\0var b: int = 2;\n", 32));
+		checkParallelLex(cut, "nul");
+	}
+}
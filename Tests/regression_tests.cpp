@@ -0,0 +1,114 @@
+#include <string>
+#include "test.h"
+#include "../Parser/flat_parser.h"
+#include "../Parser/incremental_parser.h"
+#include "../Parser/Lexer/lexer.h"
+
+// Script and the first line every backend must print for it, the error of scripts that don't parse
+struct Regression {
+	const char* source;
+	const char* expected;
+};
+
+// Error thrown by a streaming parse of source with FlatParser, empty if it parses
+static std::string flatParseError(std::string_view source) {
+	Arena arena;
+	SymbolTable symbols;
+	FlatAST flat(symbols);
+	Lexer lexer(arena, symbols);
+	lexer.begin(source);
+	try { FlatParser(flat).parse(lexer); }
+	catch (const std::runtime_error& err) { return err.what(); }
+	return {};
+}
+
+// Every runner prints expected with and without folding, Parser, FlatParser and IncrementalParser agree on errors
+static void checkRegressions(std::span<const Regression> regressions) {
+	for (const Regression& regression : regressions) {
+		std::string expected = regression.expected;
+		for (bool fold : { true, false })
+			for (Runner runner : RUNNERS) {
+				std::string output = runScript(regression.source, runner, fold);
+				CHECK(output == expected, "{}\nthe {}{} prints\n{}instead of\n{}", regression.source, runnerName(runner), fold ? "" : " without folding",
+					output, expected);
+			}
+		std::string error = expected.starts_with("ERROR: SYNTAX ERROR") ? expected.substr(7) : "";
+		CHECK(flatParseError(regression.source) == error, "{}\nFlatParser gives {}", regression.source, flatParseError(regression.source));
+		IncrementalParser parser;
+		parser.open(regression.source);
+		CHECK(parser.error() == error, "{}\nIncrementalParser gives {}", regression.source, parser.error());
+	}
+}
+
+// A missing operand used to leave a null expression in the tree, which every pass after the parser crashed on
+TEST(parserRejectsMissingOperands) {
+	static constexpr Regression REGRESSIONS[] = {
+		{ "var y: int = ;", "ERROR: SYNTAX ERROR: Unexpected Token ; in 1:13\n" },
+		{ "var x: int = -;", "ERROR: SYNTAX ERROR: Unexpected Token ; in 1:14\n" },
+		{ "print(1 + );", "ERROR: SYNTAX ERROR: Unexpected Token ) in 1:10\n" },
+		{ "var x: int = 1; x = ;", "ERROR: SYNTAX ERROR: Unexpected Token ; in 1:20\n" },
+		{ "if () {}", "ERROR: SYNTAX ERROR: Unexpected Token ) in 1:4\n" },
+		{ "while () {}", "ERROR: SYNTAX ERROR: Unexpected Token ) in 1:7\n" },
+		{ "print((1 + ));", "ERROR: SYNTAX ERROR: Unexpected Token ) in 1:11\n" },
+		{ "print(1, );", "1\n" }, // A trailing comma is allowed
+		{ "print();", "\n" },
+	};
+	checkRegressions(REGRESSIONS);
+}
+
+// Int + - * / and negation wrap in every backend. The smallest int / -1 trapped in the C++ operations,
+// the VM fast paths, JIT code and native code, and signed overflow was undefined behaviour
+TEST(intArithmeticWraps) {
+	static constexpr Regression REGRESSIONS[] = {
+		{ R"(func f(var a: int, var b: int) -> int { return a / b; }
+func g(var a: int) -> int { return 0 - a; }
+var h: int = 1073741824 * 1073741824 * 4;
+var m: int = 0 - h - h;
+var i: int = 0;
+var s: int = 0;
+while (i < 3000) { s = s + f(m, -1) / 3 + g(m) * 7 + m * m; i++; }
+var x: int = m;
+x--;
+x = -x;
+print(m / -1, s, x, -m, m - 1, h * 4, h + h, m / 1);
+)", "-9223372036854775808 2000 -9223372036854775807 -9223372036854775808 9223372036854775807 0 -9223372036854775808 -9223372036854775808\n" },
+		// Through the generic operations: a bool divisor is an int
+		{ "var m: int = -9223372036854775807 - 1; var one: int = 0 - 1; var b: bool = 1 == 1; print(m / -1, m / one, -m / b, m * -1);",
+			"-9223372036854775808 -9223372036854775808 -9223372036854775808 -9223372036854775808\n" },
+		{ "var max: int = 9223372036854775807; max++; print(max, 9223372036854775807 + 1, 3037000500 * 3037000500);",
+			"-9223372036854775808 -9223372036854775808 -9223372036709301616\n" },
+	};
+	checkRegressions(REGRESSIONS);
+}
+
+// The folder kept folding with values no literal could hold and crashed on the smallest int / -1,
+// an operator it can't fold (5 / 0) must stay in the tree and fail at run time
+TEST(folderKeepsUnfoldedOperators) {
+	static constexpr Regression REGRESSIONS[] = {
+		{ "print((0 - 1073741824*1073741824*4 - 1073741824*1073741824*4) / -1, 1073741824 * 4 / 4, -(0 - 2147483647 - 1), (1 < 2) + 1); "
+			"if (1 < 2) { print(1); } var z: int = 5 / 0;",
+			"-9223372036854775808 1073741824 2147483648 2\n1\nERROR: RUNTIME ERROR: Division by zero in 1:165\n" },
+		{ "var a: int = 2 * 3; var b: int = 7 / (a - 6); print(a, b);", "ERROR: RUNTIME ERROR: Division by zero in 1:35\n" },
+		{ "print(1 + 2 * 3, 1.5 * 2, \"a\" + \"b\", 10 / 3 - 1);", "7 3 ab 2\n" },
+	};
+	checkRegressions(REGRESSIONS);
+}
+
+// Literal nodes held an int and a float and ignored from_chars errors, print(2147483648); printed 0.
+// They hold 64 bits now and a literal out of that range is a syntax error in every parser
+TEST(literalsHold64Bits) {
+	static const std::string HUGE_DIGITS = "1" + std::string(310, '0') + ".5"; // Above the largest double
+	static const std::string HUGE_FLOAT = "print(" + HUGE_DIGITS + ");";
+	static const std::string HUGE_FLOAT_ERROR = "ERROR: SYNTAX ERROR: Literal " + HUGE_DIGITS + " is out of range in 1:6\n";
+	static const Regression REGRESSIONS[] = {
+		{ "print(2147483648, 9223372036854775807, 3000000000 * 3); var a: int = 9223372036854775807; print(a + 1);",
+			"2147483648 9223372036854775807 9000000000\n-9223372036854775808\n" },
+		{ "var b: array = [4294967296, 5, 9223372036854775807]; print(b, 0.1 + 0.2, 16777217.0 - 16777216.0);",
+			"[4294967296, 5, 9223372036854775807] 0.3 1\n" },
+		{ "print(9223372036854775808);", "ERROR: SYNTAX ERROR: Literal 9223372036854775808 is out of range in 1:6\n" },
+		{ "print(1 + 9223372036854775808);", "ERROR: SYNTAX ERROR: Literal 9223372036854775808 is out of range in 1:10\n" },
+		{ "var a: array = [1, 18446744073709551616];", "ERROR: SYNTAX ERROR: Literal 18446744073709551616 is out of range in 1:19\n" },
+		{ HUGE_FLOAT.c_str(), HUGE_FLOAT_ERROR.c_str() },
+	};
+	checkRegressions(REGRESSIONS);
+}
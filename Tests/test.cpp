@@ -0,0 +1,106 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "test.h"
+#include "../Interpreter/constant_folder.h"
+#include "../Interpreter/interpreter.h"
+#include "../Parser/AST/ast_dumper.h"
+#include "../Parser/parser.h"
+
+std::vector<Test>& tests() {
+	static std::vector<Test> list;
+	return list;
+}
+
+const char* runnerName(Runner runner) {
+	switch (runner) {
+		case Runner::TREE_WALKER: return "tree walker";
+		case Runner::VM: return "vm";
+		case Runner::JIT: return "jit";
+		default: return "tiered";
+	}
+}
+
+std::vector<AST*> parseScript(std::string_view source, Arena& arena, SymbolTable& symbols, bool fold) {
+	Lexer lexer(arena, symbols);
+	lexer.begin(source);
+	std::vector<AST*> ast = Parser(arena).parse(lexer);
+	if (fold) ConstantFolder(arena).fold(ast);
+	return ast;
+}
+
+std::string runScript(std::string_view source, Runner runner, bool fold) {
+	Arena arena;
+	SymbolTable symbols;
+	std::ostringstream out;
+	try {
+		std::vector<AST*> ast = parseScript(source, arena, symbols, fold);
+		JitMode jit = (runner == Runner::JIT) ? JitMode::FORCE : (runner == Runner::TIERED) ? JitMode::TIERED : JitMode::OFF;
+		Interpreter(out, nullptr, jit).run(ast, (runner == Runner::TREE_WALKER) ? Backend::TREE_WALKER : Backend::VM);
+	}
+	catch (const std::exception& err) { out << "ERROR: " << err.what(); }
+	return out.str();
+}
+
+std::string dumpJSON(const std::vector<AST*>& ast) {
+	std::ostringstream out;
+	JSONDumper().dump(ast, out);
+	return out.str();
+}
+
+TemporaryDirectory::TemporaryDirectory(const char* name): m_path(std::filesystem::temp_directory_path() / name) {
+	std::filesystem::remove_all(m_path);
+	std::filesystem::create_directories(m_path);
+}
+
+TemporaryDirectory::~TemporaryDirectory() {
+	std::error_code error;
+	std::filesystem::remove_all(m_path, error);
+}
+
+size_t TemporaryDirectory::entries(const std::filesystem::path& path) {
+	return std::distance(std::filesystem::directory_iterator(path), std::filesystem::directory_iterator());
+}
+
+void writeFile(const std::filesystem::path& path, std::string_view text) {
+	std::ofstream file(path, std::ios::binary);
+	file << text;
+}
+
+std::string readFile(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream text;
+	text << file.rdbuf();
+	return text.str();
+}
+
+// dlang_tests [name...], the exit status is 0, 1 if a test failed or SKIP_STATUS if every one run was skipped
+int main(int argc, char** argv) {
+	size_t run = 0, failed = 0, skipped = 0;
+	for (const Test& test : tests()) {
+		bool named = argc < 2;
+		for (int i = 1; i < argc; ++i) named |= !std::strcmp(argv[i], test.name);
+		if (!named) continue;
+		++run;
+		try {
+			test.run();
+			std::cout << "PASS " << test.name << "\n";
+		}
+		catch (const TestSkipped& skip) {
+			++skipped;
+			std::cout << "SKIP " << test.name << ": " << skip.what() << "\n";
+		}
+		catch (const std::exception& err) {
+			++failed;
+			std::cout << "FAIL " << test.name << ": " << err.what();
+		}
+	}
+	if (!run) {
+		std::cerr << "No test named so, the tests are:\n";
+		for (const Test& test : tests()) std::cerr << "  " << test.name << "\n";
+		return 1;
+	}
+	if (failed) return 1;
+	return (skipped == run) ? SKIP_STATUS : 0;
+}
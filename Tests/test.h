@@ -0,0 +1,69 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Error/error.h"
+#include "../Memory/arena.h"
+#include "../Parser/AST/ast.h"
+#include "../Parser/Lexer/symbol_table.h"
+
+// Tests are functions registered by name. dlang_tests runs the ones named on its command line, every one without
+// a name, and CTest runs it once per test (see CMakeLists.txt). A test fails by throwing, CHECK builds the message.
+struct Test {
+	const char* name;
+	void (*run)();
+};
+
+std::vector<Test>& tests();
+
+struct TestRegistrar {
+	TestRegistrar(const char* name, void (*run)()) { tests().push_back({ name, run }); }
+};
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(condition, ...) \
+	do { if (!(condition)) raiseError(std::format("{}:{}: {}\n", __FILE__, __LINE__, std::format(__VA_ARGS__))); } while (0)
+
+// Thrown by a test that can't run here (no C compiler for example), CTest reports it as skipped
+class TestSkipped: public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+constexpr int SKIP_STATUS = 77; // SKIP_RETURN_CODE of every test
+
+// How runScript executes a script
+enum class Runner { TREE_WALKER, VM, JIT, TIERED };
+constexpr Runner RUNNERS[] = { Runner::TREE_WALKER, Runner::VM, Runner::JIT, Runner::TIERED };
+const char* runnerName(Runner runner);
+
+// Stream source through the lexer into the parser as the shell does, fold the tree if fold is set.
+// Errors are thrown, the first one in the source whether it is lexical or syntactic
+std::vector<AST*> parseScript(std::string_view source, Arena& arena, SymbolTable& symbols, bool fold = true);
+// What a script prints, a compile or run time error adds "ERROR: " and its message
+std::string runScript(std::string_view source, Runner runner, bool fold = true);
+std::string dumpJSON(const std::vector<AST*>& ast); // Tree with every position, for comparing two trees
+
+// A directory of its own for a test, removed when it ends
+class TemporaryDirectory {
+private:
+	std::filesystem::path m_path;
+
+public:
+	explicit TemporaryDirectory(const char* name);
+	~TemporaryDirectory();
+	const std::filesystem::path& path() const { return m_path; }
+	static size_t entries(const std::filesystem::path& path); // Files and directories in path
+};
+
+void writeFile(const std::filesystem::path& path, std::string_view text);
+std::string readFile(const std::filesystem::path& path);
+#endif // !TEST_H
@@ -0,0 +1,84 @@
+#include <utility>
+#include "thread_pool.h"
+
+// Worker the current thread belongs to, lets a task push to its own queue
+static thread_local const ThreadPool* t_pool = nullptr;
+static thread_local size_t t_worker = 0;
+
+ThreadPool::ThreadPool(size_t threads) {
+	if (!threads) threads = 1;
+	for (size_t i = 0; i < threads; ++i) m_queues.push_back(std::make_unique<Queue>());
+	for (size_t i = 0; i < threads; ++i) m_workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_work_ready.notify_all();
+	for (std::thread& worker : m_workers) worker.join();
+}
+
+void ThreadPool::submit(Task task) {
+	size_t index = t_pool == this ? t_worker : m_next_queue++ % m_queues.size();
+	{
+		std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+		m_queues[index]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_queued;
+		++m_unfinished;
+	}
+	m_work_ready.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_all_done.wait(lock, [this] { return !m_unfinished; });
+	if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+}
+
+bool ThreadPool::pop(size_t worker, Task& task) {
+	Queue& own = *m_queues[worker];
+	{
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+	for (size_t i = 1; i < m_queues.size(); ++i) {
+		Queue& victim = *m_queues[(worker + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.tasks.empty()) continue;
+		task = std::move(victim.tasks.front());
+		victim.tasks.pop_front();
+		++m_steals;
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::work(size_t worker) {
+	t_pool = this;
+	t_worker = worker;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_work_ready.wait(lock, [this] { return m_stop || m_queued; });
+			if (!m_queued) return;
+			--m_queued; // A task is reserved for this worker, it's in one of the queues
+		}
+		Task task;
+		while (!pop(worker, task)) std::this_thread::yield();
+		std::exception_ptr error;
+		try { task(); }
+		catch (...) { error = std::current_exception(); }
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (error && !m_error) m_error = error;
+		if (!--m_unfinished) m_all_done.notify_all();
+	}
+}
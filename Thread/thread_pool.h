@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing thread pool.
+// Every worker owns a queue: it runs its own tasks from the back (the newest, still warm in its cache)
+// and when the queue is empty steals from the front of the others (the oldest, usually the biggest left).
+// Tasks submitted from outside the pool are dealt round robin, tasks submitted by a task go to its own worker.
+// An exception thrown by a task is rethrown by wait(), the other tasks still run.
+class ThreadPool {
+public:
+	using Task = std::function<void()>;
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_queues;
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex; // Guards the counters below, workers sleep on it
+	std::condition_variable m_work_ready;
+	std::condition_variable m_all_done;
+	size_t m_queued = 0; // Tasks sitting in the queues
+	size_t m_unfinished = 0; // Tasks submitted and not finished yet
+	bool m_stop = false;
+	std::exception_ptr m_error;
+	std::atomic<size_t> m_next_queue = 0;
+	std::atomic<size_t> m_steals = 0;
+
+private:
+	bool pop(size_t worker, Task& task); // Own queue first, then steal
+	void work(size_t worker); // Worker thread loop
+
+public:
+	explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	void submit(Task task);
+	void wait(); // Block until every submitted task has finished
+	size_t size() const { return m_workers.size(); }
+	size_t steals() const { return m_steals; } // Tasks run by another worker than the one they were given to
+};
+#endif // !THREAD_POOL_H